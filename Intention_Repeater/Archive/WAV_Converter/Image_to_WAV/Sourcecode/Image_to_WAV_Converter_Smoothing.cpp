@@ -1,7 +1,8 @@
 /*
 WAV Repeater with Smoothing
 by Anthro Teacher and Nathan
-To Compile: g++ -O3 -Wall -static Image_to_WAV_Converter_Smoothing.cpp -o Image_to_WAV_Converter_Smoothing.exe -std=c++20
+To Compile: cmake -S ../../../.. -B build && cmake --build build --target Image_to_WAV_Converter_Smoothing
+or: g++ -O3 -Wall -static -std=c++20 -pthread -I../../../../Intention_Core/Sourcecode Image_to_WAV_Converter_Smoothing.cpp ../../../../Intention_Core/Sourcecode/display.cpp ../../../../Intention_Core/Sourcecode/frame_writer.cpp ../../../../Intention_Core/Sourcecode/wav_header.cpp -o Image_to_WAV_Converter_Smoothing.exe
 */
 
 #include <iostream>
@@ -17,19 +18,16 @@ To Compile: g++ -O3 -Wall -static Image_to_WAV_Converter_Smoothing.cpp -o Image_
 #include <algorithm>
 #include <climits>
 #include <sstream>
+#include "display.h"
+#include "frame_writer.h"
+#include "wav_header.h"
 using namespace std;
 using namespace filesystem;
-#ifdef _WIN64
-#define BYTEALIGNMENTFORWAVPRODUCER 8
-#else
-#define BYTEALIGNMENTFORWAVPRODUCER 4
-#endif
 #include <bit>
 
 std::string VERSION = "v1.5";
 
 /// ////////////////////////////////////////////START OF RIFF WAVE TAG ///////////////////////////////////////////////////////////////////////////
-const uint32_t headerChunkSize = 0; /// PLACE HOLDER FOR RIFF HEADER CHUNK SIZE
 /// /////////FORMAT CHUNK////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 const double volume_level = 1.000; /// VOLUME LEVEL///
 uint16_t audioFormat = 1;          /// 3 is float 1 is PCM                            /// AN UNKNOWN AT THIS TIME
@@ -55,25 +53,6 @@ std::string filename = "";
 std::vector<char> binaryIntentionData;
 std::vector<char> binaryIntentionDataOriginal;
 /// //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-/*
-void addPadding(std::ofstream &file)
-{
-    int currentPosition = file.tellp();
-    //std::cout << "Checking Pading Details Current Pos# " << currentPosition << std::endl;
-    int remainder = currentPosition % BYTEALIGNMENTFORWAVPRODUCER;
-    //std::cout << "Checking Pading Details Remainder# " << remainder << std::endl;
-    if (remainder != 0)
-    {
-        int paddingSize = BYTEALIGNMENTFORWAVPRODUCER - remainder;
-        std::cout << "Checking Pading Details Padding Size# " << paddingSize << std::endl;
-        for (int i = 0; i < paddingSize; ++i)
-        {
-            const uint8_t paddingByte = 0;
-            file.write(reinterpret_cast<const char *>(&paddingByte), sizeof(paddingByte));
-        }
-    }
-}
-*/
 std::string removeNonAlphanumeric(const std::string &str)
 {
     std::string result;
@@ -86,91 +65,7 @@ std::string removeNonAlphanumeric(const std::string &str)
     }
     return result;
 }
-void ensureDataAlignment(ofstream &wavFile)
-{
-    long pos = wavFile.tellp();
-    long align = pos % 2;
-    if (align != 0)
-    {
-        uint8_t paddingByte = 0;
-        wavFile.write(reinterpret_cast<const char *>(&paddingByte), sizeof(paddingByte));
-    }
-}
-void writeRiffHeader(ofstream &wavFile)
-{
-    wavFile.seekp(0, std::ios::beg);
-    wavFile.write("RIFF", 4);                                                                 /// HEADER NAME FOR WAVE FILE ///                                         ///WRITING RIFF HEADER CALLING SIGN INTO FILE
-    wavFile.write(reinterpret_cast<const char *>(&headerChunkSize), sizeof(headerChunkSize)); /// WRITING PLACEHOLDER FOR RIFF HEADER CHUNK SIZE INTO FILE
-    // std::cout << "Checking Pading Details Current Pos# " << wavFile.tellp() << std::endl;
-}
-/// PRESUMES that when you call the function you are at end of file///
-void writeRiffHeaderSizeElement(ofstream &wavFile)
-{
-    int fileLength = static_cast<int>(wavFile.tellp());
-    uint32_t fileSizeMinus8 = static_cast<uint32_t>(fileLength - 8);
-    wavFile.seekp(4, ios::beg);
-    wavFile.write(reinterpret_cast<const char *>(&fileSizeMinus8), sizeof(fileSizeMinus8));
-    wavFile.seekp(0, ios::end);
-}
-/// EXAMPLE: writeFormatHeader(wavFile,formatSize,audioFormat,numChannels,sampleRate,byteRate,blockAlign,bitsPerSample);
-void writeFormatHeader(ofstream &wavFile, const uint32_t formatSize, const uint16_t audioFormat, const uint16_t numChannels, const uint32_t sampleRate, const uint32_t byteRate,
-                       /*                                 */ const uint16_t blockAlign, const uint16_t bitsPerSample)
-{
-    wavFile.write("WAVEfmt ", 8);                                                         /// WRITING FORMAT CHUNK HEADER CALLING SIGN INTO FILE
-    wavFile.write(reinterpret_cast<const char *>(&formatSize), sizeof(formatSize));       /// WRITING FORMAT CHUNK SIZE INTO THE FILE
-    wavFile.write(reinterpret_cast<const char *>(&audioFormat), sizeof(audioFormat));     /// WRITING FORMAT CHUNK ELEMENT - AUDIO FORMAT TO THE FILE
-    wavFile.write(reinterpret_cast<const char *>(&numChannels), sizeof(numChannels));     /// WRITING FORMAT CHUNK ELEMENT - NUMBER OF CHANNELS TO THE FILE
-    wavFile.write(reinterpret_cast<const char *>(&sampleRate), sizeof(sampleRate));       /// WRITING FORMAT CHUNK ELEMENT - SAMPLE RATE TO THE FILE
-    wavFile.write(reinterpret_cast<const char *>(&byteRate), sizeof(byteRate));           /// WRITING FORMAT CHUNK ELEMENT - BYTE RATE TO THE FILE
-    wavFile.write(reinterpret_cast<const char *>(&blockAlign), sizeof(blockAlign));       /// WRITING FORMAT CHUNK ELEMENT - BLOCK ALIGNMENT TO THE FILE
-    wavFile.write(reinterpret_cast<const char *>(&bitsPerSample), sizeof(bitsPerSample)); /// WRITING FORMAT CHUNK ELEMENT - BITS PER SAMPLE TO THE FILE
-    // std::cout << "Checking Pading Details Current Pos# " << wavFile.tellp() << std::endl;
-    //     addPadding(wavFile);
-}
-void writeListSubChunk(ofstream &wavFile, const char *ID, const char *data, const uint32_t dataSize, const uint32_t isNullTerminated = 1)
-{
-    wavFile.write(ID, strlen(ID));                                                                                                              /// WRITE THE INFO CHUNK ID
-    uint32_t alignedDataSize = (dataSize + BYTEALIGNMENTFORWAVPRODUCER - isNullTerminated) & ~(BYTEALIGNMENTFORWAVPRODUCER - isNullTerminated); /// CHECK FOR WORD ALIGNMENT FOR CHUNK
-    wavFile.write(reinterpret_cast<const char *>(&alignedDataSize), sizeof(alignedDataSize));                                                   /// WRITE THE SIZE OF THE CHUNK
-    wavFile.write(data, dataSize);                                                                                                              /// WRITE THE DATA OF THE CHUNK
-    if (alignedDataSize == dataSize)
-        alignedDataSize += BYTEALIGNMENTFORWAVPRODUCER; /// FOR LOOKS SAKE IN THE HEX EDITOR WE HAVE ALIGNMENT NO MATTER WHAT
-    for (uint32_t i = dataSize; i < alignedDataSize; ++i)
-    { /// IF DATA DOESNT END ON ALIGNMENT ADD PADDING
-        const uint8_t paddingByte = 0;
-        wavFile.write(reinterpret_cast<const char *>(&paddingByte), sizeof(paddingByte));
-    }
-}
-
-void writeListSubChunk(ofstream &wavFile, const char *ID, const std::string &data)
-{
-    wavFile.write(ID, strlen(ID));                                                                        /// WRITE THE INFO CHUNK ID
-    const uint32_t dataSize = data.length() + 1;                                                          /// SIZE OF CHUNK TO BE ADDED DEFAULTLY
-    uint32_t alignedDataSize = (dataSize + BYTEALIGNMENTFORWAVPRODUCER) & ~(BYTEALIGNMENTFORWAVPRODUCER); /// CHECK FOR WORD ALIGNMENT FOR CHUNK
-    wavFile.write(reinterpret_cast<const char *>(&alignedDataSize), sizeof(alignedDataSize));             /// WRITE THE SIZE OF THE CHUNK
-    wavFile.write(data.c_str(), data.length());                                                           /// WRITE THE DATA OF THE CHUNK
-    if (alignedDataSize == dataSize)
-        alignedDataSize += BYTEALIGNMENTFORWAVPRODUCER; /// FOR LOOKS SAKE IN THE HEX EDITOR WE HAVE ALIGNMENT NO MATTER WHAT
-    for (uint32_t i = dataSize; i < alignedDataSize; ++i)
-    { /// IF DATA DOESNT END ON ALIGNMENT ADD PADDING
-        const uint8_t paddingByte = 0;
-        wavFile.write(reinterpret_cast<const char *>(&paddingByte), sizeof(paddingByte));
-    }
-}
 
-uint32_t writeListHeader(ofstream &wavFile)
-{
-    wavFile.write("LIST", 4);                                                                 /// WRITING LIST HEADER ID
-    const uint32_t listHeaderChunkSizePos = wavFile.tellp();                                  /// GETTING LIST HEADER SIZE ELEMENT POS FOR RETURN VALUE
-    wavFile.write(reinterpret_cast<const char *>(&headerChunkSize), sizeof(headerChunkSize)); /// WRITING PLACEHOLDER SIZE ELEMENT
-    return listHeaderChunkSizePos;                                                            /// RETURNING THE LIST HEADER SIZE ELEMENT POSITION
-}
-void writeListHeaderSizeChunkElement(ofstream &wavFile, const uint32_t position, const uint32_t value)
-{
-    wavFile.seekp(position, ios::beg);                        /// GOING BACK TO FILL IN LIST SIZE ///
-    wavFile.write(reinterpret_cast<const char *>(&value), 4); /// FILLING IN LIST SIZE WITH PROPER NUMERATION ////
-    wavFile.seekp(0, ios::end);                               /// SEEKING END OF FILE ///
-}
 ///////////////PRELIMINARY DATA CHUNK VARIABLES/////////////////
 int ord(char c)
 {
@@ -204,14 +99,12 @@ void writeDataChunk(std::ofstream &wavFile)
     double sampleMax = (bitsPerSample == 16 ? 32767 : 2147483647);
     // double scalingFactor = sampleMax / rangeValue;
     uint32_t numSamples = binaryIntentionData.size();
-    std::vector<char> sample_buffer;
 
     double phaseIncrement = 2.0 * PI * frequency / sampleRate;
     double phase = 0.0;
-    wavFile.write("data", 4);
-    const uint32_t dataChunkSizePos = wavFile.tellp();
-    wavFile.write(reinterpret_cast<const char *>(&headerChunkSize), sizeof(headerChunkSize));
+    const std::streamoff dataChunkSizePos = writeDataChunkHeader(wavFile);
 
+    FrameWriter frameWriter(wavFile, numSamples, bitsPerSample / 8);
     for (uint32_t i = 0; i < numSamples; ++i)
     {
         double charValue = static_cast<unsigned char>(binaryIntentionData[i]) - minCharValue;
@@ -239,26 +132,17 @@ void writeDataChunk(std::ofstream &wavFile)
 
         long sample_value = static_cast<long>(modulatedValue * volume * sampleMax);
 
-        // Write sample_value to sample_buffer
         if (bitsPerSample == 32)
         {
-            int32_t val = static_cast<int32_t>(sample_value);
-            sample_buffer.insert(sample_buffer.end(), reinterpret_cast<char *>(&val), reinterpret_cast<char *>(&val) + sizeof(val));
+            frameWriter.put(static_cast<int32_t>(sample_value));
         }
         else
         {
-            int16_t val = static_cast<int16_t>(sample_value);
-            sample_buffer.insert(sample_buffer.end(), reinterpret_cast<char *>(&val), reinterpret_cast<char *>(&val) + sizeof(val));
-        }
-
-        // Write buffer to file and clear every 100000 samples
-        if (i % 100000 == 0 && i > 0)
-        {
-            wavFile.write(sample_buffer.data(), sample_buffer.size());
-            sample_buffer.clear();
-            std::cout << "\rProgress: " << std::fixed << std::setprecision(2) << static_cast<float>(i) / static_cast<float>(numSamples) * 100.0f << "% Samples Written: " << i << "     \r" << std::flush;
+            frameWriter.put(static_cast<int16_t>(sample_value));
         }
     }
+
+    frameWriter.finish();
     uint32_t actualDataSize = static_cast<uint32_t>(static_cast<int64_t>(wavFile.tellp()) - dataChunkSizePos - 4);
     if (actualDataSize % 2 != 0)
     {
@@ -269,113 +153,10 @@ void writeDataChunk(std::ofstream &wavFile)
     // Ensure data alignment after writing the main data chunk
     ensureDataAlignment(wavFile);
 
-    wavFile.seekp(dataChunkSizePos, ios::beg);
-    wavFile.write(reinterpret_cast<const char *>(&actualDataSize), sizeof(actualDataSize));
-    wavFile.seekp(0, ios::end);
-
-    // Write any remaining samples in buffer to file
-    if (!sample_buffer.empty())
-    {
-        wavFile.write(sample_buffer.data(), sample_buffer.size());
-        sample_buffer.clear();
-    }
+    writeDataChunkSizeElement(wavFile, dataChunkSizePos, actualDataSize, numSamples);
 }
 /// //////////////////////////////END OF RIFF TAG////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /// /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-/// /////////////////////////////START OF ID3V2 TAG////////////////////////////////////////////////////////////////////////////////////////////
-const uint8_t majorVersion = 0x04; // ID3v2.4 version number
-const uint8_t minorVersion = 0x00; // Revision number
-const uint8_t paddingByte = 0x00;  // Zero byte
-void writeLittleEndian(std::ofstream &file, uint32_t value)
-{
-    file.put(value & 0xFF);
-    file.put((value >> 8) & 0xFF);
-    file.put((value >> 16) & 0xFF);
-    file.put((value >> 24) & 0xFF);
-}
-void writeBigEndian(std::ofstream &file, uint32_t value)
-{
-    file.put((value >> 24) & 0xFF);
-    file.put((value >> 16) & 0xFF);
-    file.put((value >> 8) & 0xFF);
-    file.put(value & 0xFF);
-}
-uint32_t checkForAndWritePadding(ofstream &wavFile)
-{ /// Calculate padding needed to align frame start to a multiple of 4 bytes
-    const uint32_t paddingSize = (BYTEALIGNMENTFORWAVPRODUCER - (wavFile.tellp() % BYTEALIGNMENTFORWAVPRODUCER)) % BYTEALIGNMENTFORWAVPRODUCER;
-    for (uint32_t i = 0; i < paddingSize; ++i)
-    {
-        wavFile.write(reinterpret_cast<const char *>(&paddingByte), sizeof(paddingByte));
-    }
-    return paddingSize;
-}
-void writePadding(ofstream &wavFile)
-{ /// Calculate padding needed to align frame start to a multiple of 4 bytes
-    uint32_t paddingSize = (BYTEALIGNMENTFORWAVPRODUCER - (wavFile.tellp() % BYTEALIGNMENTFORWAVPRODUCER)) % BYTEALIGNMENTFORWAVPRODUCER;
-    if (paddingSize == 0)
-        paddingSize = BYTEALIGNMENTFORWAVPRODUCER;
-    for (uint32_t i = 0; i < paddingSize; ++i)
-    {
-        wavFile.write(reinterpret_cast<const char *>(&paddingByte), sizeof(paddingByte));
-    }
-}
-uint32_t createID3Header(ofstream &wavFile, const uint32_t tagSize = 0, const uint8_t flags = 0x00)
-{
-    //    const uint32_t paddingAdded = checkForAndWritePadding(wavFile);
-    wavFile.write("ID3", 3);                                         /// WRITE TAG OF HEADER OF ID3TAG
-    wavFile.write(reinterpret_cast<const char *>(&majorVersion), 1); /// WRITE MAJOR VERSION
-    wavFile.write(reinterpret_cast<const char *>(&minorVersion), 1); /// WRITE MINOR VERSION
-    wavFile.write(reinterpret_cast<const char *>(&flags), 1);        /// WRITE FLAGS
-    const uint32_t ID3HeaderSizeElementLocation = wavFile.tellp();
-    const uint32_t actualTagSize = tagSize;
-    if constexpr (std::endian::native == std::endian::little)
-    { /// WRITE TAG SIZE = SIZE OF ID3 TAG MINUS HEADER
-        writeLittleEndian(wavFile, actualTagSize);
-    }
-    else if constexpr (std::endian::native == std::endian::big)
-    {
-        writeBigEndian(wavFile, actualTagSize);
-    }
-    else
-    {
-        wavFile.write(reinterpret_cast<const char *>(&actualTagSize), 4);
-    }
-    return ID3HeaderSizeElementLocation;
-}
-void createID3Footer(ofstream &wavFile, const uint32_t tagSize = 0, const uint8_t flags = 0x00)
-{
-    //    checkForAndWritePadding(wavFile);
-    wavFile.write("3DI", 3);                                         /// WRITE TAG OF FOOTER OF ID3TAG WHICH IS BACKWARDS HEADER ID
-    wavFile.write(reinterpret_cast<const char *>(&majorVersion), 1); /// WRITE MAJOR VERSION
-    wavFile.write(reinterpret_cast<const char *>(&minorVersion), 1); /// WRITE MINOR VERSION
-    wavFile.write(reinterpret_cast<const char *>(&flags), 1);        /// WRITE FLAGS
-    wavFile.write(reinterpret_cast<const char *>(&tagSize), 4);      /// WRITE TAG SIZE
-}
-uint32_t createID3FrameHeader(ofstream &wavFile, const char *frameID, const uint32_t frameSize = 0, const uint16_t flags = 0x00)
-{
-    //    checkForAndWritePadding(wavFile);
-    wavFile.write(frameID, 4); /// The frame ID is made out of the characters capital A-Z and 0-9. Identifiers beginning with �X�, �Y� and �Z�
-    const uint32_t frameSizePosition = wavFile.tellp();
-    wavFile.write(reinterpret_cast<const char *>(&frameSize), 4);
-    wavFile.write(reinterpret_cast<const char *>(&flags), 2);
-    return frameSizePosition;
-}
-void setID3HeaderSize(ofstream &wavFile, const uint32_t frameSizeElementLocation, const uint32_t frameChunkSize)
-{
-    const uint32_t currentPos = wavFile.tellp();
-    wavFile.seekp(frameSizeElementLocation, std::ios::beg);
-    wavFile.write(reinterpret_cast<const char *>(&frameChunkSize), 4);
-    wavFile.seekp(currentPos, std::ios::beg);
-    createID3Footer(wavFile, frameChunkSize);
-}
-void insertID3Frame(ofstream &wavFile, const string &key, const string &value)
-{
-    const uint32_t frameSize = key.size() + value.size() + 1; /// Size of frame = size of key + size of value + 1 (for null terminator)
-    createID3FrameHeader(wavFile, key.c_str(), frameSize);
-    wavFile.write("\0", 1); // Null terminator between key and value
-    wavFile.write(value.c_str(), value.size());
-}
-/// ////////////////////////////////////////////////END OF ID3V2 TAG///////////////////////////////////////////////////////////////////////////
 /// CONVERT A TEXT FILE TO A VECTOR OF SINGLE BYTES ///
 std::string readFileToString(const string &filename)
 {
@@ -427,30 +208,6 @@ bool is_hz_suffix(const std::string &str)
 {
     return str.size() >= 2 && (str.substr(str.size() - 2) == "HZ" || str.substr(str.size() - 2) == "hz" || str.substr(str.size() - 2) == "Hz");
 }
-std::string display_suffix(std::string num, int power, std::string designator)
-{
-    if (power < 3)
-    {
-        return num;
-    }
-
-    std::string s;
-
-    if (designator == "Iterations")
-    {
-        constexpr char iterations_suffix_array[] = {' ', 'k', 'M', 'B', 'T', 'q', 'Q', 's', 'S', 'O', 'N', 'D'};
-        s = iterations_suffix_array[power / 3];
-    }
-    else // designator == "Frequency"
-    {
-        constexpr char frequency_suffix_array[] = {' ', 'k', 'M', 'G', 'T', 'P', 'E', 'Z', 'Y', 'R'};
-        s = frequency_suffix_array[power / 3];
-    }
-
-    std::string str2 = num.substr(0, power % 3 + 1) + "." + num.substr(power % 3 + 1, 3) + s;
-
-    return str2;
-}
 void setupQuestions()
 {
     while (filename.empty())
@@ -1,7 +1,8 @@
 /*
 Text to WAV Repeater with Smoothing
 by Anthro Teacher and Nathan
-To Compile: g++ -O3 -Wall -static Text_to_WAV_Repeater_Smoothing.cpp -o Text_to_WAV_Repeater_Smoothing.exe -std=c++20
+To Compile: cmake -S ../../../.. -B build && cmake --build build --target Text_to_WAV_Repeater_Smoothing
+or: g++ -O3 -Wall -static -std=c++20 -pthread -I../../../../Intention_Core/Sourcecode Text_to_WAV_Repeater_Smoothing.cpp ../../../../Intention_Core/Sourcecode/display.cpp ../../../../Intention_Core/Sourcecode/frame_writer.cpp ../../../../Intention_Core/Sourcecode/wav_header.cpp -o Text_to_WAV_Repeater_Smoothing.exe
 */
 
 #include <iostream>
@@ -16,18 +17,15 @@ To Compile: g++ -O3 -Wall -static Text_to_WAV_Repeater_Smoothing.cpp -o Text_to_
 #include <thread>
 #include <algorithm>
 #include <sstream>
+#include "display.h"
+#include "frame_writer.h"
+#include "wav_header.h"
 using namespace std;
 using namespace filesystem;
-#ifdef _WIN64
-#define BYTEALIGNMENTFORWAVPRODUCER 8
-#else
-#define BYTEALIGNMENTFORWAVPRODUCER 4
-#endif
 #include <bit>
 
 std::string VERSION = "v1.6";
 /// ////////////////////////////////////////////START OF RIFF WAVE TAG ///////////////////////////////////////////////////////////////////////////
-const uint32_t headerChunkSize = 0; /// PLACE HOLDER FOR RIFF HEADER CHUNK SIZE
 /// /////////FORMAT CHUNK////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 const double volume_level = 0.99; /// VOLUME LEVEL///
 uint16_t audioFormat = 1;         /// 3 is float 1 is PCM                            /// AN UNKNOWN AT THIS TIME
@@ -50,30 +48,6 @@ long long int numSamples = 0;
 double PI = 3.141592653589793238462643383279502884197;
 std::string intention = "";
 
-std::string display_suffix(std::string num, int power, std::string designator)
-{
-    if (power < 3)
-    {
-        return num;
-    }
-
-    std::string s;
-
-    if (designator == "Iterations")
-    {
-        constexpr char iterations_suffix_array[] = {' ', 'k', 'M', 'B', 'T', 'q', 'Q', 's', 'S', 'O', 'N', 'D'};
-        s = iterations_suffix_array[power / 3];
-    }
-    else // designator == "Frequency"
-    {
-        constexpr char frequency_suffix_array[] = {' ', 'k', 'M', 'G', 'T', 'P', 'E', 'Z', 'Y', 'R'};
-        s = frequency_suffix_array[power / 3];
-    }
-
-    std::string str2 = num.substr(0, power % 3 + 1) + "." + num.substr(power % 3 + 1, 3) + s;
-
-    return str2;
-}
 std::string removeNonAlphanumeric(const std::string &str)
 {
     std::string result;
@@ -86,91 +60,7 @@ std::string removeNonAlphanumeric(const std::string &str)
     }
     return result;
 }
-void writeRiffHeader(ofstream &wavFile)
-{
-    wavFile.seekp(0, std::ios::beg);
-    wavFile.write("RIFF", 4);                                                                 /// HEADER NAME FOR WAVE FILE ///                                         ///WRITING RIFF HEADER CALLING SIGN INTO FILE
-    wavFile.write(reinterpret_cast<const char *>(&headerChunkSize), sizeof(headerChunkSize)); /// WRITING PLACEHOLDER FOR RIFF HEADER CHUNK SIZE INTO FILE
-    // std::cout << "Checking Pading Details Current Pos# " << wavFile.tellp() << std::endl;
-}
-/// PRESUMES that when you call the function you are at end of file///
-void writeRiffHeaderSizeElement(ofstream &wavFile)
-{
-    int fileLength = static_cast<int>(wavFile.tellp());
-    uint32_t fileSizeMinus8 = static_cast<uint32_t>(fileLength - 8);
-    wavFile.seekp(4, ios::beg);
-    wavFile.write(reinterpret_cast<const char *>(&fileSizeMinus8), sizeof(fileSizeMinus8));
-    wavFile.seekp(0, ios::end);
-}
-void ensureDataAlignment(ofstream &wavFile)
-{
-    long pos = wavFile.tellp();
-    long align = pos % 2;
-    if (align != 0)
-    {
-        uint8_t paddingByte = 0;
-        wavFile.write(reinterpret_cast<const char *>(&paddingByte), sizeof(paddingByte));
-    }
-}
-/// EXAMPLE: writeFormatHeader(wavFile,formatSize,audioFormat,numChannels,sampleRate,byteRate,blockAlign,bitsPerSample);
-void writeFormatHeader(ofstream &wavFile, const uint32_t formatSize, const uint16_t audioFormat, const uint16_t numChannels, const uint32_t sampleRate, const uint32_t byteRate,
-                       /*                                 */ const uint16_t blockAlign, const uint16_t bitsPerSample)
-{
-    wavFile.write("WAVEfmt ", 8);                                                         /// WRITING FORMAT CHUNK HEADER CALLING SIGN INTO FILE
-    wavFile.write(reinterpret_cast<const char *>(&formatSize), sizeof(formatSize));       /// WRITING FORMAT CHUNK SIZE INTO THE FILE
-    wavFile.write(reinterpret_cast<const char *>(&audioFormat), sizeof(audioFormat));     /// WRITING FORMAT CHUNK ELEMENT - AUDIO FORMAT TO THE FILE
-    wavFile.write(reinterpret_cast<const char *>(&numChannels), sizeof(numChannels));     /// WRITING FORMAT CHUNK ELEMENT - NUMBER OF CHANNELS TO THE FILE
-    wavFile.write(reinterpret_cast<const char *>(&sampleRate), sizeof(sampleRate));       /// WRITING FORMAT CHUNK ELEMENT - SAMPLE RATE TO THE FILE
-    wavFile.write(reinterpret_cast<const char *>(&byteRate), sizeof(byteRate));           /// WRITING FORMAT CHUNK ELEMENT - BYTE RATE TO THE FILE
-    wavFile.write(reinterpret_cast<const char *>(&blockAlign), sizeof(blockAlign));       /// WRITING FORMAT CHUNK ELEMENT - BLOCK ALIGNMENT TO THE FILE
-    wavFile.write(reinterpret_cast<const char *>(&bitsPerSample), sizeof(bitsPerSample)); /// WRITING FORMAT CHUNK ELEMENT - BITS PER SAMPLE TO THE FILE
-    // std::cout << "Checking Pading Details Current Pos# " << wavFile.tellp() << std::endl;
-    //     addPadding(wavFile);
-}
-void writeListSubChunk(ofstream &wavFile, const char *ID, const char *data, const uint32_t dataSize, const uint32_t isNullTerminated = 1)
-{
-    wavFile.write(ID, strlen(ID));                                                                                                              /// WRITE THE INFO CHUNK ID
-    uint32_t alignedDataSize = (dataSize + BYTEALIGNMENTFORWAVPRODUCER - isNullTerminated) & ~(BYTEALIGNMENTFORWAVPRODUCER - isNullTerminated); /// CHECK FOR WORD ALIGNMENT FOR CHUNK
-    wavFile.write(reinterpret_cast<const char *>(&alignedDataSize), sizeof(alignedDataSize));                                                   /// WRITE THE SIZE OF THE CHUNK
-    wavFile.write(data, dataSize);                                                                                                              /// WRITE THE DATA OF THE CHUNK
-    if (alignedDataSize == dataSize)
-        alignedDataSize += BYTEALIGNMENTFORWAVPRODUCER; /// FOR LOOKS SAKE IN THE HEX EDITOR WE HAVE ALIGNMENT NO MATTER WHAT
-    for (uint32_t i = dataSize; i < alignedDataSize; ++i)
-    { /// IF DATA DOESNT END ON ALIGNMENT ADD PADDING
-        const uint8_t paddingByte = 0;
-        wavFile.write(reinterpret_cast<const char *>(&paddingByte), sizeof(paddingByte));
-    }
-}
 
-void writeListSubChunk(ofstream &wavFile, const char *ID, const std::string &data)
-{
-    wavFile.write(ID, strlen(ID));                                                                        /// WRITE THE INFO CHUNK ID
-    const uint32_t dataSize = data.length() + 1;                                                          /// SIZE OF CHUNK TO BE ADDED DEFAULTLY
-    uint32_t alignedDataSize = (dataSize + BYTEALIGNMENTFORWAVPRODUCER) & ~(BYTEALIGNMENTFORWAVPRODUCER); /// CHECK FOR WORD ALIGNMENT FOR CHUNK
-    wavFile.write(reinterpret_cast<const char *>(&alignedDataSize), sizeof(alignedDataSize));             /// WRITE THE SIZE OF THE CHUNK
-    wavFile.write(data.c_str(), data.length());                                                           /// WRITE THE DATA OF THE CHUNK
-    if (alignedDataSize == dataSize)
-        alignedDataSize += BYTEALIGNMENTFORWAVPRODUCER; /// FOR LOOKS SAKE IN THE HEX EDITOR WE HAVE ALIGNMENT NO MATTER WHAT
-    for (uint32_t i = dataSize; i < alignedDataSize; ++i)
-    { /// IF DATA DOESNT END ON ALIGNMENT ADD PADDING
-        const uint8_t paddingByte = 0;
-        wavFile.write(reinterpret_cast<const char *>(&paddingByte), sizeof(paddingByte));
-    }
-}
-
-uint32_t writeListHeader(ofstream &wavFile)
-{
-    wavFile.write("LIST", 4);                                                                 /// WRITING LIST HEADER ID
-    const uint32_t listHeaderChunkSizePos = wavFile.tellp();                                  /// GETTING LIST HEADER SIZE ELEMENT POS FOR RETURN VALUE
-    wavFile.write(reinterpret_cast<const char *>(&headerChunkSize), sizeof(headerChunkSize)); /// WRITING PLACEHOLDER SIZE ELEMENT
-    return listHeaderChunkSizePos;                                                            /// RETURNING THE LIST HEADER SIZE ELEMENT POSITION
-}
-void writeListHeaderSizeChunkElement(ofstream &wavFile, const uint32_t position, const uint32_t value)
-{
-    wavFile.seekp(position, ios::beg);                        /// GOING BACK TO FILL IN LIST SIZE ///
-    wavFile.write(reinterpret_cast<const char *>(&value), 4); /// FILLING IN LIST SIZE WITH PROPER NUMERATION ////
-    wavFile.seekp(0, ios::end);                               /// SEEKING END OF FILE ///
-}
 ///////////////PRELIMINARY DATA CHUNK VARIABLES/////////////////
 int ord(char c)
 {
@@ -210,9 +100,7 @@ void writeDataChunk(ofstream &wavFile, const std::string textToTransmit)
     //    long samples_per_character = sampleRate / frequency;
     //    double phaseIncrement = (2.0f * PI * frequency) / static_cast<float>(sampleRate);
 
-    wavFile.write("data", 4);
-    const uint32_t dataChunkSizePos = wavFile.tellp();
-    wavFile.write(reinterpret_cast<const char *>(&headerChunkSize), sizeof(headerChunkSize));
+    const std::streamoff dataChunkSizePos = writeDataChunkHeader(wavFile);
 
     double phaseIncrement = (2.0 * PI * frequency) / sampleRate;
     double phase = 0.0; // Phase accumulator
@@ -223,8 +111,7 @@ void writeDataChunk(ofstream &wavFile, const std::string textToTransmit)
 
     numSamples = (sampleRate / frequency) * intention.length();
 
-    std::vector<char> frames;
-    const size_t bufferSize = 1024 * 1024; // Adjust the buffer size as needed
+    FrameWriter frameWriter(wavFile, numSamples, numChannels * (bitsPerSample / 8));
 
     for (uint32_t i = 0; i < numSamples; ++i)
     {
@@ -256,37 +143,25 @@ void writeDataChunk(ofstream &wavFile, const std::string textToTransmit)
             sample_value = (trendingWave + smoothedAmplitude) * sampleMax * volume_level;
         }
 
-        for (int j = 0; j < numChannels; ++j)
+        if (bitsPerSample == 32)
         {
-            if (bitsPerSample == 32)
-            {
-                int32_t sample_value_32bit = static_cast<int32_t>(sample_value);
-                frames.insert(frames.end(), reinterpret_cast<char *>(&sample_value_32bit), reinterpret_cast<char *>(&sample_value_32bit) + sizeof(sample_value_32bit));
-            }
-            else
+            const int32_t sample_value_32bit = static_cast<int32_t>(sample_value);
+            for (int j = 0; j < numChannels; ++j)
             {
-                int16_t sample_value_16bit = static_cast<int16_t>(sample_value);
-                frames.insert(frames.end(), reinterpret_cast<char *>(&sample_value_16bit), reinterpret_cast<char *>(&sample_value_16bit) + sizeof(sample_value_16bit));
+                frameWriter.put(sample_value_32bit);
             }
         }
-
-        if (frames.size() >= bufferSize * numChannels * (bitsPerSample / 8))
-        {
-            wavFile.write(frames.data(), frames.size());
-            frames.clear();
-        }
-
-        if (i % 100000 == 0)
+        else
         {
-            std::cout << "\rProgress: " << std::fixed << std::setprecision(2) << static_cast<float>(i) / static_cast<float>(numSamples) * 100.0f << "% Samples Written: " << std::to_string(i) << "     \r" << std::flush;
+            const int16_t sample_value_16bit = static_cast<int16_t>(sample_value);
+            for (int j = 0; j < numChannels; ++j)
+            {
+                frameWriter.put(sample_value_16bit);
+            }
         }
     }
 
-    if (frames.size() > 0)
-    {
-        wavFile.write(frames.data(), frames.size());
-        frames.clear();
-    }
+    frameWriter.finish();
 
     uint32_t actualDataSize = static_cast<uint32_t>(static_cast<int64_t>(wavFile.tellp()) - dataChunkSizePos - 4);
     if (actualDataSize % 2 != 0)
@@ -298,117 +173,16 @@ void writeDataChunk(ofstream &wavFile, const std::string textToTransmit)
     // Ensure data alignment after writing the main data chunk
     ensureDataAlignment(wavFile);
 
-    wavFile.seekp(dataChunkSizePos, ios::beg);
-    wavFile.write(reinterpret_cast<const char *>(&actualDataSize), 4);
-    wavFile.seekp(0, ios::end);
+    writeDataChunkSizeElement(wavFile, dataChunkSizePos, actualDataSize, numSamples);
 
     std::cout << "\rProgress: 100.00%"
               << " Samples Written: " << std::to_string(numSamples) << "     \r" << std::endl;
 
-    if (frames.size() > 0)
-    {
-        wavFile.write(frames.data(), frames.size());
-        frames.clear();
-    }
     std::cout << "\rProgress: 100.00%"
               << " Samples Written: " << std::to_string(numSamples) << "     \r" << std::endl;
 }
 /// //////////////////////////////END OF RIFF TAG////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /// /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-/// /////////////////////////////START OF ID3V2 TAG////////////////////////////////////////////////////////////////////////////////////////////
-const uint8_t majorVersion = 0x04; // ID3v2.4 version number
-const uint8_t minorVersion = 0x00; // Revision number
-const uint8_t paddingByte = 0x00;  // Zero byte
-void writeLittleEndian(std::ofstream &file, uint32_t value)
-{
-    file.put(value & 0xFF);
-    file.put((value >> 8) & 0xFF);
-    file.put((value >> 16) & 0xFF);
-    file.put((value >> 24) & 0xFF);
-}
-void writeBigEndian(std::ofstream &file, uint32_t value)
-{
-    file.put((value >> 24) & 0xFF);
-    file.put((value >> 16) & 0xFF);
-    file.put((value >> 8) & 0xFF);
-    file.put(value & 0xFF);
-}
-uint32_t checkForAndWritePadding(ofstream &wavFile)
-{ /// Calculate padding needed to align frame start to a multiple of 4 bytes
-    const uint32_t paddingSize = (BYTEALIGNMENTFORWAVPRODUCER - (wavFile.tellp() % BYTEALIGNMENTFORWAVPRODUCER)) % BYTEALIGNMENTFORWAVPRODUCER;
-    for (uint32_t i = 0; i < paddingSize; ++i)
-    {
-        wavFile.write(reinterpret_cast<const char *>(&paddingByte), sizeof(paddingByte));
-    }
-    return paddingSize;
-}
-void writePadding(ofstream &wavFile)
-{ /// Calculate padding needed to align frame start to a multiple of 4 bytes
-    uint32_t paddingSize = (BYTEALIGNMENTFORWAVPRODUCER - (wavFile.tellp() % BYTEALIGNMENTFORWAVPRODUCER)) % BYTEALIGNMENTFORWAVPRODUCER;
-    if (paddingSize == 0)
-        paddingSize = BYTEALIGNMENTFORWAVPRODUCER;
-    for (uint32_t i = 0; i < paddingSize; ++i)
-    {
-        wavFile.write(reinterpret_cast<const char *>(&paddingByte), sizeof(paddingByte));
-    }
-}
-uint32_t createID3Header(ofstream &wavFile, const uint32_t tagSize = 0, const uint8_t flags = 0x00)
-{
-    //    const uint32_t paddingAdded = checkForAndWritePadding(wavFile);
-    wavFile.write("ID3", 3);                                         /// WRITE TAG OF HEADER OF ID3TAG
-    wavFile.write(reinterpret_cast<const char *>(&majorVersion), 1); /// WRITE MAJOR VERSION
-    wavFile.write(reinterpret_cast<const char *>(&minorVersion), 1); /// WRITE MINOR VERSION
-    wavFile.write(reinterpret_cast<const char *>(&flags), 1);        /// WRITE FLAGS
-    const uint32_t ID3HeaderSizeElementLocation = wavFile.tellp();
-    const uint32_t actualTagSize = tagSize;
-    if constexpr (std::endian::native == std::endian::little)
-    { /// WRITE TAG SIZE = SIZE OF ID3 TAG MINUS HEADER
-        writeLittleEndian(wavFile, actualTagSize);
-    }
-    else if constexpr (std::endian::native == std::endian::big)
-    {
-        writeBigEndian(wavFile, actualTagSize);
-    }
-    else
-    {
-        wavFile.write(reinterpret_cast<const char *>(&actualTagSize), 4);
-    }
-    return ID3HeaderSizeElementLocation;
-}
-void createID3Footer(ofstream &wavFile, const uint32_t tagSize = 0, const uint8_t flags = 0x00)
-{
-    //    checkForAndWritePadding(wavFile);
-    wavFile.write("3DI", 3);                                         /// WRITE TAG OF FOOTER OF ID3TAG WHICH IS BACKWARDS HEADER ID
-    wavFile.write(reinterpret_cast<const char *>(&majorVersion), 1); /// WRITE MAJOR VERSION
-    wavFile.write(reinterpret_cast<const char *>(&minorVersion), 1); /// WRITE MINOR VERSION
-    wavFile.write(reinterpret_cast<const char *>(&flags), 1);        /// WRITE FLAGS
-    wavFile.write(reinterpret_cast<const char *>(&tagSize), 4);      /// WRITE TAG SIZE
-}
-uint32_t createID3FrameHeader(ofstream &wavFile, const char *frameID, const uint32_t frameSize = 0, const uint16_t flags = 0x00)
-{
-    //    checkForAndWritePadding(wavFile);
-    wavFile.write(frameID, 4); /// The frame ID is made out of the characters capital A-Z and 0-9. Identifiers beginning with �X�, �Y� and �Z�
-    const uint32_t frameSizePosition = wavFile.tellp();
-    wavFile.write(reinterpret_cast<const char *>(&frameSize), 4);
-    wavFile.write(reinterpret_cast<const char *>(&flags), 2);
-    return frameSizePosition;
-}
-void setID3HeaderSize(ofstream &wavFile, const uint32_t frameSizeElementLocation, const uint32_t frameChunkSize)
-{
-    const uint32_t currentPos = wavFile.tellp();
-    wavFile.seekp(frameSizeElementLocation, std::ios::beg);
-    wavFile.write(reinterpret_cast<const char *>(&frameChunkSize), 4);
-    wavFile.seekp(currentPos, std::ios::beg);
-    createID3Footer(wavFile, frameChunkSize);
-}
-void insertID3Frame(ofstream &wavFile, const string &key, const string &value)
-{
-    const uint32_t frameSize = key.size() + value.size() + 1; /// Size of frame = size of key + size of value + 1 (for null terminator)
-    createID3FrameHeader(wavFile, key.c_str(), frameSize);
-    wavFile.write("\0", 1); // Null terminator between key and value
-    wavFile.write(value.c_str(), value.size());
-}
-/// ////////////////////////////////////////////////END OF ID3V2 TAG///////////////////////////////////////////////////////////////////////////
 /// CONVERT A TEXT FILE TO A VECTOR OF SINGLE BYTES ///
 std::string readFileToString(const string &filename)
 {
@@ -8,12 +8,516 @@ Repeats an intention to a file a specified number of times.
 #include <string.h>
 #include <iostream>
 #include <fstream>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <iomanip>
+#include <mutex>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#endif
 
 using namespace std;
 
+// The output is the line intention + "\n" over and over, so the byte at offset o is always
+// line[o % line length]. The file is cut into fixed blocks written in parallel with pwrite at
+// their own offsets; every block is a slice of one pattern buffer, starting at its phase.
+const size_t DEFAULT_BLOCK_SIZE = 8 * 1024 * 1024;
+const size_t DIRECT_IO_ALIGNMENT = 4096;
+
+// With --clone only a seed of whole lines and whole file system blocks is written, at least
+// MIN_CLONE_SEED long, and the rest of the file shares its extents. Lines whose length has few
+// factors of two repeat on a block boundary only every line length * block size bytes; past
+// MAX_CLONE_UNIT that is too far apart to be worth it.
+const unsigned long long MIN_CLONE_SEED = 1024 * 1024;
+const unsigned long long MAX_CLONE_UNIT = 64 * 1024 * 1024;
+
+struct WriterSettings
+{
+    string intention, filename, repetitions;
+    bool haveIntention = false;
+    unsigned int threads = 0; // 0 = one per core
+    size_t blockSize = DEFAULT_BLOCK_SIZE;
+    bool directIO = false;
+    bool copyRange = false;
+    bool clone = false;
+};
+
+void printHelp()
+{
+    cout << "Usage: RepeaterFileWriter [options]" << endl
+         << "Anything not given here is asked for." << endl
+         << "  -i, --intent TEXT       Intention to repeat." << endl
+         << "  -r, --repetitions N     Number of times to write it, one per line." << endl
+         << "  -f, --file NAME         Output file." << endl
+         << "  -t, --threads N         Writer threads. Default = One per core." << endl
+         << "  -b, --blocksize MB      Size of each write. Default = " << DEFAULT_BLOCK_SIZE / (1024 * 1024) << "." << endl
+         << "      --direct            Write with O_DIRECT, past the page cache." << endl
+         << "      --copyrange         Write the first block once and copy it in the kernel with copy_file_range." << endl
+         << "      --clone             Write the repeating part once and reflink it over the rest of the file" << endl
+         << "                          (btrfs, XFS, ZFS with block cloning). Falls back to writing every block." << endl
+         << "  -h, --help              Show this help." << endl;
+}
+
+// Writes all of data at offset, across short writes. False on an error, with errno set.
+bool writeAt(int fd, const char *data, size_t length, unsigned long long offset)
+{
+    while (length > 0)
+    {
+        ssize_t written = pwrite(fd, data, length, static_cast<off_t>(offset));
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        length -= static_cast<size_t>(written);
+        offset += static_cast<unsigned long long>(written);
+    }
+    return true;
+}
+
+#ifdef __linux__
+// Copies length bytes at sourceOffset to destinationOffset inside the file without them passing
+// through user space. False if the kernel or file system can't, so the caller writes instead.
+bool copyWithinFile(int fd, unsigned long long sourceOffset, unsigned long long destinationOffset, size_t length)
+{
+    loff_t source = static_cast<loff_t>(sourceOffset);
+    loff_t destination = static_cast<loff_t>(destinationOffset);
+    while (length > 0)
+    {
+        ssize_t copied = copy_file_range(fd, &source, fd, &destination, length, 0);
+        if (copied <= 0)
+        {
+            if (copied < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+        length -= static_cast<size_t>(copied);
+    }
+    return true;
+}
+
+// Makes length bytes at destinationOffset share the extents of the same range at sourceOffset.
+// Offsets and length must be whole file system blocks. False if the file system can't.
+bool cloneWithinFile(int fd, unsigned long long sourceOffset, unsigned long long destinationOffset, unsigned long long length)
+{
+    file_clone_range range;
+    range.src_fd = fd;
+    range.src_offset = sourceOffset;
+    range.src_length = length;
+    range.dest_offset = destinationOffset;
+    while (ioctl(fd, FICLONERANGE, &range) < 0)
+    {
+        if (errno != EINTR)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+#endif
+
+// Length of the seed --clone writes: a whole number of lines that is also a whole number of
+// blocks, so every seed-sized step of the file starts on a block and at the start of a line.
+// 0 when the two only line up too far apart.
+unsigned long long cloneSeedSize(size_t lineSize, unsigned long long fsBlockSize)
+{
+    const unsigned long long unit = lineSize / gcd<unsigned long long>(lineSize, fsBlockSize) * fsBlockSize;
+    if (unit > MAX_CLONE_UNIT)
+    {
+        return 0;
+    }
+    return (MIN_CLONE_SEED + unit - 1) / unit * unit;
+}
+
+enum class CloneResult
+{
+    Written,
+    Unsupported,
+    Failed
+};
+
+// Writes the seed, then clones everything written so far onto the next stretch of the file, so
+// the file doubles with each clone and takes only log2(size / seed) of them. The part past the
+// last whole seed is written normally. Unsupported (after saying why) leaves the file for the
+// ParallelWriter to write over.
+CloneResult writeCloned(const string &filename, const string &line, unsigned long long totalSize)
+{
+#ifdef __linux__
+    // Cloning reads the source range through the same descriptor, so it has to be open for both
+    int fd = open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+    if (fd < 0)
+    {
+        cerr << "Could not open " << filename << ": " << strerror(errno) << endl;
+        return CloneResult::Failed;
+    }
+
+    struct stat info;
+    const unsigned long long seedSize = fstat(fd, &info) == 0 ? cloneSeedSize(line.size(), info.st_blksize) : 0;
+    if (seedSize == 0 || seedSize * 2 > totalSize)
+    {
+        cout << (seedSize == 0 ? "Lines this long only line up with the disk blocks too far apart to clone"
+                               : "The file is too small to clone")
+             << ", writing every block." << endl;
+        close(fd);
+        return CloneResult::Unsupported;
+    }
+
+    auto start = chrono::steady_clock::now();
+    string seed;
+    seed.reserve(seedSize);
+    while (seed.size() < seedSize)
+    {
+        seed += line;
+    }
+    if (ftruncate(fd, static_cast<off_t>(totalSize)) < 0 || !writeAt(fd, seed.data(), seed.size(), 0))
+    {
+        cerr << "Write failed: " << strerror(errno) << endl;
+        close(fd);
+        return CloneResult::Failed;
+    }
+
+    const unsigned long long wholeSeeds = totalSize / seedSize * seedSize;
+    unsigned long long done = seedSize;
+    while (done < wholeSeeds)
+    {
+        const unsigned long long length = min(done, wholeSeeds - done);
+        if (!cloneWithinFile(fd, 0, done, length))
+        {
+            cout << "Could not clone (" << strerror(errno) << "), writing every block." << endl;
+            close(fd);
+            return CloneResult::Unsupported;
+        }
+        done += length;
+    }
+
+    // done is a whole number of lines, so the tail starts at the start of one
+    if (!writeAt(fd, seed.data(), static_cast<size_t>(totalSize - done), done))
+    {
+        cerr << "Write failed: " << strerror(errno) << endl;
+        close(fd);
+        return CloneResult::Failed;
+    }
+    close(fd);
+
+    const double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "Written " << fixed << setprecision(2) << totalSize / 1e9 << " GB in " << seconds << " s, cloned from a "
+         << setprecision(1) << seedSize / 1e6 << " MB seed." << endl;
+    return CloneResult::Written;
+#else
+    (void)filename;
+    (void)line;
+    (void)totalSize;
+    cout << "Cloning is only supported on Linux, writing every block." << endl;
+    return CloneResult::Unsupported;
+#endif
+}
+
+class ParallelWriter
+{
+public:
+    ParallelWriter(const string &line, unsigned long long totalSize, const WriterSettings &settings)
+        : line(line), totalSize(totalSize), directIO(settings.directIO), copyRange(settings.copyRange)
+    {
+        blockSize = max<size_t>(DIRECT_IO_ALIGNMENT, settings.blockSize / DIRECT_IO_ALIGNMENT * DIRECT_IO_ALIGNMENT);
+        if (copyRange)
+        {
+            // Whole lines per block, so every block is a copy of the first
+            blockSize = max<size_t>(1, blockSize / line.size()) * line.size();
+        }
+        blockCount = (totalSize + blockSize - 1) / blockSize;
+
+        // Enough of the repeated line that a block can start at any phase of it
+        const size_t patternSize = copyRange ? blockSize : blockSize + line.size();
+        pattern.reserve(patternSize + line.size());
+        while (pattern.size() < patternSize)
+        {
+            pattern += line;
+        }
+
+        threadCount = settings.threads > 0 ? settings.threads : max(1u, thread::hardware_concurrency());
+        if (threadCount > blockCount)
+        {
+            threadCount = static_cast<unsigned int>(max<unsigned long long>(1, blockCount));
+        }
+    }
+
+    // False on a failure, after printing why.
+    bool write(const string &filename)
+    {
+        fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+        if (fd < 0)
+        {
+            cerr << "Could not open " << filename << ": " << strerror(errno) << endl;
+            return false;
+        }
+
+#ifdef __linux__
+        // Reserve the exact final size up front so the file system can lay it out in one piece.
+        if (totalSize > 0 && fallocate(fd, 0, 0, static_cast<off_t>(totalSize)) < 0 && errno == ENOSPC)
+        {
+            cerr << "Not enough disk space for " << totalSize << " bytes." << endl;
+            close(fd);
+            return false;
+        }
+        if (directIO)
+        {
+            directFd = open(filename.c_str(), O_WRONLY | O_DIRECT);
+            if (directFd < 0)
+            {
+                cout << "O_DIRECT is not supported here, writing through the page cache." << endl;
+            }
+        }
+#else
+        if (directIO)
+        {
+            cout << "O_DIRECT is only supported on Linux, writing through the page cache." << endl;
+        }
+#endif
+        if (ftruncate(fd, static_cast<off_t>(totalSize)) < 0)
+        {
+            cerr << "Could not size " << filename << ": " << strerror(errno) << endl;
+            closeFiles();
+            return false;
+        }
+
+        // With --copyrange the first block is written here so the workers have something to copy.
+        if (copyRange && blockCount > 0 && !writeBlock(0, nullptr))
+        {
+            cerr << "Write failed: " << strerror(errno) << endl;
+            closeFiles();
+            return false;
+        }
+        if (copyRange && blockCount > 0)
+        {
+            bytesWritten = min<unsigned long long>(blockSize, totalSize);
+            nextBlock = 1;
+        }
+
+        vector<thread> workers;
+        for (unsigned int t = 0; t < threadCount; t++)
+        {
+            workers.emplace_back(&ParallelWriter::worker, this);
+        }
+        reportProgress();
+        for (auto &worker : workers)
+        {
+            worker.join();
+        }
+
+        closeFiles();
+        if (failed)
+        {
+            cerr << "Write failed: " << strerror(failureErrno) << endl;
+            return false;
+        }
+        return true;
+    }
+
+private:
+    unsigned long long blockOffset(unsigned long long block) const { return block * blockSize; }
+
+    // Writes one block. staging is an aligned buffer for O_DIRECT, or null when there isn't one.
+    bool writeBlock(unsigned long long block, char *staging)
+    {
+        const unsigned long long offset = blockOffset(block);
+        const size_t length = static_cast<size_t>(min<unsigned long long>(blockSize, totalSize - offset));
+        const char *data = pattern.data() + offset % line.size();
+
+#ifdef __linux__
+        if (copyRange && block > 0 && copyWorks)
+        {
+            if (copyWithinFile(fd, 0, offset, length))
+            {
+                return true;
+            }
+            copyWorks = false; // Not on this file system; write the rest
+        }
+
+        // O_DIRECT takes only whole aligned blocks from aligned memory; the short last block goes through the page cache
+        if (directFd >= 0 && staging != nullptr && length % DIRECT_IO_ALIGNMENT == 0)
+        {
+            memcpy(staging, data, length);
+            return writeAt(directFd, staging, length, offset);
+        }
+#else
+        (void)staging;
+#endif
+        return writeAt(fd, data, length, offset);
+    }
+
+    void worker()
+    {
+        char *staging = nullptr;
+        if (directFd >= 0 && posix_memalign(reinterpret_cast<void **>(&staging), DIRECT_IO_ALIGNMENT, blockSize) != 0)
+        {
+            staging = nullptr;
+        }
+
+        for (unsigned long long block = nextBlock++; block < blockCount && !failed; block = nextBlock++)
+        {
+            if (!writeBlock(block, staging))
+            {
+                failureErrno = errno;
+                failed = true;
+                break;
+            }
+            const unsigned long long length = min<unsigned long long>(blockSize, totalSize - blockOffset(block));
+            bytesWritten += length;
+        }
+        free(staging);
+
+        {
+            lock_guard<mutex> lock(progressMutex);
+            finishedWorkers++;
+        }
+        workersDone.notify_all();
+    }
+
+    // Once a second until the workers are done: bytes written so far and the rate over the last second.
+    // It wakes as soon as the last worker finishes, so the total time is not rounded up to a poll.
+    void reportProgress()
+    {
+        auto start = chrono::steady_clock::now();
+        auto last = start;
+        unsigned long long lastBytes = bytesWritten;
+        unique_lock<mutex> lock(progressMutex);
+        while (!workersDone.wait_until(lock, last + chrono::seconds(1), [this] { return finishedWorkers == threadCount; }))
+        {
+            auto now = chrono::steady_clock::now();
+            const unsigned long long bytes = bytesWritten;
+            const double seconds = chrono::duration<double>(now - last).count();
+            cout << "Written " << fixed << setprecision(2) << bytes / 1e9 << " of " << totalSize / 1e9 << " GB ("
+                 << setprecision(1) << 100.0 * bytes / totalSize << "%), " << (bytes - lastBytes) / seconds / 1e6
+                 << " MB/s.     \r" << flush;
+            last = now;
+            lastBytes = bytes;
+        }
+        const double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        if (totalSize > 0 && !failed)
+        {
+            cout << "Written " << fixed << setprecision(2) << totalSize / 1e9 << " GB in " << seconds << " s ("
+                 << setprecision(1) << totalSize / max(seconds, 1e-9) / 1e6 << " MB/s).     " << endl;
+        }
+    }
+
+    void closeFiles()
+    {
+        if (directFd >= 0)
+        {
+            close(directFd);
+        }
+        close(fd);
+    }
+
+    const string &line;
+    const unsigned long long totalSize;
+    const bool directIO;
+    const bool copyRange;
+    size_t blockSize;
+    unsigned long long blockCount;
+    string pattern;
+    unsigned int threadCount;
+    int fd = -1;
+    int directFd = -1;
+    atomic<unsigned long long> nextBlock{0};
+    atomic<unsigned long long> bytesWritten{0};
+    atomic<bool> failed{false};
+    atomic<bool> copyWorks{true};
+    atomic<int> failureErrno{0};
+    mutex progressMutex;
+    condition_variable workersDone;
+    unsigned int finishedWorkers = 0;
+};
+
+// Reads an unsigned number from text, or returns false.
+bool parseNumber(const string &text, unsigned long long &value)
+{
+    char *end = nullptr;
+    errno = 0;
+    value = strtoull(text.c_str(), &end, 10);
+    return !text.empty() && text[0] != '-' && errno == 0 && *end == '\0';
+}
+
 int main(int argc, char **argv)
 {
 
+    WriterSettings settings;
+    for (int i = 1; i < argc; i++)
+    {
+        string option = argv[i];
+        unsigned long long value = 0;
+        bool hasValue = i + 1 < argc;
+        if (option == "-h" || option == "--help")
+        {
+            printHelp();
+            return 0;
+        }
+        else if (option == "--direct")
+        {
+            settings.directIO = true;
+        }
+        else if (option == "--copyrange")
+        {
+            settings.copyRange = true;
+        }
+        else if (option == "--clone")
+        {
+            settings.clone = true;
+        }
+        else if ((option == "-i" || option == "--intent") && hasValue)
+        {
+            settings.intention = argv[++i];
+            settings.haveIntention = true;
+        }
+        else if ((option == "-r" || option == "--repetitions") && hasValue)
+        {
+            settings.repetitions = argv[++i];
+        }
+        else if ((option == "-f" || option == "--file") && hasValue)
+        {
+            settings.filename = argv[++i];
+        }
+        else if ((option == "-t" || option == "--threads") && hasValue && parseNumber(argv[i + 1], value) && value > 0 && value <= 1024)
+        {
+            settings.threads = static_cast<unsigned int>(value);
+            i++;
+        }
+        else if ((option == "-b" || option == "--blocksize") && hasValue && parseNumber(argv[i + 1], value) && value > 0 && value <= 1024)
+        {
+            settings.blockSize = static_cast<size_t>(value) * 1024 * 1024;
+            i++;
+        }
+        else
+        {
+            cerr << "Invalid option: " << option << endl;
+            printHelp();
+            return 1;
+        }
+    }
+    if (settings.directIO && settings.copyRange)
+    {
+        cerr << "--direct and --copyrange can't be used together." << endl;
+        return 1;
+    }
+
     std::string intention, str_repetitions, filename;
     unsigned long long int repetitions;
 
@@ -21,28 +525,56 @@ int main(int argc, char **argv)
     cout << "By Anthro Teacher (AnthroHeart) aka Thomas Sweet" << endl
          << endl;
 
-    cout << "Intention: ";
-    std::getline(std::cin, intention);
-
-    cout << "Repetitions (Ex. 10000000): ";
-    std::getline(std::cin, str_repetitions);
+    intention = settings.intention;
+    if (!settings.haveIntention)
+    {
+        cout << "Intention: ";
+        std::getline(std::cin, intention);
+    }
 
-    repetitions = std::stoll(str_repetitions);
+    str_repetitions = settings.repetitions;
+    if (str_repetitions.empty())
+    {
+        cout << "Repetitions (Ex. 10000000): ";
+        std::getline(std::cin, str_repetitions);
+    }
 
-    cout << "Filename (Ex. file.txt): ";
-    std::getline(std::cin, filename);
+    if (!parseNumber(str_repetitions, repetitions))
+    {
+        cerr << "Invalid number of repetitions: " << str_repetitions << endl;
+        return 1;
+    }
 
-    ofstream o;
-    o.open(filename);
+    filename = settings.filename;
+    if (filename.empty())
+    {
+        cout << "Filename (Ex. file.txt): ";
+        std::getline(std::cin, filename);
+    }
 
-    for (unsigned long long int i = 0; i < repetitions; i++)
+    const string line = intention + "\n";
+    if (repetitions > ~0ULL / line.size())
     {
-        o << intention << "\n";
+        cerr << "That many repetitions would not fit in one file." << endl;
+        return 1;
     }
 
-    o.close();
+    const unsigned long long totalSize = line.size() * repetitions;
+    CloneResult cloned = settings.clone ? writeCloned(filename, line, totalSize) : CloneResult::Unsupported;
+    if (cloned == CloneResult::Failed)
+    {
+        return 1;
+    }
+    if (cloned == CloneResult::Unsupported)
+    {
+        ParallelWriter writer(line, totalSize, settings);
+        if (!writer.write(filename))
+        {
+            return 1;
+        }
+    }
 
     cout << "INTENTION REPEATED TO " << filename << endl;
 
     return 0;
-}
\ No newline at end of file
+}
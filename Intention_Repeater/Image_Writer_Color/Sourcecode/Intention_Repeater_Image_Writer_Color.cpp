@@ -1,6 +1,7 @@
 /*
-Intention Repeater Image Writer v2.2 (by Claude 3 Opus and Anthro Teacher)
-Writes an intention to a 1920x1080 BMP.
+Intention Repeater Image Writer v2.3 (by Claude 3 Opus and Anthro Teacher)
+Writes an intention to a BMP or PNG, 1920x1080 unless another size is given.
+To compile: g++ -O3 -Wall -static -std=c++20 -pthread Intention_Repeater_Image_Writer_Color.cpp -o Intention_Repeater_Image_Writer_Color -lz
 */
 
 #include <iostream>
@@ -8,11 +9,42 @@ Writes an intention to a 1920x1080 BMP.
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cmath>
 #include <cstdint>
 #include <cstdlib>  // For rand() and srand()
+#include <cctype>
+#include <cstring>
 #include <ctime>    // For time()
 #include <random>
+#include <numeric>
+#include <sstream>
+#include <thread>
+#include "zlib.h"
+#ifdef __linux__
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <linux/fs.h>
+#endif
+
+// 16K, the largest side either way
+const uint32_t MAX_DIMENSION = 15360;
+
+// BMP rows are filled in parallel a stripe at a time and written in one go; PNG rows are
+// deflated in parallel bands of about this many bytes each.
+const size_t STRIPE_BYTES = 8 * 1024 * 1024;
+const size_t PNG_BAND_BYTES = 4 * 1024 * 1024;
+const size_t DEFLATE_WINDOW_SIZE = 32768;
+
+// The pixel data is the intention's colors over and over, so past the header the file repeats
+// every few rows. With --clone one seed of that, a whole number of repeats and of file system
+// blocks at least MIN_CLONE_SEED long, is written and reflinked over the rest.
+const uint64_t MIN_CLONE_SEED = 1024 * 1024;
+const uint64_t MAX_CLONE_UNIT = 64 * 1024 * 1024;
 
 struct RGB {
     unsigned char r;
@@ -20,11 +52,13 @@ struct RGB {
     unsigned char b;
 };
 
-void writeBytes(std::ofstream& file, const void* data, size_t size) {
+enum class ImageFormat { BMP, PNG };
+
+void writeBytes(std::ostream& file, const void* data, size_t size) {
     file.write(static_cast<const char*>(data), size);
 }
 
-void writeInt32(std::ofstream& file, int32_t value) {
+void writeInt32(std::ostream& file, int32_t value) {
     unsigned char bytes[4];
     bytes[0] = value & 0xFF;
     bytes[1] = (value >> 8) & 0xFF;
@@ -33,10 +67,9 @@ void writeInt32(std::ofstream& file, int32_t value) {
     writeBytes(file, bytes, 4);
 }
 
-void writeBMPHeader(std::ofstream& file, int width, int height) {
+void writeBMPHeader(std::ostream& file, int width, int height, uint32_t imageSize) {
     const int headerSize = 54;
-    const int imageSize = width * height * 3;
-    const int fileSize = headerSize + imageSize;
+    const uint32_t fileSize = headerSize + imageSize;
 
     // Write BMP header
     file.put(0x42); // 'B'
@@ -56,42 +89,450 @@ void writeBMPHeader(std::ofstream& file, int width, int height) {
     writeInt32(file, 0); // Important colors
 }
 
+void appendInt32BE(std::string& out, uint32_t value) {
+    out += static_cast<char>((value >> 24) & 0xFF);
+    out += static_cast<char>((value >> 16) & 0xFF);
+    out += static_cast<char>((value >> 8) & 0xFF);
+    out += static_cast<char>(value & 0xFF);
+}
+
+// One PNG chunk: length, type, data and the CRC of type and data.
+void writePNGChunk(std::ostream& file, const char* type, const std::string& data) {
+    std::string chunk;
+    chunk.reserve(data.size() + 12);
+    appendInt32BE(chunk, static_cast<uint32_t>(data.size()));
+    chunk.append(type, 4);
+    chunk += data;
+    uLong crc = crc32(0L, Z_NULL, 0);
+    crc = crc32(crc, reinterpret_cast<const Bytef*>(chunk.data() + 4), static_cast<uInt>(chunk.size() - 4));
+    appendInt32BE(chunk, static_cast<uint32_t>(crc));
+    file.write(chunk.data(), chunk.size());
+}
+
 RGB getColorForChar(char c, int lowestASCII, int range, int rRand, int gRand, int bRand) {
     int asciiValue = static_cast<int>(c);
-    
-    // Calculate the normalized value within the range
-    double normalizedValue = static_cast<double>(asciiValue - lowestASCII) / range;
-    
+
+    // Calculate the normalized value within the range; an intention of one character is all 0
+    double normalizedValue = range > 0 ? static_cast<double>(asciiValue - lowestASCII) / range : 0.0;
+
     // Generate RGB values based on the normalized value and random values
     unsigned char r = static_cast<unsigned char>(std::round(normalizedValue * rRand));
     unsigned char g = static_cast<unsigned char>(std::round(normalizedValue * gRand));
     unsigned char b = static_cast<unsigned char>(std::round(normalizedValue * bRand));
-    
+
     return {r, g, b};
 }
 
-int main() {
+// Every char's color, worked out once instead of per pixel
+std::array<RGB, 256> buildPalette(int lowestASCII, int range, int rRand, int gRand, int bRand) {
+    std::array<RGB, 256> palette;
+    for (int i = 0; i < 256; ++i) {
+        palette[i] = getColorForChar(static_cast<char>(i), lowestASCII, range, rRand, gRand, bRand);
+    }
+    return palette;
+}
+
+// The image is the intention's colors laid along the rows over and over, carrying on from one
+// row to the next, with the first row at the bottom. Row r starts at color (r * width) % length,
+// so every row is one slice of colors: the intention's colors in the file's byte order followed
+// by one more row's worth, so no slice has to wrap round.
+class ImageEncoder {
+public:
+    ImageEncoder(const std::string& intention, const std::array<RGB, 256>& palette, uint32_t width, uint32_t height,
+                 ImageFormat format, unsigned int threads)
+        : length(intention.size()), width(width), height(height), format(format), threadCount(threads) {
+        colors.reserve((length + width) * 3);
+        for (uint64_t i = 0; i < length + width; ++i) {
+            const RGB& color = palette[static_cast<unsigned char>(intention[i % length])];
+            if (format == ImageFormat::BMP) {
+                colors += static_cast<char>(color.b);
+                colors += static_cast<char>(color.g);
+                colors += static_cast<char>(color.r);
+            } else {
+                colors += static_cast<char>(color.r);
+                colors += static_cast<char>(color.g);
+                colors += static_cast<char>(color.b);
+            }
+        }
+        rowBytes = static_cast<size_t>(width) * 3;
+        // BMP rows are padded to 4 bytes; PNG rows start with their filter type
+        rowStride = format == ImageFormat::BMP ? (rowBytes + 3) / 4 * 4 : rowBytes + 1;
+    }
+
+    uint64_t dataSize() const { return static_cast<uint64_t>(rowStride) * height; }
+
+    // Bytes after which the BMP pixel data starts over: one pass through the intention when the
+    // rows aren't padded, otherwise enough rows for the row starts to come round again.
+    uint64_t period() const {
+        if (rowStride == rowBytes) {
+            return length * 3;
+        }
+        return rowStride * (length / std::gcd<uint64_t>(width, length));
+    }
+
+    // The first bytes of the pixel data
+    std::string data(uint64_t bytes) const {
+        const uint32_t rows = static_cast<uint32_t>(std::min<uint64_t>(height, (bytes + rowStride - 1) / rowStride));
+        std::string out(static_cast<size_t>(rows) * rowStride, '\0');
+        fillRows(0, rows, reinterpret_cast<unsigned char*>(&out[0]));
+        out.resize(static_cast<size_t>(bytes));
+        return out;
+    }
+
+    bool writeBMP(std::ostream& file) const {
+        writeBMPHeader(file, width, height, static_cast<uint32_t>(dataSize()));
+        const uint32_t stripeRows = static_cast<uint32_t>(std::max<size_t>(1, STRIPE_BYTES / rowStride));
+        std::vector<unsigned char> stripe(static_cast<size_t>(std::min(stripeRows, height)) * rowStride);
+        for (uint32_t first = 0; first < height && file; first += stripeRows) {
+            const uint32_t rows = std::min(stripeRows, height - first);
+            fillRows(first, rows, stripe.data());
+            writeBytes(file, stripe.data(), static_cast<size_t>(rows) * rowStride);
+        }
+        return static_cast<bool>(file);
+    }
+
+    // The IDAT stream is one zlib stream made pigz style: each band of rows is deflated on its own
+    // thread with the 32 KB before it as its dictionary, and the pieces go out back to back
+    // between one zlib header and the combined Adler-32. A group of bands one per thread is
+    // compressed, then written, so only that many are in memory at once.
+    bool writePNG(std::ostream& file, int level) const {
+        const unsigned char signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+        writeBytes(file, signature, sizeof(signature));
+        std::string header;
+        appendInt32BE(header, width);
+        appendInt32BE(header, height);
+        header += '\x08'; // 8 bits per channel
+        header += '\x02'; // RGB
+        header.append(3, '\0'); // Deflate, adaptive filtering, no interlace
+        writePNGChunk(file, "IHDR", header);
+
+        const uint32_t bandRows = static_cast<uint32_t>(std::max<size_t>(1, PNG_BAND_BYTES / rowStride));
+        const uint32_t bandCount = (height + bandRows - 1) / bandRows;
+        uLong checksum = adler32(0L, Z_NULL, 0);
+        for (uint32_t groupStart = 0; groupStart < bandCount && file; groupStart += threadCount) {
+            const uint32_t groupSize = std::min(threadCount, bandCount - groupStart);
+            std::vector<std::string> outputs(groupSize);
+            std::vector<uLong> checksums(groupSize);
+            std::atomic<uint32_t> nextBand(0);
+            std::atomic<bool> failed(false);
+            auto compressBands = [&]() {
+                for (uint32_t i = nextBand++; i < groupSize && !failed; i = nextBand++) {
+                    const uint32_t band = groupStart + i;
+                    if (!compressBand(band * bandRows, std::min(bandRows, height - band * bandRows), band + 1 == bandCount,
+                                      level, outputs[i], checksums[i])) {
+                        failed = true;
+                    }
+                }
+            };
+            runOnThreads(groupSize, compressBands);
+            if (failed) {
+                return false;
+            }
+
+            for (uint32_t i = 0; i < groupSize; ++i) {
+                const uint32_t band = groupStart + i;
+                const uint64_t bandBytes = static_cast<uint64_t>(std::min(bandRows, height - band * bandRows)) * rowStride;
+                checksum = adler32_combine(checksum, checksums[i], static_cast<z_off_t>(bandBytes));
+                std::string chunk;
+                if (band == 0) {
+                    const int levelFlags = (level == Z_DEFAULT_COMPRESSION || level == 6) ? 2 : level < 2 ? 0 : level < 6 ? 1 : 3;
+                    const unsigned int zlibHeader = (Z_DEFLATED + (7 << 4)) << 8 | (levelFlags << 6);
+                    chunk += static_cast<char>((zlibHeader + 31 - zlibHeader % 31) >> 8);
+                    chunk += static_cast<char>((zlibHeader + 31 - zlibHeader % 31) & 0xFF);
+                }
+                chunk += outputs[i];
+                if (band + 1 == bandCount) {
+                    appendInt32BE(chunk, static_cast<uint32_t>(checksum));
+                }
+                std::string().swap(outputs[i]);
+                writePNGChunk(file, "IDAT", chunk);
+            }
+        }
+        writePNGChunk(file, "IEND", "");
+        return static_cast<bool>(file);
+    }
+
+private:
+    // row counts up from the bottom of the file, which is the bottom of a BMP and the top of a PNG
+    void fillRow(uint32_t row, unsigned char* out) const {
+        const uint32_t imageRow = format == ImageFormat::BMP ? row : height - 1 - row;
+        const uint64_t start = static_cast<uint64_t>(imageRow) * width % length;
+        if (format == ImageFormat::PNG) {
+            *out++ = 0; // No filter
+        }
+        std::memcpy(out, colors.data() + start * 3, rowBytes);
+        if (format == ImageFormat::BMP) {
+            std::memset(out + rowBytes, 0, rowStride - rowBytes);
+        }
+    }
+
+    void fillRows(uint32_t first, uint32_t count, unsigned char* out) const {
+        std::atomic<uint32_t> nextRow(0);
+        auto fill = [&]() {
+            for (uint32_t i = nextRow++; i < count; i = nextRow++) {
+                fillRow(first + i, out + static_cast<size_t>(i) * rowStride);
+            }
+        };
+        runOnThreads(count, fill);
+    }
+
+    // Runs work on up to threadCount threads, this one included, but no more than there are items
+    template <typename Work>
+    void runOnThreads(uint32_t items, Work& work) const {
+        std::vector<std::thread> workers;
+        for (uint32_t t = 1; t < std::min(threadCount, items); ++t) {
+            workers.emplace_back([&work]() { work(); });
+        }
+        work();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    // Raw deflate of rows [first, first + count). Every band but the last ends on a sync flush so
+    // the next one's data can follow it straight on.
+    bool compressBand(uint32_t first, uint32_t count, bool last, int level, std::string& output, uLong& checksum) const {
+        const uint32_t dictionaryRows = std::min<uint32_t>(first, static_cast<uint32_t>((DEFLATE_WINDOW_SIZE + rowStride - 1) / rowStride));
+        std::vector<unsigned char> raw(static_cast<size_t>(dictionaryRows + count) * rowStride);
+        for (uint32_t i = 0; i < dictionaryRows + count; ++i) {
+            fillRow(first - dictionaryRows + i, raw.data() + static_cast<size_t>(i) * rowStride);
+        }
+        unsigned char* input = raw.data() + static_cast<size_t>(dictionaryRows) * rowStride;
+        const size_t inputLength = static_cast<size_t>(count) * rowStride;
+        checksum = adler32(adler32(0L, Z_NULL, 0), input, static_cast<uInt>(inputLength));
+
+        z_stream zs;
+        std::memset(&zs, 0, sizeof(zs));
+        if (deflateInit2(&zs, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            return false;
+        }
+        if (dictionaryRows > 0) {
+            const size_t dictionaryLength = std::min(DEFLATE_WINDOW_SIZE, static_cast<size_t>(dictionaryRows) * rowStride);
+            deflateSetDictionary(&zs, input - dictionaryLength, static_cast<uInt>(dictionaryLength));
+        }
+
+        output.resize(deflateBound(&zs, inputLength) + 16);
+        zs.next_in = input;
+        zs.avail_in = static_cast<uInt>(inputLength);
+        zs.next_out = reinterpret_cast<Bytef*>(&output[0]);
+        zs.avail_out = static_cast<uInt>(output.size());
+        int ret = deflate(&zs, last ? Z_FINISH : Z_SYNC_FLUSH);
+        while ((ret == Z_OK || ret == Z_BUF_ERROR) && zs.avail_out == 0) {
+            // The bound does not cover the sync flush marker; grow and finish the flush.
+            size_t used = output.size();
+            output.resize(used * 2);
+            zs.next_out = reinterpret_cast<Bytef*>(&output[used]);
+            zs.avail_out = static_cast<uInt>(output.size() - used);
+            ret = deflate(&zs, last ? Z_FINISH : Z_SYNC_FLUSH);
+        }
+        output.resize(zs.total_out);
+        deflateEnd(&zs);
+        return last ? ret == Z_STREAM_END : (ret == Z_OK || ret == Z_BUF_ERROR) && zs.avail_in == 0;
+    }
+
+    std::string colors;
+    const uint64_t length;
+    const uint32_t width;
+    const uint32_t height;
+    const ImageFormat format;
+    const uint32_t threadCount;
+    size_t rowBytes;
+    size_t rowStride;
+};
+
+enum class CloneResult { Written, Unsupported, Failed };
+
+#ifdef __linux__
+// Writes all of data at offset, across short writes. False on an error, with errno set.
+bool writeAt(int fd, const char* data, size_t length, uint64_t offset) {
+    while (length > 0) {
+        ssize_t written = pwrite(fd, data, length, static_cast<off_t>(offset));
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        length -= static_cast<size_t>(written);
+        offset += static_cast<uint64_t>(written);
+    }
+    return true;
+}
+
+// Makes length bytes at destinationOffset share the extents of the same range at sourceOffset.
+// Offsets and length must be whole file system blocks. False if the file system can't.
+bool cloneWithinFile(int fd, uint64_t sourceOffset, uint64_t destinationOffset, uint64_t length) {
+    file_clone_range range;
+    range.src_fd = fd;
+    range.src_offset = sourceOffset;
+    range.src_length = length;
+    range.dest_offset = destinationOffset;
+    while (ioctl(fd, FICLONERANGE, &range) < 0) {
+        if (errno != EINTR) {
+            return false;
+        }
+    }
+    return true;
+}
+#endif
+
+// Writes header and then the encoder's BMP pixel data. The header doesn't end on a block, so
+// the seed starts at the first block boundary after it: everything up to the end of the seed
+// is written, then each clone copies all of the seeds so far onto the next stretch, and the
+// part past the last whole seed is written normally. Unsupported (after saying why) leaves the
+// file for the ordinary writer to write over.
+CloneResult writeCloned(const std::string& filename, const std::string& header, const ImageEncoder& encoder) {
+#ifdef __linux__
+    // Cloning reads the source range through the same descriptor, so it has to be open for both
+    int fd = open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+    if (fd < 0) {
+        std::cout << "Failed to create the BMP file." << std::endl;
+        return CloneResult::Failed;
+    }
+
+    struct stat info;
+    const uint64_t blockSize = fstat(fd, &info) == 0 && info.st_blksize > 0 ? info.st_blksize : 4096;
+    const uint64_t period = encoder.period();
+    const uint64_t unit = period / std::gcd<uint64_t>(period, blockSize) * blockSize;
+    const uint64_t seedSize = (MIN_CLONE_SEED + unit - 1) / unit * unit;
+    const uint64_t fileSize = header.size() + encoder.dataSize();
+    const uint64_t seedStart = (header.size() + blockSize - 1) / blockSize * blockSize;
+    if (unit > MAX_CLONE_UNIT || seedStart + seedSize * 2 > fileSize) {
+        std::cout << (unit > MAX_CLONE_UNIT ? "This intention only lines up with the disk blocks too far apart to clone"
+                                            : "The image is too small to clone")
+                  << ", writing all of it." << std::endl;
+        close(fd);
+        return CloneResult::Unsupported;
+    }
+
+    const std::string start = header + encoder.data(seedStart + seedSize - header.size());
+    if (ftruncate(fd, static_cast<off_t>(fileSize)) < 0 || !writeAt(fd, start.data(), start.size(), 0)) {
+        std::cout << "Failed to write the BMP file: " << std::strerror(errno) << std::endl;
+        close(fd);
+        return CloneResult::Failed;
+    }
+
+    const uint64_t wholeSeeds = (fileSize - seedStart) / seedSize * seedSize;
+    uint64_t done = seedSize;
+    while (done < wholeSeeds) {
+        const uint64_t length = std::min(done, wholeSeeds - done);
+        if (!cloneWithinFile(fd, seedStart, seedStart + done, length)) {
+            std::cout << "Could not clone (" << std::strerror(errno) << "), writing all of it." << std::endl;
+            close(fd);
+            return CloneResult::Unsupported;
+        }
+        done += length;
+    }
+
+    // Every seed is the same bytes, so the tail is the start of the first one
+    if (!writeAt(fd, start.data() + seedStart, static_cast<size_t>(fileSize - seedStart - done), seedStart + done)) {
+        std::cout << "Failed to write the BMP file: " << std::strerror(errno) << std::endl;
+        close(fd);
+        return CloneResult::Failed;
+    }
+    close(fd);
+    return CloneResult::Written;
+#else
+    (void)filename;
+    (void)header;
+    (void)encoder;
+    std::cout << "Cloning is only supported on Linux, writing all of it." << std::endl;
+    return CloneResult::Unsupported;
+#endif
+}
+
+void printUsage() {
+    std::cout << "Usage: Intention_Repeater_Image_Writer_Color [options]" << std::endl
+              << "  --size WIDTHxHEIGHT    Image size, up to " << MAX_DIMENSION << " a side. Default = 1920x1080." << std::endl
+              << "  --png                  Write a PNG instead of a BMP. Also chosen by a filename ending in .png." << std::endl
+              << "  --level N              PNG compression level, 1 (fastest) to 9 (smallest). Default = 6." << std::endl
+              << "  --threads N            Threads to fill and compress rows on. Default = One per core." << std::endl
+              << "  --clone                Write the repeating pixels once and reflink them over the rest of the image" << std::endl
+              << "                         (BMP only; btrfs, XFS, ZFS with block cloning). Falls back to writing all of it." << std::endl;
+}
+
+// Reads a whole number from 1 to maximum, or returns false.
+bool parseNumber(const std::string& text, uint32_t maximum, uint32_t& value) {
+    char* end = nullptr;
+    unsigned long parsed = std::strtoul(text.c_str(), &end, 10);
+    if (text.empty() || !std::isdigit(static_cast<unsigned char>(text[0])) || *end != '\0' || parsed < 1 || parsed > maximum) {
+        return false;
+    }
+    value = static_cast<uint32_t>(parsed);
+    return true;
+}
+
+bool endsWith(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+int main(int argc, char** argv) {
+    uint32_t width = 1920;
+    uint32_t height = 1080;
+    uint32_t level = 6;
+    uint32_t threads = std::max(1u, std::thread::hardware_concurrency());
+    ImageFormat format = ImageFormat::BMP;
+    bool clone = false;
+    for (int i = 1; i < argc; ++i) {
+        const std::string option = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (option == "--clone") {
+            clone = true;
+        } else if (option == "--png") {
+            format = ImageFormat::PNG;
+        } else if (option == "--size" && hasValue) {
+            const std::string size = argv[++i];
+            const size_t x = size.find_first_of("xX");
+            if (x == std::string::npos || !parseNumber(size.substr(0, x), MAX_DIMENSION, width) ||
+                !parseNumber(size.substr(x + 1), MAX_DIMENSION, height)) {
+                std::cout << "Invalid size: " << size << std::endl;
+                printUsage();
+                return 1;
+            }
+        } else if (option == "--level" && hasValue && parseNumber(argv[i + 1], 9, level)) {
+            ++i;
+        } else if (option == "--threads" && hasValue && parseNumber(argv[i + 1], 1024, threads)) {
+            ++i;
+        } else {
+            printUsage();
+            return option == "-h" || option == "--help" ? 0 : 1;
+        }
+    }
+
     std::string intention;
     std::cout << "Enter Intention or Filename (.txt): ";;
     std::getline(std::cin, intention);
 
     // If intention ends in ".txt" then open the filename given and store its contents in intention
-    if (intention.substr(intention.size() - 4) == ".txt") {
+    if (endsWith(intention, ".txt")) {
         std::ifstream file(intention);
         std::string line;
         while (std::getline(file, line)) {
             intention += line;
         }
     }
+    if (intention.empty()) {
+        std::cout << "No intention given." << std::endl;
+        return 1;
+    }
 
     std::string filename;
-    std::cout << "Filename (.bmp): ";
+    std::cout << (format == ImageFormat::PNG ? "Filename (.png): " : "Filename (.bmp): ");
     std::getline(std::cin, filename);
 
-    // Add ".png" extension if not already present
-    if (filename.substr(filename.size() - 4) != ".bmp") {
+    // Add the extension if not already present
+    if (endsWith(filename, ".png")) {
+        format = ImageFormat::PNG;
+    } else if (format == ImageFormat::PNG) {
+        filename += ".png";
+    } else if (!endsWith(filename, ".bmp")) {
         filename += ".bmp";
     }
+    if (clone && format == ImageFormat::PNG) {
+        std::cout << "--clone only applies to BMP output." << std::endl;
+        return 1;
+    }
 
     int highestASCII = *std::max_element(intention.begin(), intention.end());
     int lowestASCII = *std::min_element(intention.begin(), intention.end());
@@ -106,35 +547,35 @@ int main() {
     int gRand = distrib(gen);
     int bRand = distrib(gen);
 
-    std::vector<RGB> pixels;
-    for (char c : intention) {
-        RGB color = getColorForChar(c, lowestASCII, range, rRand, gRand, bRand);
-        pixels.push_back(color);
-    }
+    const ImageEncoder encoder(intention, buildPalette(lowestASCII, range, rRand, gRand, bRand), width, height, format, threads);
 
-    const int width = 1920;
-    const int height = 1080;
+    if (clone) {
+        std::ostringstream header;
+        writeBMPHeader(header, width, height, static_cast<uint32_t>(encoder.dataSize()));
+        CloneResult result = writeCloned(filename, header.str(), encoder);
+        if (result == CloneResult::Failed) {
+            return 1;
+        }
+        if (result == CloneResult::Written) {
+            std::cout << filename << " written." << std::endl;
+            return 0;
+        }
+    }
 
-    std::ofstream bmpFile(filename, std::ios::binary);
-    if (!bmpFile) {
-        std::cout << "Failed to create the BMP file." << std::endl;
+    std::ofstream imageFile(filename, std::ios::binary);
+    if (!imageFile) {
+        std::cout << "Failed to create the " << (format == ImageFormat::PNG ? "PNG" : "BMP") << " file." << std::endl;
         return 1;
     }
 
-    writeBMPHeader(bmpFile, width, height);
-
-    int pixelIndex = 0;
-    for (int i = 0; i < height; ++i) {
-        for (int j = 0; j < width; ++j) {
-            RGB pixel = pixels[pixelIndex];
-            writeBytes(bmpFile, &pixel, sizeof(RGB));
-            pixelIndex = (pixelIndex + 1) % pixels.size();
-        }
+    const bool written = format == ImageFormat::PNG ? encoder.writePNG(imageFile, static_cast<int>(level)) : encoder.writeBMP(imageFile);
+    imageFile.close();
+    if (!written || !imageFile) {
+        std::cout << "Failed to write " << filename << "." << std::endl;
+        return 1;
     }
 
-    bmpFile.close();
-
     std::cout << filename << " written." << std::endl;
 
     return 0;
-}
\ No newline at end of file
+}
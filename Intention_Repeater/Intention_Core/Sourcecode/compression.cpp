@@ -0,0 +1,150 @@
+/*
+    Intention Core: pigz-style block compression shared by the repeaters.
+    Licensed under GNU General Public License v3.0
+*/
+
+#include "compression.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#ifdef USE_ZSTD
+#include <zstd.h>
+#endif
+#ifdef USE_LZ4
+#include <lz4.h>
+#endif
+
+bool compress_zlib_block(const char *data, size_t length, size_t dictionary_length, bool last, int level, std::string &output)
+{
+    z_stream zs;
+    std::memset(&zs, 0, sizeof(zs));
+    if (deflateInit2(&zs, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+        return false;
+    }
+
+    if (dictionary_length > 0)
+    {
+        deflateSetDictionary(&zs, reinterpret_cast<const Bytef *>(data - dictionary_length), dictionary_length);
+    }
+
+    output.resize(deflateBound(&zs, length) + 16);
+    zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+    zs.avail_in = length;
+    zs.next_out = reinterpret_cast<Bytef *>(&output[0]);
+    zs.avail_out = output.size();
+
+    int ret = deflate(&zs, last ? Z_FINISH : Z_SYNC_FLUSH);
+    while ((ret == Z_OK || ret == Z_BUF_ERROR) && zs.avail_out == 0)
+    {
+        // The bound does not cover the sync flush marker; grow and finish the flush.
+        size_t used = output.size();
+        output.resize(used * 2);
+        zs.next_out = reinterpret_cast<Bytef *>(&output[used]);
+        zs.avail_out = output.size() - used;
+        ret = deflate(&zs, last ? Z_FINISH : Z_SYNC_FLUSH);
+    }
+    output.resize(zs.total_out);
+    deflateEnd(&zs);
+
+    return last ? ret == Z_STREAM_END : (ret == Z_OK || ret == Z_BUF_ERROR) && zs.avail_in == 0;
+}
+
+bool compress_block(CompressionCodec codec, const char *data, size_t length, size_t dictionary_length, bool last, int level, std::string &output)
+{
+    switch (codec)
+    {
+#ifdef USE_ZSTD
+    case CompressionCodec::Zstd:
+    {
+        // Every block is its own zstd frame; concatenated frames decode as one stream.
+        output.resize(ZSTD_compressBound(length));
+        size_t written = ZSTD_compress(&output[0], output.size(), data, length, level);
+        if (ZSTD_isError(written))
+        {
+            return false;
+        }
+        output.resize(written);
+        return true;
+    }
+#endif
+#ifdef USE_LZ4
+    case CompressionCodec::Lz4:
+    {
+        // LZ4 blocks carry no length of their own, so each one is prefixed with its little-endian size.
+        output.resize(4 + LZ4_compressBound(static_cast<int>(length)));
+        int written = LZ4_compress_default(data, &output[4], static_cast<int>(length), static_cast<int>(output.size() - 4));
+        if (written <= 0)
+        {
+            return false;
+        }
+        for (int i = 0; i < 4; i++)
+        {
+            output[i] = static_cast<char>((written >> (8 * i)) & 0xFF);
+        }
+        output.resize(4 + written);
+        return true;
+    }
+#endif
+    default:
+        return compress_zlib_block(data, length, dictionary_length, last, level, output);
+    }
+}
+
+CompressionCodec get_compression_codec(std::string param_codec)
+{
+    std::transform(param_codec.begin(), param_codec.end(), param_codec.begin(), ::toupper);
+
+    if (param_codec == "ZSTD")
+    {
+#ifdef USE_ZSTD
+        return CompressionCodec::Zstd;
+#else
+        std::cerr << "zstd support was not compiled in (build with -DUSE_ZSTD -lzstd). Using zlib." << std::endl;
+#endif
+    }
+    else if (param_codec == "LZ4")
+    {
+#ifdef USE_LZ4
+        return CompressionCodec::Lz4;
+#else
+        std::cerr << "lz4 support was not compiled in (build with -DUSE_LZ4 -llz4). Using zlib." << std::endl;
+#endif
+    }
+    return CompressionCodec::Zlib;
+}
+
+int default_compression_level(CompressionCodec codec)
+{
+#ifdef USE_ZSTD
+    if (codec == CompressionCodec::Zstd)
+    {
+        return ZSTD_CLEVEL_DEFAULT;
+    }
+#endif
+    return codec == CompressionCodec::Zlib ? Z_DEFAULT_COMPRESSION : 0;
+}
+
+int get_compression_level(CompressionCodec codec, const std::string &param_level)
+{
+    if (param_level == "X")
+    {
+        return default_compression_level(codec);
+    }
+    int level = std::atoi(param_level.c_str());
+    if (codec == CompressionCodec::Zlib)
+    {
+        level = (std::max)(0, (std::min)(9, level));
+    }
+    return level;
+}
+
+std::string compressMessage(const std::string &message, CompressionCodec codec, int level)
+{
+    return compress_blocks(
+        message.size(), [&](unsigned long long start) { return message.data() + start; },
+        [](size_t) { return UNIQUE_BLOCK; }, codec, level);
+}
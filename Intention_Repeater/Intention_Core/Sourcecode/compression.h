@@ -0,0 +1,161 @@
+/*
+    Intention Core: pigz-style block compression shared by the repeaters.
+    Licensed under GNU General Public License v3.0
+*/
+
+#ifndef INTENTION_CORE_COMPRESSION_H
+#define INTENTION_CORE_COMPRESSION_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <zlib.h>
+
+// Compression codecs. zlib is always available; build with -DUSE_ZSTD -lzstd and/or
+// -DUSE_LZ4 -llz4 (or the USE_ZSTD / USE_LZ4 CMake options) to add the others.
+enum class CompressionCodec
+{
+    Zlib,
+    Zstd,
+    Lz4
+};
+
+constexpr size_t COMPRESSION_BLOCK_SIZE = 1024 * 1024;
+constexpr size_t DEFLATE_WINDOW_SIZE = 32768;
+constexpr unsigned long long UNIQUE_BLOCK = ~0ULL;
+
+// Compresses one block as raw deflate, primed with the (up to) 32 KB before data so the blocks
+// concatenate into one stream. Every block but the last ends on a byte boundary (sync flush).
+bool compress_zlib_block(const char *data, size_t length, size_t dictionary_length, bool last, int level, std::string &output);
+
+bool compress_block(CompressionCodec codec, const char *data, size_t length, size_t dictionary_length, bool last, int level, std::string &output);
+
+// ZLIB, ZSTD or LZ4, any case. Codecs that were not compiled in fall back to zlib with a warning.
+CompressionCodec get_compression_codec(std::string param_codec);
+
+int default_compression_level(CompressionCodec codec);
+
+// The level for --level: the codec's default when param_level is "X", zlib levels clamped to 0-9.
+int get_compression_level(CompressionCodec codec, const std::string &param_level);
+
+// Compresses total_length bytes in COMPRESSION_BLOCK_SIZE blocks on every core, pigz style.
+// block_data(start) points at the bytes from offset start, with the DEFLATE_WINDOW_SIZE bytes
+// before it readable as the dictionary. Blocks that share a block_key (anything but
+// UNIQUE_BLOCK) hold the same bytes and dictionary, so only the first of them is compressed.
+// With zlib the result is still a single valid zlib stream: one header, the blocks' raw
+// deflate data back to back and the combined Adler-32.
+template <typename BlockData, typename BlockKey>
+std::string compress_blocks(unsigned long long total_length, BlockData block_data, BlockKey block_key, CompressionCodec codec, int level)
+{
+    const size_t block_count = std::max<unsigned long long>(1, (total_length + COMPRESSION_BLOCK_SIZE - 1) / COMPRESSION_BLOCK_SIZE);
+    auto block_length = [&](size_t block)
+    { return static_cast<size_t>(std::min<unsigned long long>(COMPRESSION_BLOCK_SIZE, total_length - block * COMPRESSION_BLOCK_SIZE)); };
+
+    std::vector<size_t> source_of(block_count);
+    std::vector<size_t> unique_blocks;
+    std::unordered_map<unsigned long long, size_t> shared_blocks;
+    for (size_t block = 0; block < block_count; block++)
+    {
+        unsigned long long key = block_key(block);
+        auto shared = shared_blocks.find(key);
+        if (key != UNIQUE_BLOCK && shared != shared_blocks.end())
+        {
+            source_of[block] = shared->second;
+            continue;
+        }
+        source_of[block] = unique_blocks.size();
+        if (key != UNIQUE_BLOCK)
+        {
+            shared_blocks[key] = unique_blocks.size();
+        }
+        unique_blocks.push_back(block);
+    }
+
+    std::vector<std::string> blocks(unique_blocks.size());
+    std::vector<uLong> checksums(unique_blocks.size());
+    std::atomic<size_t> next_block(0);
+    std::atomic<bool> failed(false);
+
+    auto compress_unique_blocks = [&]()
+    {
+        for (size_t index = next_block++; index < unique_blocks.size() && !failed; index = next_block++)
+        {
+            size_t block = unique_blocks[index];
+            unsigned long long start = static_cast<unsigned long long>(block) * COMPRESSION_BLOCK_SIZE;
+            size_t length = block_length(block);
+            const char *data = block_data(start);
+            size_t dictionary_length = static_cast<size_t>(std::min<unsigned long long>(start, DEFLATE_WINDOW_SIZE));
+            if (!compress_block(codec, data, length, dictionary_length, block + 1 == block_count, level, blocks[index]))
+            {
+                failed = true;
+            }
+            if (codec == CompressionCodec::Zlib)
+            {
+                checksums[index] = adler32(adler32(0L, Z_NULL, 0), reinterpret_cast<const Bytef *>(data), length);
+            }
+        }
+    };
+
+    unsigned int thread_count = std::max(1u, std::min<unsigned int>(std::thread::hardware_concurrency(), unique_blocks.size()));
+    std::vector<std::thread> compressors;
+    for (unsigned int t = 1; t < thread_count; t++)
+    {
+        compressors.emplace_back(compress_unique_blocks);
+    }
+    compress_unique_blocks();
+    for (auto &compressor : compressors)
+    {
+        compressor.join();
+    }
+
+    if (failed)
+    {
+        return ""; // Compression failed
+    }
+
+    size_t total = 0;
+    for (size_t block = 0; block < block_count; block++)
+    {
+        total += blocks[source_of[block]].size();
+    }
+
+    std::string compressed;
+    compressed.reserve(total + 6);
+    if (codec == CompressionCodec::Zlib)
+    {
+        int level_flags = (level == Z_DEFAULT_COMPRESSION || level == 6) ? 2 : level < 2 ? 0 : level < 6 ? 1 : 3;
+        unsigned int header = (Z_DEFLATED + (7 << 4)) << 8 | (level_flags << 6);
+        header += 31 - header % 31;
+        compressed += static_cast<char>(header >> 8);
+        compressed += static_cast<char>(header & 0xFF);
+    }
+
+    uLong checksum = adler32(0L, Z_NULL, 0);
+    for (size_t block = 0; block < block_count; block++)
+    {
+        compressed += blocks[source_of[block]];
+        if (codec == CompressionCodec::Zlib)
+        {
+            checksum = adler32_combine(checksum, checksums[source_of[block]], block_length(block));
+        }
+    }
+
+    if (codec == CompressionCodec::Zlib)
+    {
+        for (int shift = 24; shift >= 0; shift -= 8)
+        {
+            compressed += static_cast<char>((checksum >> shift) & 0xFF);
+        }
+    }
+
+    return compressed;
+}
+
+std::string compressMessage(const std::string &message, CompressionCodec codec = CompressionCodec::Zlib, int level = Z_DEFAULT_COMPRESSION);
+
+#endif
@@ -0,0 +1,41 @@
+/*
+    Intention Core: status line formatting shared by the repeaters.
+    Licensed under GNU General Public License v3.0
+*/
+
+#include "display.h"
+
+#include <iomanip>
+#include <sstream>
+
+constexpr int ONE_MINUTE = 60;
+constexpr int ONE_HOUR = 3600;
+
+std::string FormatTime(long long seconds_elapsed)
+{
+    long long hours = seconds_elapsed / ONE_HOUR;
+    int minutes = (seconds_elapsed % ONE_HOUR) / ONE_MINUTE;
+    int seconds = seconds_elapsed % ONE_MINUTE;
+
+    std::ostringstream oss;
+    oss << std::setw(2) << std::setfill('0') << hours << ":"
+        << std::setw(2) << std::setfill('0') << minutes << ":"
+        << std::setw(2) << std::setfill('0') << seconds;
+
+    return oss.str();
+}
+
+std::string display_suffix(const std::string &num, int power, const std::string &designator)
+{
+    if (power < 3)
+    {
+        return num;
+    }
+
+    // Past the last suffix (an IterationCounter goes up to 10^77) the digits are shown bare.
+    const std::string suffix_array = designator == "Iterations" ? " kMBTqQsSOND" : " kMGTPEZYR";
+    size_t index = power / 3;
+    char suffix = index < suffix_array.length() ? suffix_array[index] : ' ';
+
+    return num.substr(0, power % 3 + 1) + "." + num.substr(power % 3 + 1, 3) + suffix;
+}
@@ -0,0 +1,19 @@
+/*
+    Intention Core: status line formatting shared by the repeaters.
+    Licensed under GNU General Public License v3.0
+*/
+
+#ifndef INTENTION_CORE_DISPLAY_H
+#define INTENTION_CORE_DISPLAY_H
+
+#include <string>
+
+// HH:MM:SS, with the hours growing past two digits after 99.
+std::string FormatTime(long long seconds_elapsed);
+
+// num (a decimal string with power + 1 digits) as three significant digits plus a suffix, e.g.
+// "1.234M". designator "Iterations" uses k/M/B/T..., anything else the SI k/M/G/T...
+// Numbers under 1,000 come back unchanged.
+std::string display_suffix(const std::string &num, int power, const std::string &designator);
+
+#endif
@@ -0,0 +1,79 @@
+/*
+    Intention Core: double-buffered sample writer for the WAV tools.
+    Licensed under GNU General Public License v3.0
+*/
+
+#include "frame_writer.h"
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+FrameWriter::FrameWriter(std::ofstream &file, uint64_t totalFrames, size_t frameSize)
+    : file(file), totalFrames(totalFrames), frameSize(frameSize), storage(new char[2 * blockSize + blockAlignment])
+{
+    char *aligned = storage.get() + (blockAlignment - reinterpret_cast<uintptr_t>(storage.get()) % blockAlignment) % blockAlignment;
+    blocks[0] = aligned;
+    blocks[1] = aligned + blockSize;
+    writer = std::thread(&FrameWriter::writeBlocks, this);
+}
+
+void FrameWriter::finish()
+{
+    if (!writer.joinable())
+    {
+        return;
+    }
+    if (fill > 0)
+    {
+        submit();
+    }
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    changed.notify_all();
+    writer.join();
+}
+
+void FrameWriter::submit()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [this]
+                 { return !pending; });
+    pending = true;
+    pendingBlock = active;
+    pendingBytes = fill;
+    lock.unlock();
+    changed.notify_all();
+    active ^= 1;
+    fill = 0;
+}
+
+void FrameWriter::writeBlocks()
+{
+    uint64_t bytesWritten = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        changed.wait(lock, [this]
+                     { return pending || stopping; });
+        if (!pending)
+        {
+            return;
+        }
+        const char *block = blocks[pendingBlock];
+        const size_t bytes = pendingBytes;
+        lock.unlock();
+        file.write(block, bytes);
+        bytesWritten += bytes;
+        if (totalFrames > 0)
+        {
+            const uint64_t framesWritten = bytesWritten / frameSize;
+            std::cout << "\rProgress: " << std::fixed << std::setprecision(2) << static_cast<float>(framesWritten) / static_cast<float>(totalFrames) * 100.0f << "% Samples Written: " << std::to_string(framesWritten) << "     \r" << std::flush;
+        }
+        lock.lock();
+        pending = false;
+        changed.notify_all();
+    }
+}
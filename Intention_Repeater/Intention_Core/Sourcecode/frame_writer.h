@@ -0,0 +1,79 @@
+/*
+    Intention Core: double-buffered sample writer for the WAV tools.
+    Licensed under GNU General Public License v3.0
+*/
+
+#ifndef INTENTION_CORE_FRAME_WRITER_H
+#define INTENTION_CORE_FRAME_WRITER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Samples go into one of two fixed, page-aligned blocks. A full block is handed to a background
+// thread that writes it to the file while the caller fills the other one, so sample generation
+// and disk I/O overlap. The writer thread also prints the progress line once per block when
+// totalFrames is given. Call finish() before touching the file again (tellp, seekp or more chunks).
+class FrameWriter
+{
+public:
+    static constexpr size_t blockSize = 8 * 1024 * 1024;
+    static constexpr size_t blockAlignment = 4096;
+
+    FrameWriter(std::ofstream &file, uint64_t totalFrames = 0, size_t frameSize = 1);
+    FrameWriter(const FrameWriter &) = delete;
+    FrameWriter &operator=(const FrameWriter &) = delete;
+    ~FrameWriter() { finish(); }
+
+    template <typename SampleType>
+    inline void put(SampleType sample)
+    {
+        if (fill + sizeof(SampleType) > blockSize)
+        {
+            submit();
+        }
+        std::memcpy(blocks[active] + fill, &sample, sizeof(SampleType));
+        fill += sizeof(SampleType);
+    }
+
+    // Contiguous space for bytes (at most blockSize) in the current block, for callers that
+    // render straight into it.
+    char *reserve(size_t bytes)
+    {
+        if (fill + bytes > blockSize)
+        {
+            submit();
+        }
+        char *space = blocks[active] + fill;
+        fill += bytes;
+        return space;
+    }
+
+    void finish();
+
+private:
+    void submit();
+    void writeBlocks();
+
+    std::ofstream &file;
+    const uint64_t totalFrames;
+    const size_t frameSize;
+    std::unique_ptr<char[]> storage;
+    char *blocks[2];
+    int active = 0;
+    size_t fill = 0;
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool pending = false;
+    bool stopping = false;
+    int pendingBlock = 0;
+    size_t pendingBytes = 0;
+    std::thread writer;
+};
+
+#endif
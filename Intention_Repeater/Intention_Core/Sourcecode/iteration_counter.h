@@ -0,0 +1,117 @@
+/*
+    Intention Core: arbitrary-size iteration and frequency totals.
+    Licensed under GNU General Public License v3.0
+*/
+
+#ifndef INTENTION_CORE_ITERATION_COUNTER_H
+#define INTENTION_CORE_ITERATION_COUNTER_H
+
+#include <cstdint>
+#include <string>
+
+// Running iteration/frequency total. The value lives in a fixed array of 64-bit
+// limbs (256 bits, up to ~1.1x10^77), so adding and multiplying never allocate.
+// unsigned __int128 is used for the limb products where the compiler has it.
+class IterationCounter
+{
+public:
+    IterationCounter(uint64_t value = 0) : limbs{value, 0, 0, 0} {}
+
+    IterationCounter &operator+=(const IterationCounter &other)
+    {
+        uint64_t carry = 0;
+        for (int i = 0; i < LIMBS; ++i)
+        {
+            uint64_t sum = limbs[i] + carry;
+            carry = (sum < carry);
+            limbs[i] = sum + other.limbs[i];
+            carry += (limbs[i] < sum);
+        }
+        return *this;
+    }
+
+    IterationCounter &operator*=(uint64_t factor)
+    {
+        uint64_t carry = 0;
+        for (int i = 0; i < LIMBS; ++i)
+        {
+#ifdef __SIZEOF_INT128__
+            unsigned __int128 product = static_cast<unsigned __int128>(limbs[i]) * factor + carry;
+            limbs[i] = static_cast<uint64_t>(product);
+            carry = static_cast<uint64_t>(product >> 64);
+#else
+            uint64_t a_lo = limbs[i] & 0xFFFFFFFFULL, a_hi = limbs[i] >> 32;
+            uint64_t b_lo = factor & 0xFFFFFFFFULL, b_hi = factor >> 32;
+            uint64_t lo_lo = a_lo * b_lo, hi_lo = a_hi * b_lo, lo_hi = a_lo * b_hi, hi_hi = a_hi * b_hi;
+            uint64_t middle = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFFULL) + lo_hi;
+            uint64_t low = (middle << 32) | (lo_lo & 0xFFFFFFFFULL);
+            uint64_t high = hi_hi + (hi_lo >> 32) + (middle >> 32);
+            low += carry;
+            high += (low < carry);
+            limbs[i] = low;
+            carry = high;
+#endif
+        }
+        return *this;
+    }
+
+    bool is_zero() const
+    {
+        for (int i = 0; i < LIMBS; ++i)
+        {
+            if (limbs[i] != 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Decimal digits, for display_suffix and the EXP output.
+    std::string str() const
+    {
+        char buffer[LIMBS * 20 + 1];
+        char *end = buffer + sizeof(buffer);
+        char *pos = end;
+        IterationCounter value = *this;
+
+        do
+        {
+            uint32_t chunk = value.divide(1000000000U);
+            for (int i = 0; i < 9 && (chunk != 0 || !value.is_zero()); ++i)
+            {
+                *--pos = static_cast<char>('0' + chunk % 10);
+                chunk /= 10;
+            }
+        } while (!value.is_zero());
+
+        if (pos == end)
+        {
+            *--pos = '0';
+        }
+        return std::string(pos, end);
+    }
+
+private:
+    static constexpr int LIMBS = 4;
+    uint64_t limbs[LIMBS];
+
+    // Divides in place and returns the remainder. Works in 32-bit halves so it needs no 128-bit type.
+    uint32_t divide(uint32_t divisor)
+    {
+        uint64_t remainder = 0;
+        for (int i = LIMBS - 1; i >= 0; --i)
+        {
+            uint64_t high = (remainder << 32) | (limbs[i] >> 32);
+            uint64_t quotient_high = high / divisor;
+            remainder = high % divisor;
+            uint64_t low = (remainder << 32) | (limbs[i] & 0xFFFFFFFFULL);
+            uint64_t quotient_low = low / divisor;
+            remainder = low % divisor;
+            limbs[i] = (quotient_high << 32) | quotient_low;
+        }
+        return static_cast<uint32_t>(remainder);
+    }
+};
+
+#endif
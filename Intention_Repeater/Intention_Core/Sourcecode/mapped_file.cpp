@@ -0,0 +1,79 @@
+/*
+    Intention Core: read-only file mappings.
+    Licensed under GNU General Public License v3.0
+*/
+
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+bool MappedFile::map(const std::string &filename, bool sequential)
+{
+    unmap();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_FLAG_RANDOM_ACCESS, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    LARGE_INTEGER file_size;
+    if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0)
+    {
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping != nullptr)
+        {
+            mapped_data = static_cast<const char *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            CloseHandle(mapping);
+        }
+        if (mapped_data != nullptr)
+        {
+            mapped_size = static_cast<size_t>(file_size.QuadPart);
+        }
+    }
+    CloseHandle(file);
+#else
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0)
+    {
+        void *mapping = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED)
+        {
+            mapped_data = static_cast<const char *>(mapping);
+            mapped_size = static_cast<size_t>(info.st_size);
+            madvise(mapping, mapped_size, sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+        }
+    }
+    ::close(fd);
+#endif
+    return mapped_data != nullptr;
+}
+
+void MappedFile::unmap()
+{
+    if (mapped_data != nullptr)
+    {
+#ifdef _WIN32
+        UnmapViewOfFile(mapped_data);
+#else
+        munmap(const_cast<char *>(mapped_data), mapped_size);
+#endif
+    }
+    mapped_data = nullptr;
+    mapped_size = 0;
+}
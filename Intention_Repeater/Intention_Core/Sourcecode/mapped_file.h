@@ -0,0 +1,37 @@
+/*
+    Intention Core: read-only file mappings.
+    Licensed under GNU General Public License v3.0
+*/
+
+#ifndef INTENTION_CORE_MAPPED_FILE_H
+#define INTENTION_CORE_MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Read-only memory map of a whole file. Pages are faulted in as they are read and stay in the
+// page cache, so nothing is copied onto the heap until the caller decides it has to be.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    ~MappedFile() { unmap(); }
+
+    // False when the file can't be opened, is empty, or isn't a regular on-disk file.
+    // sequential tells the OS the file will be read front to back, so it reads ahead;
+    // pass false for files that are looked up at random.
+    bool map(const std::string &filename, bool sequential = true);
+
+    std::string_view view() const { return std::string_view(mapped_data, mapped_size); }
+
+    void unmap();
+
+private:
+    const char *mapped_data = nullptr;
+    size_t mapped_size = 0;
+};
+
+#endif
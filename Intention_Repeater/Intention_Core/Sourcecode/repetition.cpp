@@ -0,0 +1,78 @@
+/*
+    Intention Core: building the repeated intention buffers.
+    Licensed under GNU General Public License v3.0
+*/
+
+#include "repetition.h"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+unsigned long long copies_to_fill(unsigned long long target_length, size_t unit_length)
+{
+    if (unit_length == 0)
+    {
+        return 1;
+    }
+    unsigned long long copies = (target_length + unit_length - 1) / unit_length;
+    return copies > 0 ? copies : 1;
+}
+
+unsigned long long normalize_copies(size_t max_length, size_t unit_length)
+{
+    unsigned long long copies = copies_to_fill(max_length, unit_length);
+    return copies > 1 ? copies - 1 : 1;
+}
+
+std::string repeat_to_count(std::string_view unit, unsigned long long count)
+{
+    const unsigned long long total = unit.size() * count;
+    std::string buffer;
+    if (total == 0)
+    {
+        return buffer;
+    }
+    buffer.reserve(total);
+    buffer = unit;
+
+    while (buffer.size() * 2 <= total && buffer.size() < PARALLEL_FILL_THRESHOLD)
+    {
+        buffer.append(buffer);
+    }
+
+    unsigned int thread_count = std::thread::hardware_concurrency();
+    if (total - buffer.size() < PARALLEL_FILL_THRESHOLD || thread_count < 2)
+    {
+        while (buffer.size() < total)
+        {
+            buffer.append(buffer, 0, std::min<unsigned long long>(buffer.size(), total - buffer.size()));
+        }
+        return buffer;
+    }
+
+    // The prefix is a whole number of units, so every block that starts at a multiple of it is an exact copy.
+    const unsigned long long block_size = buffer.size();
+    const unsigned long long block_count = (total + block_size - 1) / block_size;
+    buffer.resize(total);
+    char *data = &buffer[0];
+
+    std::vector<std::thread> fillers;
+    for (unsigned int t = 0; t < thread_count; t++)
+    {
+        fillers.emplace_back([=]()
+        {
+            for (unsigned long long block = 1 + t; block < block_count; block += thread_count)
+            {
+                unsigned long long offset = block * block_size;
+                std::memcpy(data + offset, data, std::min(block_size, total - offset));
+            }
+        });
+    }
+    for (auto &filler : fillers)
+    {
+        filler.join();
+    }
+    return buffer;
+}
@@ -0,0 +1,26 @@
+/*
+    Intention Core: building the repeated intention buffers.
+    Licensed under GNU General Public License v3.0
+*/
+
+#ifndef INTENTION_CORE_REPETITION_H
+#define INTENTION_CORE_REPETITION_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+constexpr unsigned long long PARALLEL_FILL_THRESHOLD = 64ULL * 1024 * 1024;
+
+// Number of copies of a unit_length string needed to reach target_length (at least one).
+unsigned long long copies_to_fill(unsigned long long target_length, size_t unit_length);
+
+// Number of copies the normalize step settles on: it stops before the next copy would reach max_length.
+unsigned long long normalize_copies(size_t max_length, size_t unit_length);
+
+// Builds count back-to-back copies of unit in one allocation. The filled prefix is doubled
+// with memcpy until it reaches PARALLEL_FILL_THRESHOLD, then the rest is copied from that
+// prefix by all cores at once.
+std::string repeat_to_count(std::string_view unit, unsigned long long count);
+
+#endif
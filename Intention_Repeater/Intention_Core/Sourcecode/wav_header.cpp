@@ -0,0 +1,252 @@
+/*
+    Intention Core: RIFF/RF64 and ID3 header writers for the WAV tools.
+    Licensed under GNU General Public License v3.0
+*/
+
+#include "wav_header.h"
+
+#include <bit>
+#include <cstring>
+
+constexpr uint32_t headerChunkSize = 0;               // Placeholder for a chunk size that is filled in later
+constexpr uint32_t rf64SizePlaceholder = 0xFFFFFFFF;  // 32-bit size field value that means "look in ds64"
+constexpr uint32_t ds64ChunkSize = 28;                // RIFF size + data size + sample count (8 bytes each) + table length
+constexpr std::streamoff ds64RiffSizePos = 20;        // "RF64" size "WAVE" "ds64" size
+constexpr std::streamoff ds64DataSizePos = ds64RiffSizePos + 8;
+constexpr std::streamoff ds64SampleCountPos = ds64DataSizePos + 8;
+
+constexpr uint8_t majorVersion = 0x04; // ID3v2.4 version number
+constexpr uint8_t minorVersion = 0x00; // Revision number
+constexpr uint8_t paddingByte = 0x00;
+
+void writeRiffHeader(std::ofstream &wavFile, bool rf64)
+{
+    wavFile.seekp(0, std::ios::beg);
+    if (rf64)
+    {
+        const uint64_t sizePlaceholder = 0;
+        const uint32_t tableLength = 0;
+        wavFile.write("RF64", 4);
+        wavFile.write(reinterpret_cast<const char *>(&rf64SizePlaceholder), sizeof(rf64SizePlaceholder));
+        wavFile.write("WAVEds64", 8); // ds64 must be the first chunk after "WAVE"
+        wavFile.write(reinterpret_cast<const char *>(&ds64ChunkSize), sizeof(ds64ChunkSize));
+        wavFile.write(reinterpret_cast<const char *>(&sizePlaceholder), sizeof(sizePlaceholder)); // 64-bit RIFF size
+        wavFile.write(reinterpret_cast<const char *>(&sizePlaceholder), sizeof(sizePlaceholder)); // 64-bit data size
+        wavFile.write(reinterpret_cast<const char *>(&sizePlaceholder), sizeof(sizePlaceholder)); // 64-bit sample count
+        wavFile.write(reinterpret_cast<const char *>(&tableLength), sizeof(tableLength));         // no extra chunk size table
+        return;
+    }
+    wavFile.write("RIFF", 4);
+    wavFile.write(reinterpret_cast<const char *>(&headerChunkSize), sizeof(headerChunkSize));
+    wavFile.write("WAVE", 4);
+}
+
+void writeRiffHeaderSizeElement(std::ofstream &wavFile, bool rf64)
+{
+    const uint64_t fileSizeMinus8 = static_cast<uint64_t>(wavFile.tellp()) - 8;
+    if (rf64)
+    {
+        wavFile.seekp(ds64RiffSizePos, std::ios::beg);
+        wavFile.write(reinterpret_cast<const char *>(&fileSizeMinus8), sizeof(fileSizeMinus8));
+    }
+    else
+    {
+        const uint32_t riffSize = static_cast<uint32_t>(fileSizeMinus8);
+        wavFile.seekp(4, std::ios::beg);
+        wavFile.write(reinterpret_cast<const char *>(&riffSize), sizeof(riffSize));
+    }
+    wavFile.seekp(0, std::ios::end);
+}
+
+void writeFormatHeader(std::ofstream &wavFile, const uint32_t formatSize, const uint16_t audioFormat, const uint16_t numChannels, const uint32_t sampleRate, const uint32_t byteRate,
+                       const uint16_t blockAlign, const uint16_t bitsPerSample)
+{
+    wavFile.write("fmt ", 4);
+    wavFile.write(reinterpret_cast<const char *>(&formatSize), sizeof(formatSize));
+    wavFile.write(reinterpret_cast<const char *>(&audioFormat), sizeof(audioFormat));
+    wavFile.write(reinterpret_cast<const char *>(&numChannels), sizeof(numChannels));
+    wavFile.write(reinterpret_cast<const char *>(&sampleRate), sizeof(sampleRate));
+    wavFile.write(reinterpret_cast<const char *>(&byteRate), sizeof(byteRate));
+    wavFile.write(reinterpret_cast<const char *>(&blockAlign), sizeof(blockAlign));
+    wavFile.write(reinterpret_cast<const char *>(&bitsPerSample), sizeof(bitsPerSample));
+}
+
+std::streamoff writeDataChunkHeader(std::ofstream &wavFile)
+{
+    wavFile.write("data", 4);
+    const std::streamoff dataChunkSizePos = wavFile.tellp();
+    wavFile.write(reinterpret_cast<const char *>(&headerChunkSize), sizeof(headerChunkSize));
+    return dataChunkSizePos;
+}
+
+void writeDataChunkSizeElement(std::ofstream &wavFile, const std::streamoff dataChunkSizePos, const uint64_t dataSize, const uint64_t sampleCount, bool rf64)
+{
+    if (rf64)
+    {
+        wavFile.seekp(dataChunkSizePos, std::ios::beg);
+        wavFile.write(reinterpret_cast<const char *>(&rf64SizePlaceholder), sizeof(rf64SizePlaceholder));
+        wavFile.seekp(ds64DataSizePos, std::ios::beg);
+        wavFile.write(reinterpret_cast<const char *>(&dataSize), sizeof(dataSize));
+        wavFile.seekp(ds64SampleCountPos, std::ios::beg);
+        wavFile.write(reinterpret_cast<const char *>(&sampleCount), sizeof(sampleCount));
+    }
+    else
+    {
+        const uint32_t chunkSize = static_cast<uint32_t>(dataSize);
+        wavFile.seekp(dataChunkSizePos, std::ios::beg);
+        wavFile.write(reinterpret_cast<const char *>(&chunkSize), sizeof(chunkSize));
+    }
+    wavFile.seekp(0, std::ios::end);
+}
+
+void ensureDataAlignment(std::ofstream &wavFile)
+{
+    if (wavFile.tellp() % 2 != 0)
+    {
+        wavFile.write(reinterpret_cast<const char *>(&paddingByte), sizeof(paddingByte));
+    }
+}
+
+uint32_t writeListHeader(std::ofstream &wavFile)
+{
+    wavFile.write("LIST", 4);
+    const uint32_t listHeaderChunkSizePos = wavFile.tellp();
+    wavFile.write(reinterpret_cast<const char *>(&headerChunkSize), sizeof(headerChunkSize));
+    return listHeaderChunkSizePos;
+}
+
+void writeListHeaderSizeChunkElement(std::ofstream &wavFile, const uint32_t position, const uint32_t value)
+{
+    wavFile.seekp(position, std::ios::beg);
+    wavFile.write(reinterpret_cast<const char *>(&value), 4);
+    wavFile.seekp(0, std::ios::end);
+}
+
+void writeListSubChunk(std::ofstream &wavFile, const char *ID, const char *data, const uint32_t dataSize, const uint32_t isNullTerminated)
+{
+    wavFile.write(ID, strlen(ID));
+    uint32_t alignedDataSize = (dataSize + WAV_CHUNK_ALIGNMENT - isNullTerminated) & ~(WAV_CHUNK_ALIGNMENT - isNullTerminated);
+    wavFile.write(reinterpret_cast<const char *>(&alignedDataSize), sizeof(alignedDataSize));
+    wavFile.write(data, dataSize);
+    if (alignedDataSize == dataSize)
+    {
+        alignedDataSize += WAV_CHUNK_ALIGNMENT; // keep the padding even when the data already ends on the boundary
+    }
+    for (uint32_t i = dataSize; i < alignedDataSize; ++i)
+    {
+        wavFile.write(reinterpret_cast<const char *>(&paddingByte), sizeof(paddingByte));
+    }
+}
+
+void writeListSubChunk(std::ofstream &wavFile, const char *ID, const std::string &data)
+{
+    wavFile.write(ID, strlen(ID));
+    const uint32_t dataSize = data.length() + 1;
+    uint32_t alignedDataSize = (dataSize + WAV_CHUNK_ALIGNMENT) & ~(WAV_CHUNK_ALIGNMENT);
+    wavFile.write(reinterpret_cast<const char *>(&alignedDataSize), sizeof(alignedDataSize));
+    wavFile.write(data.c_str(), data.length());
+    if (alignedDataSize == dataSize)
+    {
+        alignedDataSize += WAV_CHUNK_ALIGNMENT;
+    }
+    for (uint32_t i = dataSize; i < alignedDataSize; ++i)
+    {
+        wavFile.write(reinterpret_cast<const char *>(&paddingByte), sizeof(paddingByte));
+    }
+}
+
+void writeLittleEndian(std::ofstream &file, uint32_t value)
+{
+    file.put(value & 0xFF);
+    file.put((value >> 8) & 0xFF);
+    file.put((value >> 16) & 0xFF);
+    file.put((value >> 24) & 0xFF);
+}
+
+void writeBigEndian(std::ofstream &file, uint32_t value)
+{
+    file.put((value >> 24) & 0xFF);
+    file.put((value >> 16) & 0xFF);
+    file.put((value >> 8) & 0xFF);
+    file.put(value & 0xFF);
+}
+
+uint32_t checkForAndWritePadding(std::ofstream &wavFile)
+{
+    const uint32_t paddingSize = (WAV_CHUNK_ALIGNMENT - (wavFile.tellp() % WAV_CHUNK_ALIGNMENT)) % WAV_CHUNK_ALIGNMENT;
+    for (uint32_t i = 0; i < paddingSize; ++i)
+    {
+        wavFile.write(reinterpret_cast<const char *>(&paddingByte), sizeof(paddingByte));
+    }
+    return paddingSize;
+}
+
+void writePadding(std::ofstream &wavFile)
+{
+    uint32_t paddingSize = (WAV_CHUNK_ALIGNMENT - (wavFile.tellp() % WAV_CHUNK_ALIGNMENT)) % WAV_CHUNK_ALIGNMENT;
+    if (paddingSize == 0)
+    {
+        paddingSize = WAV_CHUNK_ALIGNMENT;
+    }
+    for (uint32_t i = 0; i < paddingSize; ++i)
+    {
+        wavFile.write(reinterpret_cast<const char *>(&paddingByte), sizeof(paddingByte));
+    }
+}
+
+uint32_t createID3Header(std::ofstream &wavFile, const uint32_t tagSize, const uint8_t flags)
+{
+    wavFile.write("ID3", 3);
+    wavFile.write(reinterpret_cast<const char *>(&majorVersion), 1);
+    wavFile.write(reinterpret_cast<const char *>(&minorVersion), 1);
+    wavFile.write(reinterpret_cast<const char *>(&flags), 1);
+    const uint32_t ID3HeaderSizeElementLocation = wavFile.tellp();
+    if constexpr (std::endian::native == std::endian::little)
+    {
+        writeLittleEndian(wavFile, tagSize);
+    }
+    else if constexpr (std::endian::native == std::endian::big)
+    {
+        writeBigEndian(wavFile, tagSize);
+    }
+    else
+    {
+        wavFile.write(reinterpret_cast<const char *>(&tagSize), 4);
+    }
+    return ID3HeaderSizeElementLocation;
+}
+
+void createID3Footer(std::ofstream &wavFile, const uint32_t tagSize, const uint8_t flags)
+{
+    wavFile.write("3DI", 3); // the footer ID is the header ID backwards
+    wavFile.write(reinterpret_cast<const char *>(&majorVersion), 1);
+    wavFile.write(reinterpret_cast<const char *>(&minorVersion), 1);
+    wavFile.write(reinterpret_cast<const char *>(&flags), 1);
+    wavFile.write(reinterpret_cast<const char *>(&tagSize), 4);
+}
+
+uint32_t createID3FrameHeader(std::ofstream &wavFile, const char *frameID, const uint32_t frameSize, const uint16_t flags)
+{
+    wavFile.write(frameID, 4); // four characters from A-Z and 0-9
+    const uint32_t frameSizePosition = wavFile.tellp();
+    wavFile.write(reinterpret_cast<const char *>(&frameSize), 4);
+    wavFile.write(reinterpret_cast<const char *>(&flags), 2);
+    return frameSizePosition;
+}
+
+void setID3HeaderSize(std::ofstream &wavFile, const uint32_t frameSizeElementLocation, const uint32_t frameChunkSize)
+{
+    const uint32_t currentPos = wavFile.tellp();
+    wavFile.seekp(frameSizeElementLocation, std::ios::beg);
+    wavFile.write(reinterpret_cast<const char *>(&frameChunkSize), 4);
+    wavFile.seekp(currentPos, std::ios::beg);
+    createID3Footer(wavFile, frameChunkSize);
+}
+
+void insertID3Frame(std::ofstream &wavFile, const std::string &key, const std::string &value)
+{
+    const uint32_t frameSize = key.size() + value.size() + 1; // key, null terminator, value
+    createID3FrameHeader(wavFile, key.c_str(), frameSize);
+    wavFile.write("\0", 1);
+    wavFile.write(value.c_str(), value.size());
+}
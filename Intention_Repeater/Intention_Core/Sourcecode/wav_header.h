@@ -0,0 +1,63 @@
+/*
+    Intention Core: RIFF/RF64 and ID3 header writers for the WAV tools.
+    Licensed under GNU General Public License v3.0
+*/
+
+#ifndef INTENTION_CORE_WAV_HEADER_H
+#define INTENTION_CORE_WAV_HEADER_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+// Boundary the LIST and ID3 writers pad their chunks to.
+#ifdef _WIN64
+constexpr uint32_t WAV_CHUNK_ALIGNMENT = 8;
+#else
+constexpr uint32_t WAV_CHUNK_ALIGNMENT = 4;
+#endif
+
+// Largest data chunk written as plain RIFF, leaving room for the headers. Anything bigger
+// needs RF64 (EBU Tech 3306): the 32-bit RIFF and data sizes are set to 0xFFFFFFFF and the
+// real 64-bit sizes go in a ds64 chunk right after "WAVE", ahead of the format chunk.
+constexpr uint64_t RIFF_SIZE_LIMIT = UINT32_MAX - 64 * 1024;
+
+// Writes "RIFF" <size> "WAVE" at the start of the file, or the RF64 header and an empty ds64
+// chunk when rf64 is set. The sizes are placeholders until writeRiffHeaderSizeElement.
+void writeRiffHeader(std::ofstream &wavFile, bool rf64 = false);
+
+// Fills in the RIFF (or ds64) size from the current end of the file, then seeks back there.
+void writeRiffHeaderSizeElement(std::ofstream &wavFile, bool rf64 = false);
+
+void writeFormatHeader(std::ofstream &wavFile, uint32_t formatSize, uint16_t audioFormat, uint16_t numChannels, uint32_t sampleRate, uint32_t byteRate,
+                       uint16_t blockAlign, uint16_t bitsPerSample);
+
+// Starts the data chunk and returns the position of its size field for writeDataChunkSizeElement.
+std::streamoff writeDataChunkHeader(std::ofstream &wavFile);
+
+// Fills in the data chunk size at dataChunkSizePos, or the ds64 data size and sample count when
+// rf64 is set, then seeks back to the end of the file.
+void writeDataChunkSizeElement(std::ofstream &wavFile, std::streamoff dataChunkSizePos, uint64_t dataSize, uint64_t sampleCount, bool rf64 = false);
+
+// Pads the file to an even length, as RIFF chunks require.
+void ensureDataAlignment(std::ofstream &wavFile);
+
+// LIST/INFO chunk: writeListHeader returns the position of the size field, which
+// writeListHeaderSizeChunkElement fills in once the sub-chunks are written.
+uint32_t writeListHeader(std::ofstream &wavFile);
+void writeListHeaderSizeChunkElement(std::ofstream &wavFile, uint32_t position, uint32_t value);
+void writeListSubChunk(std::ofstream &wavFile, const char *ID, const char *data, uint32_t dataSize, uint32_t isNullTerminated = 1);
+void writeListSubChunk(std::ofstream &wavFile, const char *ID, const std::string &data);
+
+// ID3v2.4 tag.
+void writeLittleEndian(std::ofstream &file, uint32_t value);
+void writeBigEndian(std::ofstream &file, uint32_t value);
+uint32_t checkForAndWritePadding(std::ofstream &wavFile);
+void writePadding(std::ofstream &wavFile);
+uint32_t createID3Header(std::ofstream &wavFile, uint32_t tagSize = 0, uint8_t flags = 0x00);
+void createID3Footer(std::ofstream &wavFile, uint32_t tagSize = 0, uint8_t flags = 0x00);
+uint32_t createID3FrameHeader(std::ofstream &wavFile, const char *frameID, uint32_t frameSize = 0, uint16_t flags = 0x00);
+void setID3HeaderSize(std::ofstream &wavFile, uint32_t frameSizeElementLocation, uint32_t frameChunkSize);
+void insertID3Frame(std::ofstream &wavFile, const std::string &key, const std::string &value);
+
+#endif
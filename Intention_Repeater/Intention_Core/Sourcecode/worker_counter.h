@@ -0,0 +1,38 @@
+/*
+    Intention Core: per-worker iteration counters.
+    Licensed under GNU General Public License v3.0
+*/
+
+#ifndef INTENTION_CORE_WORKER_COUNTER_H
+#define INTENTION_CORE_WORKER_COUNTER_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+// One counter per worker thread, each on its own cache line so no two workers
+// ever write to the same line. Counters only grow; the monitor reads the
+// difference since the last second, so nobody resets them under the workers.
+struct alignas(CACHE_LINE_SIZE) WorkerCounter
+{
+    std::atomic<unsigned long long> iterations{0};
+};
+
+inline unsigned long long sum_counters(const WorkerCounter *worker_counters, size_t count)
+{
+    unsigned long long total = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        total += worker_counters[i].iterations.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+inline unsigned long long sum_counters(const std::vector<WorkerCounter> &worker_counters)
+{
+    return sum_counters(worker_counters.data(), worker_counters.size());
+}
+
+#endif
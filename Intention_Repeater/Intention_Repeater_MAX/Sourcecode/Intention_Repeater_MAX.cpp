@@ -4,7 +4,8 @@
     Holo-Link framework created by Mystic Minds. This implementation by Anthro Teacher.
     Boosting through Nested Files by Anthro Teacher.
     Updated 3/29/2024 by Anthro Teacher and Claude 3 Opus.
-    To compile: g++ -O3 -Wall -static Intention_Repeater_MAX.cpp -o Intention_Repeater_MAX.exe -lz
+    To compile: cmake -S ../.. -B build && cmake --build build --target Intention_Repeater_MAX
+    or: g++ -O3 -Wall -static -std=c++20 -pthread -I../../Intention_Core/Sourcecode Intention_Repeater_MAX.cpp ../../Intention_Core/Sourcecode/compression.cpp ../../Intention_Core/Sourcecode/display.cpp ../../Intention_Core/Sourcecode/mapped_file.cpp ../../Intention_Core/Sourcecode/repetition.cpp -o Intention_Repeater_MAX.exe -lz
     Repeats your intention up to 100 PHz to make things happen.
     For help: Intention_Repeater_MAX.exe --help
     Intention Repeater MAX is powered by a Servitor (20 Years / 2000+ hours in the making) [HR 6819 Black Hole System].
@@ -17,11 +18,14 @@
 */
 
 #include <algorithm>
+#include <array>
 #include <chrono>
+#include <climits>
 #include <cmath>
 #include <cstdint>
 #include <cstring>
 #include <ctime>
+#include <filesystem>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
@@ -29,27 +33,114 @@
 #include <locale.h>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <thread>
+#include <unordered_map>
 #include <atomic>
 
 #ifdef _WIN32
 #include <windows.h>
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
 #elif __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/prctl.h>
 #include <sys/sysinfo.h>
+#include <time.h>
 #elif __APPLE__
 #include <sys/sysctl.h>
 #endif
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__SSE2__) || defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64)
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <immintrin.h>
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
 #include "picosha2.h"
-#include "zlib.h"
+#include "compression.h"
+#include "display.h"
+#include "mapped_file.h"
+#include "iteration_counter.h"
+#include "repetition.h"
+#include "worker_counter.h"
 
 using namespace std::chrono;
 
-constexpr int ONE_MINUTE = 60;
-constexpr int ONE_HOUR = 3600;
 
 std::atomic<bool> interrupted(false);
+std::atomic<bool> resting(false);
+
+// Wake-up lateness of the --freq scheduler in nanoseconds, in log-linear bins: exact below 8 ns,
+// then eight bins per power of two, so a percentile read from it is within 12.5%. Only the
+// owning thread records into it; like WorkerCounter the bins only grow and readers diff two
+// snapshots. One per --threads worker, aligned like WorkerCounter so neighbours share no line.
+class alignas(CACHE_LINE_SIZE) LatenessHistogram
+{
+public:
+    static constexpr size_t SUB_BINS = 8;
+    static constexpr size_t BIN_COUNT = 62 * SUB_BINS;
+    using Snapshot = std::array<uint32_t, BIN_COUNT>;
+
+    void record(int64_t nanoseconds)
+    {
+        std::atomic<uint32_t> &bin = bins[bin_of(nanoseconds > 0 ? static_cast<uint64_t>(nanoseconds) : 0)];
+        bin.store(bin.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    void accumulate(Snapshot &counts) const
+    {
+        for (size_t i = 0; i < BIN_COUNT; i++)
+        {
+            counts[i] += bins[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    static uint64_t lower_edge(size_t bin)
+    {
+        if (bin < SUB_BINS)
+        {
+            return bin;
+        }
+        return static_cast<uint64_t>(SUB_BINS + bin % SUB_BINS) << (bin / SUB_BINS - 1);
+    }
+
+private:
+    static size_t bin_of(uint64_t value)
+    {
+        if (value < SUB_BINS)
+        {
+            return static_cast<size_t>(value);
+        }
+        int top_bit = 3;
+        while (value >> (top_bit + 1))
+        {
+            top_bit++;
+        }
+        return (top_bit - 2) * SUB_BINS + ((value >> (top_bit - 3)) & (SUB_BINS - 1));
+    }
+
+    std::array<std::atomic<uint32_t>, BIN_COUNT> bins{};
+};
 
 #ifdef _WIN32
 HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
@@ -111,6 +202,14 @@ const char *enum2str[] = {"BLACK", "BLUE", "GREEN", "CYAN", "RED", "MAGENTA", "Y
 #endif
 
 const std::string HSUPLINK_FILE = "HSUPLINK.TXT";
+const std::string INTENTIONS_FILE = "INTENTIONS.TXT";
+const std::string HOLOSTONE_FILE = "HOLOSTONE.TXT";
+const std::string THOUGHTFORM_A_FILE = "THOUGHTFORM_A.TXT";
+const std::string THOUGHTFORM_B_FILE = "THOUGHTFORM_B.TXT";
+const std::string AMPLIFIER_FILE = "AMPLIFIER.TXT";
+
+// Files whose names are expanded in place when they appear in HSUPLINK.TXT.
+const std::vector<std::string> HOLOLINK_PLACEHOLDER_FILES = {INTENTIONS_FILE, HOLOSTONE_FILE, AMPLIFIER_FILE, THOUGHTFORM_A_FILE, THOUGHTFORM_B_FILE};
 
 class comma_numpunct : public std::numpunct<char>
 {
@@ -168,160 +267,210 @@ unsigned long long int get_ninety_percent_free_memory()
     return free_memory;
 }
 
-std::string getHSUPLINKContents(const std::string& boostedContent = "")
+// Copies source into destination without its NUL bytes, in one allocation. Whole vectors with
+// no NUL in them (nearly all of a text file) are stored as they are; only vectors that hold
+// a NUL are compacted a byte at a time.
+void strip_nul_bytes(std::string_view source, std::string &destination)
 {
-    std::string hsuplink;
-    std::string HSUPLINK_FILE = "HSUPLINK.TXT";
-    std::ifstream hsuplinkFile(HSUPLINK_FILE);
-
-    if (hsuplinkFile.is_open())
-    {
-        std::ostringstream hsuplinkStream;
-        hsuplinkStream << hsuplinkFile.rdbuf();
-        hsuplink = hsuplinkStream.str();
-        hsuplinkFile.close();
-    }
-    else
+    destination.resize(source.size());
+    char *output = &destination[0];
+    const char *input = source.data();
+    const size_t size = source.size();
+    size_t i = 0;
+    size_t kept = 0;
+
+#if defined(__AVX2__)
+    constexpr size_t VECTOR_SIZE = 32;
+    const __m256i zero = _mm256_setzero_si256();
+    for (; i + VECTOR_SIZE <= size; i += VECTOR_SIZE)
     {
-        return HSUPLINK_FILE;
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(input + i));
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, zero)) == 0)
+        {
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(output + kept), block);
+            kept += VECTOR_SIZE;
+            continue;
+        }
+        for (size_t j = i; j < i + VECTOR_SIZE; ++j)
+        {
+            output[kept] = input[j];
+            kept += (input[j] != '\0');
+        }
     }
-    // std::cout << "HSUPLINK.TXT contents: " << hsuplink << std::endl;
-
-    std::string intentions;
-    
-    // If boosted content is provided, use it; otherwise use INTENTIONS.TXT
-    if (!boostedContent.empty())
+#elif defined(__SSE2__)
+    constexpr size_t VECTOR_SIZE = 16;
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + VECTOR_SIZE <= size; i += VECTOR_SIZE)
     {
-        intentions = boostedContent;
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(block, zero)) == 0)
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(output + kept), block);
+            kept += VECTOR_SIZE;
+            continue;
+        }
+        for (size_t j = i; j < i + VECTOR_SIZE; ++j)
+        {
+            output[kept] = input[j];
+            kept += (input[j] != '\0');
+        }
     }
-    else
+#elif defined(__aarch64__)
+    constexpr size_t VECTOR_SIZE = 16;
+    for (; i + VECTOR_SIZE <= size; i += VECTOR_SIZE)
     {
-        std::ifstream intentionsFile("INTENTIONS.TXT");
-        if (intentionsFile.is_open())
+        uint8x16_t block = vld1q_u8(reinterpret_cast<const uint8_t *>(input + i));
+        if (vminvq_u8(block) != 0)
+        {
+            vst1q_u8(reinterpret_cast<uint8_t *>(output + kept), block);
+            kept += VECTOR_SIZE;
+            continue;
+        }
+        for (size_t j = i; j < i + VECTOR_SIZE; ++j)
         {
-            std::ostringstream intentionsStream;
-            intentionsStream << intentionsFile.rdbuf();
-            intentions = intentionsStream.str();
-            intentionsFile.close();
+            output[kept] = input[j];
+            kept += (input[j] != '\0');
         }
     }
+#endif
 
-    if (!intentions.empty())
+    for (; i < size; ++i)
     {
-        size_t pos = 0;
-        while ((pos = hsuplink.find("INTENTIONS.TXT", pos)) != std::string::npos)
-        {
-            hsuplink.replace(pos, 14, intentions);
-            pos += intentions.length();
-        }
+        output[kept] = input[i];
+        kept += (input[i] != '\0');
     }
-    // std::cout << "HSUPLINK.TXT contents: " << hsuplink << std::endl;
-    return hsuplink;
+    destination.resize(kept);
 }
 
-std::string compressMessage(const std::string &message)
+// Whole file into contents: mapped and copied once when possible, streamed for anything that
+// can't be mapped (empty files, pipes). False if the file can't be opened.
+bool read_file_to_string(const std::string &filename, std::string &contents)
 {
-    z_stream zs;
-    std::memset(&zs, 0, sizeof(zs));
-
-    if (deflateInit(&zs, Z_DEFAULT_COMPRESSION) != Z_OK)
+    MappedFile mapped;
+    if (mapped.map(filename))
     {
-        return ""; // Compression initialization failed
+        contents.assign(mapped.view());
+        return true;
     }
+    std::ifstream file(filename, std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+    contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
 
-    zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(message.data()));
-    zs.avail_in = message.size();
-
-    std::string compressed;
-    char outbuffer[32768]; // Output buffer
-    int ret;
-    do
+// Whole file into contents in text mode, the way the Holo-Link and nesting files have always been
+// read, so CRLF line endings arrive as '\n' on Windows. False if the file can't be opened.
+bool read_text_file(const std::string &filename, std::string &contents)
+{
+    std::ifstream file(filename);
+    if (!file)
     {
-        zs.next_out = reinterpret_cast<Bytef *>(outbuffer);
-        zs.avail_out = sizeof(outbuffer);
+        return false;
+    }
+    contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
 
-        ret = deflate(&zs, Z_FINISH);
+// One named placeholder in a Holo-Link template and the text it expands to.
+struct TemplatePlaceholder
+{
+    std::string_view name;
+    std::string_view contents;
+};
 
-        if (compressed.size() < zs.total_out)
+// Expands every placeholder in layout in one scan. All placeholder names end in ".TXT", so the
+// scan only stops at those four bytes and checks which name, if any, ends there; no name holds
+// ".TXT" anywhere else, so matches can't overlap. The match positions are kept so expanded is
+// sized exactly and every byte of it is written once; its storage is reused when it already
+// has room, so the caller can hand in a buffer it has allocated up front.
+void expand_template(std::string_view layout, const std::vector<TemplatePlaceholder> &placeholders, std::string &expanded)
+{
+    struct Match
+    {
+        size_t start;
+        const TemplatePlaceholder *placeholder;
+    };
+    const std::string_view ANCHOR = ".TXT";
+
+    std::vector<Match> matches;
+    size_t expanded_size = layout.size();
+    for (size_t position = layout.find(ANCHOR); position != std::string_view::npos; position = layout.find(ANCHOR, position + ANCHOR.size()))
+    {
+        const size_t end = position + ANCHOR.size();
+        for (const TemplatePlaceholder &placeholder : placeholders)
         {
-            compressed.append(outbuffer, zs.total_out - compressed.size());
+            if (placeholder.name.size() <= end && layout.substr(end - placeholder.name.size(), placeholder.name.size()) == placeholder.name)
+            {
+                matches.push_back({end - placeholder.name.size(), &placeholder});
+                expanded_size += placeholder.contents.size() - placeholder.name.size();
+                break;
+            }
         }
-    } while (ret == Z_OK);
-
-    deflateEnd(&zs);
+    }
 
-    if (ret != Z_STREAM_END)
+    expanded.clear();
+    expanded.reserve(expanded_size);
+    size_t copied = 0;
+    for (const Match &match : matches)
     {
-        return ""; // Compression failed
+        expanded.append(layout.substr(copied, match.start - copied));
+        expanded.append(match.placeholder->contents);
+        copied = match.start + match.placeholder->name.size();
     }
-
-    return compressed;
+    expanded.append(layout.substr(copied));
 }
 
-void readFileContents(const std::string &filename, std::string &intention_file_contents)
+// HSUPLINK.TXT with each of HOLOLINK_PLACEHOLDER_FILES replaced by that file's contents. INTENTIONS.TXT
+// is replaced by boostedContent instead when it is given. A file that is missing or empty leaves
+// its name in place. Without HSUPLINK.TXT, contents is just its name.
+void getHSUPLINKContents(std::string &contents, std::string_view boostedContent = {})
 {
-    std::ifstream file(filename, std::ios::binary);
-    if (!file)
+    std::string hsuplink;
+    if (!read_text_file(HSUPLINK_FILE, hsuplink))
     {
-        std::cerr << "File not found" << std::endl;
-        std::exit(EXIT_FAILURE); // Terminate the program
+        contents = HSUPLINK_FILE;
+        return;
     }
 
-    std::ostringstream buffer;
-    char ch;
-    while (file.get(ch))
+    std::vector<std::string> files(HOLOLINK_PLACEHOLDER_FILES.size());
+    std::vector<TemplatePlaceholder> placeholders;
+    for (size_t i = 0; i < HOLOLINK_PLACEHOLDER_FILES.size(); i++)
     {
-        if (ch != '\0')
+        TemplatePlaceholder placeholder{HOLOLINK_PLACEHOLDER_FILES[i], boostedContent};
+        if (placeholder.name != INTENTIONS_FILE || boostedContent.empty())
+        {
+            read_text_file(HOLOLINK_PLACEHOLDER_FILES[i], files[i]);
+            placeholder.contents = files[i];
+        }
+        if (!placeholder.contents.empty())
         {
-            buffer.put(ch);
+            placeholders.push_back(placeholder);
         }
     }
 
-    intention_file_contents = buffer.str();
-    file.close();
+    expand_template(hsuplink, placeholders, contents);
 }
 
-std::string display_suffix(std::string num, int power, std::string designator)
+// The file with its NUL bytes dropped, copied once from the mapping into a buffer sized up front.
+void readFileContents(const std::string &filename, std::string &intention_file_contents)
 {
-    if (power < 3)
+    MappedFile mapped;
+    if (mapped.map(filename))
     {
-        return num;
+        strip_nul_bytes(mapped.view(), intention_file_contents);
+        return;
     }
 
-    std::string s;
-
-    if (designator == "Iterations")
-    {
-        constexpr char iterations_suffix_array[] = {' ', 'k', 'M', 'B', 'T', 'q', 'Q', 's', 'S', 'O', 'N', 'D'};
-        s = iterations_suffix_array[power / 3];
-    }
-    else // designator == "Frequency"
+    std::string contents;
+    if (!read_file_to_string(filename, contents))
     {
-        constexpr char frequency_suffix_array[] = {' ', 'k', 'M', 'G', 'T', 'P', 'E', 'Z', 'Y', 'R'};
-        s = frequency_suffix_array[power / 3];
+        std::cerr << "File not found" << std::endl;
+        std::exit(EXIT_FAILURE); // Terminate the program
     }
-
-    std::string str2 = num.substr(0, power % 3 + 1) + "." + num.substr(power % 3 + 1, 3) + s;
-
-    return str2;
-}
-
-std::string FormatTimeRun(int seconds_elapsed)
-{
-    int hour, min, sec;
-    std::string hour_formatted, min_formatted, sec_formatted;
-
-    hour = seconds_elapsed / ONE_HOUR;
-    seconds_elapsed -= hour * ONE_HOUR;
-    min = seconds_elapsed / ONE_MINUTE;
-    seconds_elapsed -= min * ONE_MINUTE;
-    sec = seconds_elapsed;
-
-    hour_formatted = (hour < 10) ? "0" + std::to_string(hour) : std::to_string(hour);
-    min_formatted = (min < 10) ? "0" + std::to_string(min) : std::to_string(min);
-    sec_formatted = (sec < 10) ? "0" + std::to_string(sec) : std::to_string(sec);
-
-    return hour_formatted + ":" + min_formatted + ":" + sec_formatted;
+    strip_nul_bytes(contents, intention_file_contents);
 }
 
 void print_color_help()
@@ -422,7 +571,12 @@ Optional Flags:
  q) --hashing or -g
  r) --file
  s) --file2
- t) --help or -h or /?
+ t) --threads or -j, example: --threads auto
+ u) --kernel or -k, example: --kernel nt
+ v) --benchmark
+ w) --codec or -z, example: --codec zstd
+ x) --level or -l, example: --level 9
+ y) --help or -h or /?
 
 --dur = Duration in HH:MM:SS format. Default = Run until stopped manually.
 --imem = Specify how many GB of System RAM to use. Higher amount repeats faster, but takes longer to load. Default = 1.0.
@@ -444,6 +598,12 @@ Optional Flags:
 --hashing = Use hashing. Default n.
 --file = Specify file to use if applicable.
 --file2 = Specify file to use if applicable.
+--threads = Number of repetition threads, or AUTO for one per logical CPU. Each thread is pinned to its own logical CPU. Default = 1.
+--kernel = Repetition kernel: COPY, STREAM (through an L2-sized buffer) or NT (non-temporal SIMD stores). Also shows GB/s. Default = COPY.
+--benchmark = Benchmark every kernel, thread count (up to --threads, default AUTO) and buffer size, plus hashing and compression.
+              Prints a table and writes BENCHMARK.CSV and BENCHMARK.JSON.
+--codec = Compression codec for --compress: ZLIB, ZSTD or LZ4 (ZSTD and LZ4 only when built with -DUSE_ZSTD/-DUSE_LZ4). Default = ZLIB.
+--level = Compression level for --codec (zlib 0-9, zstd 1-22). LZ4 ignores it. Default = the codec's default.
 --help = Display this help.
 
 Example usage:
@@ -455,6 +615,7 @@ Example usage with Holo-Link:
 
 Make sure to create your INTENTIONS.TXT file, in this folder, with your intentions, before running #2 above.  
 The --intent option is ignored when using --usehololink, which instead uses the INTENTIONS.TXT file.
+HOLOSTONE.TXT, AMPLIFIER.TXT, THOUGHTFORM_A.TXT and THOUGHTFORM_B.TXT in HSUPLINK.TXT are replaced by the contents of those files when they are not empty.
 
 Example usage with Nesting Files:
 1) Intention_Repeater_MAX.exe --createnestingfiles
@@ -476,95 +637,124 @@ Website: https://www.intentionrepeater.com
 #endif
 }
 
-std::string getBoostIntention(std::string param_boostlevel)
-{
-    // Convert param_boostlevel to an integer
-    int boostLevel = std::stoi(param_boostlevel);
-    std::ostringstream NESTING_FILE_CONTENTS;
-
-    // Check if boostLevel is within the valid range (1 to 100)
-    if (boostLevel < 1 || boostLevel > 100)
-    {
-        return "0";
-    }
+// --boostlevel N repeats the chain NEST-1.TXT, INTENTIONS.TXT, NEST-2.TXT, INTENTIONS.TXT, ...
+// NEST-N.TXT, INTENTIONS.TXT. Each file in it is read once and the chain is laid out into one
+// buffer of its exact final size. The result is cached in NESTING_CACHE_FILE behind a key made of
+// the level and every file's size and modification time, so a later launch on unchanged files
+// maps that one file and repeats straight from it.
+const char *const NESTING_CACHE_FILE = "NEST-CACHE.DAT";
 
-    // Loop from 1 to param_boostlevel
-    for (int i = 1; i <= boostLevel; i++)
+class NestingChain
+{
+public:
+    // False if the level is outside 1 to 100 or any file in the chain can't be read.
+    bool load(int level)
     {
-        std::string fileName = "NEST-" + std::to_string(i) + ".TXT";
-        std::ifstream file1(fileName);
-
-
-        if (!file1.is_open()) {
-            return "0";
+        if (level < 1 || level > 100)
+        {
+            return false;
         }
 
-        NESTING_FILE_CONTENTS << file1.rdbuf();
-        file1.close();
+        std::vector<std::string> names;
+        for (int i = 1; i <= level; i++)
+        {
+            names.push_back("NEST-" + std::to_string(i) + ".TXT");
+        }
+        names.push_back(INTENTIONS_FILE);
 
-        std::ifstream file2("INTENTIONS.TXT");
-        if (!file2.is_open()) {
-            return "0";
+        std::string key;
+        if (!cache_key(level, names, key))
+        {
+            return false;
         }
 
-        NESTING_FILE_CONTENTS << file2.rdbuf();
-        file2.close();
-    }
+        if (cache.map(NESTING_CACHE_FILE) && cache.view().substr(0, key.size()) == key)
+        {
+            resolved = cache.view().substr(key.size());
+            return true;
+        }
+        cache.unmap();
 
-    return NESTING_FILE_CONTENTS.str();
-}
+        std::vector<std::string> pieces(names.size());
+        size_t total = 0;
+        for (size_t i = 0; i < names.size(); i++)
+        {
+            if (!read_text_file(names[i], pieces[i]))
+            {
+                return false;
+            }
+            total += pieces[i].size();
+        }
 
-std::string FindSum(std::string a, std::string b)
-{
-    std::vector<int> finalsum;
-    int carry = 0;
+        // INTENTIONS.TXT follows every NEST file, so it appears level times
+        const std::string &intentions = pieces.back();
+        total += intentions.size() * (level - 1);
+        expanded.reserve(total);
+        for (int i = 0; i < level; i++)
+        {
+            expanded += pieces[i];
+            expanded += intentions;
+        }
+        resolved = expanded;
 
-    int i = a.size() - 1;
-    int j = b.size() - 1;
-    while ((i >= 0) && (j >= 0))
-    {
-        int x = (a[i] - '0') + (b[j] - '0') + carry;
-        finalsum.push_back(x % 10);
-        carry = x / 10;
-        i--;
-        j--;
+        write_cache(key);
+        return true;
     }
 
-    while (i >= 0)
-    {
-        int x = (a[i] - '0') + carry;
-        finalsum.push_back(x % 10);
-        carry = x / 10;
-        i--;
-    }
+    // The whole expanded chain. It stays valid for as long as this object does.
+    std::string_view contents() const { return resolved; }
 
-    while (j >= 0)
+private:
+    static bool cache_key(int level, const std::vector<std::string> &names, std::string &key)
     {
-        int x = (b[j] - '0') + carry;
-        finalsum.push_back(x % 10);
-        carry = x / 10;
-        j--;
+        // Version 2: the files are read in text mode, so a version 1 cache may hold their CRLFs
+        key = "Intention Repeater MAX nesting cache 2\nlevel " + std::to_string(level) + "\n";
+        for (const std::string &name : names)
+        {
+            std::error_code error;
+            uintmax_t size = std::filesystem::file_size(name, error);
+            if (error)
+            {
+                return false;
+            }
+            auto modified = std::filesystem::last_write_time(name, error);
+            if (error)
+            {
+                return false;
+            }
+            key += name + " " + std::to_string(size) + " " + std::to_string(modified.time_since_epoch().count()) + "\n";
+        }
+        key += "\n";
+        return true;
     }
 
-    while (carry)
+    // Best effort: the chain is still usable if the cache can't be written.
+    void write_cache(const std::string &key) const
     {
-        finalsum.push_back(carry % 10);
-        carry = carry / 10;
+        const std::string temporary = std::string(NESTING_CACHE_FILE) + ".tmp";
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        file.write(key.data(), key.size());
+        file.write(expanded.data(), expanded.size());
+        file.close();
+
+        std::error_code error;
+        if (file)
+        {
+            std::filesystem::rename(temporary, NESTING_CACHE_FILE, error);
+        }
+        if (!file || error)
+        {
+            std::filesystem::remove(temporary, error);
+        }
     }
 
-    std::stringstream final_iter;
-    std::copy(finalsum.rbegin(), finalsum.rend(), std::ostream_iterator<int>(final_iter, ""));
-
-    return final_iter.str();
-}
+    MappedFile cache;
+    std::string expanded;
+    std::string_view resolved;
+};
 
 void create_hololink_files()
 {
-    const std::string HOLOSTONE_FILE = "HOLOSTONE.TXT";
-    const std::string THOUGHTFORM_A_FILE = "THOUGHTFORM_A.TXT";
-    const std::string THOUGHTFORM_B_FILE = "THOUGHTFORM_B.TXT";
-    const std::string AMPLIFIER_FILE = "AMPLIFIER.TXT";
-
     std::ostringstream HOLOLINK_CONTENTS;
     HOLOLINK_CONTENTS << "#Comments are designated with a # prefix, and such commands are to be ignored by the Holo-Link.\r\n"
                       << "#" << HSUPLINK_FILE << " CONFIG FILE v1.0\r\n"
@@ -678,83 +868,1085 @@ void create_hololink_files()
     std::cout << "Good Luck!" << std::endl;
 }
 
-std::string MultiplyStrings(const std::string &num1, const std::string &num2)
+// Repetition kernels for --kernel.
+// COPY:   clear and append the whole intention into process_intention (original behaviour).
+// STREAM: copy the intention through a scratch buffer that stays resident in L2.
+// NT:     copy into a full-size buffer with non-temporal stores that bypass the cache.
+enum class RepetitionKernel
+{
+    Copy,
+    Stream,
+    NonTemporal
+};
+
+constexpr size_t KERNEL_CHUNK_SIZE = 256 * 1024;
+
+RepetitionKernel get_repetition_kernel(std::string param_kernel)
 {
-    int len1 = num1.size();
-    int len2 = num2.size();
-    std::vector<int> result(len1 + len2, 0);
+    std::transform(param_kernel.begin(), param_kernel.end(), param_kernel.begin(), ::toupper);
 
-    for (int i = len1 - 1; i >= 0; --i)
+    if (param_kernel == "STREAM")
     {
-        for (int j = len2 - 1; j >= 0; --j)
-        {
-            int mul = (num1[i] - '0') * (num2[j] - '0');
-            int sum = mul + result[i + j + 1];
+        return RepetitionKernel::Stream;
+    }
+    else if (param_kernel == "NT")
+    {
+        return RepetitionKernel::NonTemporal;
+    }
+    return RepetitionKernel::Copy;
+}
 
-            result[i + j + 1] = sum % 10;
-            result[i + j] += sum / 10;
-        }
+void copy_non_temporal(char *destination, const char *source, size_t size)
+{
+#if defined(__AVX512F__)
+    constexpr size_t VECTOR_SIZE = 64;
+#elif defined(__AVX2__)
+    constexpr size_t VECTOR_SIZE = 32;
+#else
+    constexpr size_t VECTOR_SIZE = 16;
+#endif
+
+    // Streaming stores need an aligned destination, so copy the unaligned head normally.
+    size_t head = (VECTOR_SIZE - (reinterpret_cast<uintptr_t>(destination) & (VECTOR_SIZE - 1))) & (VECTOR_SIZE - 1);
+    if (head > size)
+    {
+        head = size;
+    }
+    std::memcpy(destination, source, head);
+
+    size_t i = head;
+#if defined(__AVX512F__)
+    for (; i + VECTOR_SIZE <= size; i += VECTOR_SIZE)
+    {
+        _mm512_stream_si512(reinterpret_cast<__m512i *>(destination + i), _mm512_loadu_si512(source + i));
+    }
+    _mm_sfence();
+#elif defined(__AVX2__)
+    for (; i + VECTOR_SIZE <= size; i += VECTOR_SIZE)
+    {
+        _mm256_stream_si256(reinterpret_cast<__m256i *>(destination + i),
+                            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(source + i)));
+    }
+    _mm_sfence();
+#elif defined(__SSE2__)
+    for (; i + VECTOR_SIZE <= size; i += VECTOR_SIZE)
+    {
+        _mm_stream_si128(reinterpret_cast<__m128i *>(destination + i),
+                         _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i)));
+    }
+    _mm_sfence();
+#elif defined(__aarch64__)
+    // NEON has no streaming store intrinsic, STNP is the non-temporal pair store.
+    for (; i + 2 * VECTOR_SIZE <= size; i += 2 * VECTOR_SIZE)
+    {
+        uint8x16_t low = vld1q_u8(reinterpret_cast<const uint8_t *>(source + i));
+        uint8x16_t high = vld1q_u8(reinterpret_cast<const uint8_t *>(source + i + VECTOR_SIZE));
+        asm volatile("stnp %q0, %q1, [%2]" : : "w"(low), "w"(high), "r"(destination + i) : "memory");
+    }
+#endif
+
+    std::memcpy(destination + i, source + i, size - i);
+}
+
+void prepare_repetition_buffer(RepetitionKernel kernel, std::string_view intention_value, std::string &process_intention)
+{
+    if (kernel == RepetitionKernel::Stream)
+    {
+        process_intention.reserve(KERNEL_CHUNK_SIZE);
     }
+    else if (kernel == RepetitionKernel::NonTemporal)
+    {
+        process_intention.resize(intention_value.size());
+    }
+    else
+    {
+        process_intention.reserve(intention_value.size() + 20);
+    }
+}
 
-    std::string resultStr;
-    for (int num : result)
+// One repetition of intention_value with the selected kernel.
+inline void repeat_intention(RepetitionKernel kernel, std::string_view intention_value, std::string &process_intention)
+{
+    if (kernel == RepetitionKernel::Stream)
     {
-        if (!(resultStr.empty() && num == 0))
+        for (size_t offset = 0; offset < intention_value.size(); offset += KERNEL_CHUNK_SIZE)
         {
-            resultStr.push_back(num + '0');
+            process_intention.assign(intention_value, offset, KERNEL_CHUNK_SIZE);
         }
     }
-
-    return resultStr.empty() ? "0" : resultStr;
+    else if (kernel == RepetitionKernel::NonTemporal)
+    {
+        copy_non_temporal(&process_intention[0], intention_value.data(), intention_value.size());
+    }
+    else
+    {
+        process_intention.clear();
+        process_intention.append(intention_value);
+    }
 }
 
-int main(int argc, char **argv)
+constexpr nanoseconds CLOCK_CHECK_INTERVAL = milliseconds(1);
+
+// Loops that time themselves read the clock once per batch of repetitions instead of once per
+// repetition. After each read the batch is doubled or halved from how long it took, so the
+// reads land roughly CLOCK_CHECK_INTERVAL apart whatever a repetition costs.
+unsigned long long retune_batch(unsigned long long batch, steady_clock::duration took)
 {
-    std::string intention, process_intention, intention_value, duration, param_duration;
-    std::string param_intention, param_intention_2, param_timer, param_boostlevel, param_freq, param_color;
-    std::string param_usehololink, param_amplification, runtime_formatted, ref_rate;
-    std::string suffix_value = "HZ", HSUPLINK_FILE, param_restevery, param_restfor;
-    std::string param_compress, param_hashing, useHashing, useCompression, intention_hashed, param_file2;
-    std::string totalIterations = "0", totalFreq = "0", param_file, intention_display = "", loading_message="LOADING INTO MEMORY...";
-    unsigned long long int multiplier = 0, amplification_int = 1000000000;
-    unsigned long long int cpu_benchmark_count = 0, hashMultiplier = 0, freq = 0;
-    int seconds = 0, frequency_int = 0, restevery_int = 0, restfor_int = 0;
-    int digits = 0, freqDigits = 0;
-    float ram_size_value = 1;
+    if (took < CLOCK_CHECK_INTERVAL / 2)
+    {
+        return batch * 2;
+    }
+    if (took > CLOCK_CHECK_INTERVAL * 2 && batch > 1)
+    {
+        return batch / 2;
+    }
+    return batch;
+}
 
-    param_duration = "UNTIL STOPPED";
-    param_timer = "EXACT";
-    param_freq = "0";
-    param_intention = "X";
-    param_color = "WHITE";
-    param_usehololink = "NO";
-    param_boostlevel = "0";
-    param_amplification = "1000000000";
-    param_restevery = "0";
-    param_restfor = "0";
-    param_hashing = "X";
-    param_compress = "X";
-    param_file = "X";
-    param_file2 = "X";
-    HSUPLINK_FILE = "HSUPLINK.TXT";
+// Repeats for about period and returns how many repetitions ran.
+unsigned long long repeat_for(steady_clock::duration period, RepetitionKernel kernel, std::string_view intention_value, std::string &process_intention)
+{
+    const steady_clock::time_point end = steady_clock::now() + period;
+    steady_clock::time_point now = steady_clock::now();
+    unsigned long long count = 0;
+    unsigned long long batch = 1;
 
-    for (int i = 1; i < argc; i++)
+    while (now < end)
     {
-        if (!strcmp(argv[i], "-h") || !strcmp(argv[i], "--help") || !strcmp(argv[i], "/?"))
+        const steady_clock::time_point batch_start = now;
+        for (unsigned long long i = 0; i < batch; i++)
         {
-            print_help();
-            std::exit(EXIT_SUCCESS);
+            repeat_intention(kernel, intention_value, process_intention);
         }
-        else if (!strcmp(argv[i], "-n") || !strcmp(argv[i], "--colorhelp"))
+        count += batch;
+
+        now = steady_clock::now();
+        batch = retune_batch(batch, now - batch_start);
+    }
+    return count;
+}
+
+std::string format_bandwidth(unsigned long long bytes_per_second)
+{
+    std::ostringstream bandwidth;
+    bandwidth.imbue(std::locale::classic());
+    bandwidth << " [" << std::setprecision(2) << std::fixed << (bytes_per_second / 1e9) << " GB/s]";
+    return bandwidth.str();
+}
+
+// " [jitter p50 ... p99 ...]" over the wake-ups recorded since the previous call, which left its
+// counts in previous. Empty when there were none.
+std::string format_lateness(const LatenessHistogram::Snapshot &current, LatenessHistogram::Snapshot &previous)
+{
+    LatenessHistogram::Snapshot counts;
+    uint64_t total = 0;
+    for (size_t i = 0; i < counts.size(); i++)
+    {
+        counts[i] = current[i] - previous[i];
+        total += counts[i];
+    }
+    previous = current;
+    if (total == 0)
+    {
+        return "";
+    }
+
+    auto percentile = [&](double fraction)
+    {
+        const uint64_t rank = static_cast<uint64_t>(std::ceil(fraction * total));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < counts.size(); i++)
         {
-            print_color_help();
-            std::exit(EXIT_SUCCESS);
+            seen += counts[i];
+            if (seen >= rank)
+            {
+                return LatenessHistogram::lower_edge(i) / 1000.0;
+            }
         }
-        else if (!strcmp(argv[i], "-d") || !strcmp(argv[i], "--dur"))
+        return LatenessHistogram::lower_edge(counts.size() - 1) / 1000.0;
+    };
+
+    std::ostringstream lateness;
+    lateness.imbue(std::locale::classic());
+    lateness << " [jitter p50 " << std::setprecision(2) << std::fixed << percentile(0.50) << "us p99 " << percentile(0.99) << "us]";
+    return lateness.str();
+}
+
+constexpr size_t HASH_CHUNK_SIZE = 256 * 1024;
+
+const std::uint32_t SHA256_K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SHA256_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+#define SHA256_TARGET
+#else
+#define SHA256_TARGET __attribute__((target("sha,sse4.1")))
+#endif
+
+bool sha256_hardware_supported()
+{
+    int registers[4] = {0, 0, 0, 0};
+#if defined(_MSC_VER) && !defined(__clang__)
+    __cpuidex(registers, 7, 0);
+#else
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+    {
+        return false;
+    }
+    registers[1] = static_cast<int>(ebx);
+#endif
+    return (registers[1] & (1 << 29)) != 0;
+}
+
+// SHA-NI: each pair of sha256rnds2 calls covers four rounds, sha256msg1/msg2 extend the schedule.
+SHA256_TARGET void sha256_blocks_hardware(std::uint32_t state[8], const unsigned char *data, size_t blocks)
+{
+    const __m128i byte_swap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    __m128i cdab = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(&state[0])), 0xB1);
+    __m128i efgh = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(&state[4])), 0x1B);
+    __m128i abef = _mm_alignr_epi8(cdab, efgh, 8);
+    __m128i cdgh = _mm_blend_epi16(efgh, cdab, 0xF0);
+
+    for (; blocks > 0; blocks--, data += 64)
+    {
+        const __m128i abef_save = abef;
+        const __m128i cdgh_save = cdgh;
+        __m128i w0 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data)), byte_swap);
+        __m128i w1 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 16)), byte_swap);
+        __m128i w2 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 32)), byte_swap);
+        __m128i w3 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 48)), byte_swap);
+
+#define SHA256_ROUNDS(group, current)                                                                               \
+    {                                                                                                               \
+        __m128i message = _mm_add_epi32(current, _mm_loadu_si128(reinterpret_cast<const __m128i *>(&SHA256_K[4 * (group)]))); \
+        cdgh = _mm_sha256rnds2_epu32(cdgh, abef, message);                                                          \
+        abef = _mm_sha256rnds2_epu32(abef, cdgh, _mm_shuffle_epi32(message, 0x0E));                                 \
+    }
+#define SHA256_SCHEDULE(a, b, c, d) \
+    a = _mm_sha256msg2_epu32(_mm_add_epi32(_mm_sha256msg1_epu32(a, b), _mm_alignr_epi8(d, c, 4)), d);
+
+        for (int group = 0; group < 12; group += 4)
         {
-            param_duration = argv[i + 1];
+            SHA256_ROUNDS(group, w0) SHA256_SCHEDULE(w0, w1, w2, w3)
+            SHA256_ROUNDS(group + 1, w1) SHA256_SCHEDULE(w1, w2, w3, w0)
+            SHA256_ROUNDS(group + 2, w2) SHA256_SCHEDULE(w2, w3, w0, w1)
+            SHA256_ROUNDS(group + 3, w3) SHA256_SCHEDULE(w3, w0, w1, w2)
         }
-        else if (!strcmp(argv[i], "-t") || !strcmp(argv[i], "--timer"))
+        SHA256_ROUNDS(12, w0)
+        SHA256_ROUNDS(13, w1)
+        SHA256_ROUNDS(14, w2)
+        SHA256_ROUNDS(15, w3)
+#undef SHA256_ROUNDS
+#undef SHA256_SCHEDULE
+
+        abef = _mm_add_epi32(abef, abef_save);
+        cdgh = _mm_add_epi32(cdgh, cdgh_save);
+    }
+
+    __m128i feba = _mm_shuffle_epi32(abef, 0x1B);
+    __m128i dchg = _mm_shuffle_epi32(cdgh, 0xB1);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(&state[0]), _mm_blend_epi16(feba, dchg, 0xF0));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(&state[4]), _mm_alignr_epi8(dchg, feba, 8));
+}
+#elif defined(__aarch64__) && (defined(__ARM_FEATURE_SHA2) || defined(__ARM_FEATURE_CRYPTO))
+#define SHA256_ARM
+
+bool sha256_hardware_supported()
+{
+    return true;
+}
+
+// ARMv8 crypto extensions: vsha256h/h2 run four rounds, vsha256su0/su1 extend the schedule.
+void sha256_blocks_hardware(std::uint32_t state[8], const unsigned char *data, size_t blocks)
+{
+    uint32x4_t abcd = vld1q_u32(&state[0]);
+    uint32x4_t efgh = vld1q_u32(&state[4]);
+
+    for (; blocks > 0; blocks--, data += 64)
+    {
+        const uint32x4_t abcd_save = abcd;
+        const uint32x4_t efgh_save = efgh;
+        uint32x4_t w[4];
+        for (int i = 0; i < 4; i++)
+        {
+            w[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + 16 * i)));
+        }
+
+        for (int i = 0; i < 16; i++)
+        {
+            uint32x4_t message = vaddq_u32(w[i & 3], vld1q_u32(&SHA256_K[4 * i]));
+            if (i < 12)
+            {
+                w[i & 3] = vsha256su1q_u32(vsha256su0q_u32(w[i & 3], w[(i + 1) & 3]), w[(i + 2) & 3], w[(i + 3) & 3]);
+            }
+            uint32x4_t abcd_before = abcd;
+            abcd = vsha256hq_u32(abcd, efgh, message);
+            efgh = vsha256h2q_u32(efgh, abcd_before, message);
+        }
+
+        abcd = vaddq_u32(abcd, abcd_save);
+        efgh = vaddq_u32(efgh, efgh_save);
+    }
+
+    vst1q_u32(&state[0], abcd);
+    vst1q_u32(&state[4], efgh);
+}
+#endif
+
+// Incremental SHA-256 that produces the same digest as picosha2::hash256_hex_string, using
+// SHA-NI or the ARMv8 SHA-256 instructions when the CPU has them and picosha2's block
+// function otherwise.
+class Sha256Stream
+{
+public:
+    Sha256Stream()
+        : state{0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19}
+    {
+#if defined(SHA256_X86) || defined(SHA256_ARM)
+        hardware = sha256_hardware_supported();
+#endif
+    }
+
+    void update(const char *data, size_t length)
+    {
+        const unsigned char *bytes = reinterpret_cast<const unsigned char *>(data);
+        total_length += length;
+
+        if (pending_length > 0)
+        {
+            size_t take = std::min(length, 64 - pending_length);
+            std::memcpy(pending + pending_length, bytes, take);
+            pending_length += take;
+            bytes += take;
+            length -= take;
+            if (pending_length < 64)
+            {
+                return;
+            }
+            compress(pending, 1);
+            pending_length = 0;
+        }
+
+        compress(bytes, length / 64);
+        bytes += length / 64 * 64;
+        pending_length = length % 64;
+        std::memcpy(pending, bytes, pending_length);
+    }
+
+    std::string hex_digest()
+    {
+        unsigned long long bit_length = total_length * 8;
+        unsigned char padding[72] = {0x80};
+        size_t padding_length = (pending_length < 56 ? 56 : 120) - pending_length;
+        for (int i = 0; i < 8; i++)
+        {
+            padding[padding_length + i] = static_cast<unsigned char>(bit_length >> (56 - 8 * i));
+        }
+        update(reinterpret_cast<const char *>(padding), padding_length + 8);
+
+        std::ostringstream hex;
+        hex << std::hex << std::setfill('0');
+        for (std::uint32_t word : state)
+        {
+            hex << std::setw(8) << word;
+        }
+        return hex.str();
+    }
+
+private:
+    void compress(const unsigned char *data, size_t blocks)
+    {
+        if (blocks == 0)
+        {
+            return;
+        }
+#if defined(SHA256_X86) || defined(SHA256_ARM)
+        if (hardware)
+        {
+            sha256_blocks_hardware(state, data, blocks);
+            return;
+        }
+#endif
+        picosha2::word_t words[8];
+        std::copy(state, state + 8, words);
+        for (size_t i = 0; i < blocks; i++)
+        {
+            picosha2::detail::hash256_block(words, data + 64 * i, data + 64 * (i + 1));
+        }
+        for (int i = 0; i < 8; i++)
+        {
+            state[i] = static_cast<std::uint32_t>(words[i]);
+        }
+    }
+
+    std::uint32_t state[8];
+    unsigned char pending[64] = {};
+    size_t pending_length = 0;
+    unsigned long long total_length = 0;
+    bool hardware = false;
+};
+
+std::string sha256_hex(const std::string &data)
+{
+    Sha256Stream hasher;
+    hasher.update(data.data(), data.size());
+    return hasher.hex_digest();
+}
+
+// SHA-256 of count back-to-back copies of unit, without building them: a chunk of whole
+// copies that stays in cache is fed through the hasher again and again, and its prefix
+// covers the leftover copies.
+std::string sha256_repeated_hex(std::string_view unit, unsigned long long count)
+{
+    Sha256Stream hasher;
+    if (unit.empty() || count == 0)
+    {
+        return hasher.hex_digest();
+    }
+    if (unit.size() >= HASH_CHUNK_SIZE)
+    {
+        // Already bigger than a chunk: hash it in place every time instead of copying it.
+        for (unsigned long long copy = 0; copy < count && !interrupted; ++copy)
+        {
+            hasher.update(unit.data(), unit.size());
+        }
+        return hasher.hex_digest();
+    }
+
+    unsigned long long chunk_copies = std::min<unsigned long long>(count, std::max<size_t>(1, HASH_CHUNK_SIZE / unit.size()));
+    const std::string chunk = repeat_to_count(unit, chunk_copies);
+    unsigned long long remaining = count;
+    for (; remaining >= chunk_copies && !interrupted; remaining -= chunk_copies)
+    {
+        hasher.update(chunk.data(), chunk.size());
+    }
+    hasher.update(chunk.data(), remaining * unit.size());
+    return hasher.hex_digest();
+}
+
+// Same output as compressMessage(repeat_to_count(unit, count)), without building that buffer.
+// The blocks are read out of one window a block (plus dictionary and one unit) long, and
+// since every whole block in the middle is fully determined by where it starts within
+// unit, blocks at the same offset are only compressed once.
+std::string compress_repeated(std::string_view unit, unsigned long long count, CompressionCodec codec = CompressionCodec::Zlib, int level = Z_DEFAULT_COMPRESSION)
+{
+    if (unit.empty() || count == 0)
+    {
+        return compressMessage(std::string(), codec, level);
+    }
+
+    const size_t unit_length = unit.size();
+    const unsigned long long total_length = unit_length * count;
+    const size_t block_count = (total_length + COMPRESSION_BLOCK_SIZE - 1) / COMPRESSION_BLOCK_SIZE;
+    // A single copy is its own window, so it is read where it is.
+    const std::string repeated_window = (count > 1) ? repeat_to_count(unit, std::min(count, copies_to_fill(unit_length + DEFLATE_WINDOW_SIZE + COMPRESSION_BLOCK_SIZE, unit_length) + 1)) : std::string();
+    const char *window = (count > 1) ? repeated_window.data() : unit.data();
+
+    return compress_blocks(
+        total_length,
+        [&](unsigned long long start)
+        {
+            size_t dictionary_length = static_cast<size_t>(std::min<unsigned long long>(start, DEFLATE_WINDOW_SIZE));
+            return window + dictionary_length + (start - dictionary_length) % unit_length;
+        },
+        [&](size_t block)
+        {
+            if (block == 0 || block + 1 == block_count)
+            {
+                return UNIQUE_BLOCK;
+            }
+            return (static_cast<unsigned long long>(block) * COMPRESSION_BLOCK_SIZE) % unit_length;
+        },
+        codec, level);
+}
+
+unsigned int get_thread_count(const std::string &param_threads)
+{
+    unsigned int cpu_count = std::thread::hardware_concurrency();
+    if (cpu_count == 0)
+    {
+        cpu_count = 1;
+    }
+
+    std::string threads_value = param_threads;
+    std::transform(threads_value.begin(), threads_value.end(), threads_value.begin(), ::toupper);
+
+    if (threads_value == "AUTO")
+    {
+        return cpu_count;
+    }
+
+    int thread_count = std::atoi(threads_value.c_str());
+    return (thread_count < 1) ? 1 : static_cast<unsigned int>(thread_count);
+}
+
+void pin_current_thread_to_core(unsigned int core)
+{
+    unsigned int cpu_count = std::thread::hardware_concurrency();
+    if (cpu_count == 0)
+    {
+        return;
+    }
+    core %= cpu_count;
+
+#ifdef _WIN32
+    SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(1) << (core % (sizeof(DWORD_PTR) * 8)));
+#elif __linux__
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(core, &cpuset);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+#endif // macOS has no hard affinity, the scheduler places the thread.
+}
+
+// Paces --freq against absolute deadlines. Tick k is due at origin + k / frequency seconds,
+// worked out in integers, so the rate never drifts and every second of the schedule holds
+// exactly frequency ticks. wait() sleeps until just before the deadline (clock_nanosleep with
+// TIMER_ABSTIME on Linux, a high-resolution waitable timer on Windows) and spins the rest of
+// the way; the spin margin follows how late the sleeps have been waking up. A thread that
+// falls behind gets all of its due ticks back in one batch, but once it is more than
+// MAX_BACKLOG behind the schedule starts over from now instead of bursting.
+// With a stride, a scheduler owns only every stride-th tick from first_tick onwards, which is
+// how the --threads workers share one frequency without firing together.
+class RateScheduler
+{
+public:
+    RateScheduler(int frequency, unsigned int first_tick = 0, unsigned int stride = 1)
+        : frequency(static_cast<uint64_t>(frequency)), first_tick(first_tick), stride(stride)
+    {
+#ifdef _WIN32
+        timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+        if (timer == nullptr)
+        {
+            // Windows before 10 1803: a plain timer, whose coarser wake-ups the spin margin absorbs
+            timer = CreateWaitableTimerW(nullptr, TRUE, nullptr);
+        }
+#elif __linux__
+        // The default 50 us timer slack would be added to every sleep
+        prctl(PR_SET_TIMERSLACK, 1UL);
+#endif
+        restart();
+    }
+
+    RateScheduler(const RateScheduler &) = delete;
+    RateScheduler &operator=(const RateScheduler &) = delete;
+
+    ~RateScheduler()
+    {
+#ifdef _WIN32
+        if (timer != nullptr)
+        {
+            CloseHandle(timer);
+        }
+#endif
+    }
+
+    // Blocks until the next tick is due and returns how many ticks are due by then, from 1 to limit.
+    unsigned long long wait(LatenessHistogram &lateness, unsigned long long limit)
+    {
+        const steady_clock::time_point due = deadline(tick);
+        steady_clock::time_point now = steady_clock::now();
+
+        if (now - due > MAX_BACKLOG)
+        {
+            restart();
+            return wait(lateness, limit);
+        }
+
+        if (due - now > spin_margin)
+        {
+            const steady_clock::time_point wake = due - spin_margin;
+            sleep_until(wake);
+            now = steady_clock::now();
+            const nanoseconds overshoot = std::max(duration_cast<nanoseconds>(now - wake), nanoseconds(0));
+            spin_margin = std::clamp(spin_margin + (2 * overshoot - spin_margin) / 16, MIN_SPIN_MARGIN, MAX_SPIN_MARGIN);
+        }
+        while (now < due)
+        {
+            now = steady_clock::now();
+        }
+        lateness.record(duration_cast<nanoseconds>(now - due).count());
+
+        unsigned long long ticks = 1;
+        tick += stride;
+        while (ticks < limit && deadline(tick) <= now)
+        {
+            ticks++;
+            tick += stride;
+        }
+        return ticks;
+    }
+
+    // When the next tick this scheduler owns is due.
+    steady_clock::time_point next_deadline() const
+    {
+        return deadline(tick);
+    }
+
+    // Starts the schedule again from now, e.g. after a --restevery pause.
+    void restart()
+    {
+        origin = steady_clock::now();
+        tick = first_tick;
+    }
+
+private:
+    static constexpr nanoseconds MIN_SPIN_MARGIN = microseconds(2);
+    static constexpr nanoseconds MAX_SPIN_MARGIN = milliseconds(20);
+    static constexpr nanoseconds MAX_BACKLOG = milliseconds(100);
+
+    steady_clock::time_point deadline(uint64_t k) const
+    {
+        return origin + seconds(k / frequency) + nanoseconds((k % frequency) * 1000000000ULL / frequency);
+    }
+
+    void sleep_until(steady_clock::time_point wake)
+    {
+#ifdef _WIN32
+        LARGE_INTEGER due_time;
+        due_time.QuadPart = -static_cast<LONGLONG>(duration_cast<nanoseconds>(wake - steady_clock::now()).count() / 100);
+        if (timer != nullptr && due_time.QuadPart < 0 && SetWaitableTimer(timer, &due_time, 0, nullptr, nullptr, FALSE))
+        {
+            WaitForSingleObject(timer, INFINITE);
+        }
+#elif __linux__
+        // steady_clock is CLOCK_MONOTONIC on Linux, so its time points can be handed to the kernel as they are
+        const nanoseconds since_epoch = duration_cast<nanoseconds>(wake.time_since_epoch());
+        timespec wake_time;
+        wake_time.tv_sec = static_cast<time_t>(since_epoch.count() / 1000000000);
+        wake_time.tv_nsec = static_cast<long>(since_epoch.count() % 1000000000);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake_time, nullptr) == EINTR)
+        {
+        }
+#else
+        std::this_thread::sleep_until(wake);
+#endif
+    }
+
+    const uint64_t frequency;
+    const uint64_t first_tick;
+    const uint64_t stride;
+    steady_clock::time_point origin;
+    uint64_t tick = 0;
+    nanoseconds spin_margin = microseconds(100);
+#ifdef _WIN32
+    HANDLE timer = nullptr;
+#endif
+};
+
+// Repetition worker. Each worker repeats into its own buffer and publishes a running
+// iteration count, which the main thread turns into the per-second rate and prints, so
+// a worker never reads the clock (outside --freq) or touches the console.
+void repetition_worker(unsigned int thread_id, unsigned int thread_count, std::string_view intention_value,
+                       RepetitionKernel kernel, bool exact_timer, unsigned long long amplification_int, int frequency_int,
+                       WorkerCounter &worker_counter, LatenessHistogram &lateness)
+{
+    // A lone worker is left wherever the OS schedules it.
+    if (thread_count > 1)
+    {
+        pin_current_thread_to_core(thread_id);
+    }
+
+    std::string process_intention;
+    prepare_repetition_buffer(kernel, intention_value, process_intention);
+    unsigned long long local_iterations = 0;
+
+    if (frequency_int > 0)
+    {
+        // The requested frequency is shared between the workers: worker i takes every
+        // thread_count-th tick from tick i, so they don't fire together.
+        RateScheduler scheduler(frequency_int, thread_id, thread_count);
+
+        while (!interrupted)
+        {
+            if (resting)
+            {
+                std::this_thread::sleep_for(milliseconds(10));
+                scheduler.restart();
+                continue;
+            }
+
+            unsigned long long due = scheduler.wait(lateness, ULLONG_MAX);
+            for (unsigned long long i = 0; i < due; i++)
+            {
+                repeat_intention(kernel, intention_value, process_intention);
+            }
+            local_iterations += due;
+            worker_counter.iterations.store(local_iterations, std::memory_order_relaxed);
+        }
+    }
+    else
+    {
+        unsigned long long batch = 1;
+        steady_clock::time_point batch_start = steady_clock::now();
+
+        // Runs up to limit repetitions, publishes the count and retunes the batch size.
+        auto run_batch = [&](unsigned long long limit)
+        {
+            const unsigned long long count = (std::min)(batch, limit);
+            for (unsigned long long int i = 0; i < count; i++)
+            {
+                repeat_intention(kernel, intention_value, process_intention);
+            }
+            local_iterations += count;
+            worker_counter.iterations.store(local_iterations, std::memory_order_relaxed);
+
+            const steady_clock::time_point now = steady_clock::now();
+            if (count == batch)
+            {
+                batch = retune_batch(batch, now - batch_start);
+            }
+            batch_start = now;
+            return count;
+        };
+
+        while (!interrupted)
+        {
+            if (resting)
+            {
+                std::this_thread::sleep_for(milliseconds(10));
+                batch_start = steady_clock::now();
+                continue;
+            }
+
+            if (exact_timer)
+            {
+                run_batch(ULLONG_MAX);
+            }
+            else // INEXACT: the flags are only checked every amplification_int repetitions
+            {
+                for (unsigned long long done = 0; done < amplification_int;)
+                {
+                    done += run_batch(amplification_int - done);
+                }
+            }
+        }
+    }
+}
+
+void print_status(const std::string &runtime_formatted, const IterationCounter &total_iterations, const IterationCounter &total_freq,
+                  const std::string &suffix_value, const std::string &bandwidth_display, const std::string &intention_display)
+{
+    std::string totalIterations = total_iterations.str();
+    std::string totalFreq = total_freq.str();
+    int digits = totalIterations.length();
+    int freqDigits = totalFreq.length();
+
+    if (suffix_value == "EXP")
+    {
+        std::cout << "[" + runtime_formatted + "]"
+                  << " (" << std::setprecision(3) << std::fixed
+                  << (std::stoull(totalIterations.substr(0, 4)) / std::pow(10, 3)) << "x10^" << digits - 1 << " / "
+                  << (std::stoull(totalFreq.substr(0, 4)) / std::pow(10, 3)) << "x10^" << freqDigits - 1
+                  << " Hz)" << bandwidth_display << ": " << intention_display << "     \r" << std::flush;
+    }
+    else // suffix_value = "HZ"
+    {
+        std::cout << "[" + runtime_formatted + "]"
+                  << " (" << display_suffix(totalIterations, digits - 1, "Iterations") << " / "
+                  << display_suffix(totalFreq, freqDigits - 1, "Frequency")
+                  << "Hz)" << bandwidth_display << ": " << intention_display << "     \r" << std::flush;
+    }
+}
+
+// --benchmark: sweeps buffer sizes, thread counts and kernels, plus the hashing and
+// compression steps, and writes the results to BENCHMARK.CSV and BENCHMARK.JSON.
+const std::string BENCHMARK_CSV_FILE = "BENCHMARK.CSV";
+const std::string BENCHMARK_JSON_FILE = "BENCHMARK.JSON";
+constexpr double BENCHMARK_CASE_SECONDS = 0.25;
+constexpr unsigned long long BENCHMARK_MIN_BUFFER = 1024;
+constexpr unsigned long long BENCHMARK_MAX_OPTION_BUFFER = 64ULL * 1024 * 1024;
+constexpr unsigned long long BENCHMARK_BATCH_BYTES = 1024 * 1024;
+
+struct BenchmarkResult
+{
+    std::string test;
+    unsigned int threads;
+    unsigned long long buffer_size;
+    double iterations_per_second;
+    double bytes_per_second;
+    double latency_p50_ns;
+    double latency_p90_ns;
+    double latency_p99_ns;
+};
+
+std::string build_benchmark_buffer(const std::string &unit, unsigned long long size)
+{
+    std::string buffer;
+    buffer.reserve(size);
+    buffer = unit.substr(0, size);
+    while (buffer.size() < size)
+    {
+        buffer.append(buffer, 0, std::min<unsigned long long>(buffer.size(), size - buffer.size()));
+    }
+    return buffer;
+}
+
+std::string format_bytes(double bytes)
+{
+    constexpr const char *units[] = {"B", "KB", "MB", "GB", "TB"};
+    int unit = 0;
+    while (bytes >= 1024 && unit < 4)
+    {
+        bytes /= 1024;
+        ++unit;
+    }
+    std::ostringstream formatted;
+    formatted.imbue(std::locale::classic());
+    formatted << std::setprecision(unit == 0 ? 0 : 2) << std::fixed << bytes << " " << units[unit];
+    return formatted.str();
+}
+
+// Runs operation on thread_count pinned threads for at least BENCHMARK_CASE_SECONDS, timed from
+// when every thread has prepared its buffer. Iterations are timed in batches of about
+// BENCHMARK_BATCH_BYTES so the clock reads don't dominate small buffers.
+template <typename Prepare, typename Operation>
+BenchmarkResult run_benchmark_case(const std::string &test, const std::string &buffer, unsigned int thread_count,
+                                   Prepare prepare, Operation operation)
+{
+    const unsigned long long batch_size = std::max<unsigned long long>(1, BENCHMARK_BATCH_BYTES / std::max<size_t>(buffer.size(), 1));
+    std::vector<std::vector<double>> latencies(thread_count);
+    std::vector<unsigned long long> iterations(thread_count, 0);
+    std::atomic<unsigned int> ready(0);
+    std::atomic<bool> go(false), stop(false);
+    std::vector<std::thread> threads;
+
+    for (unsigned int t = 0; t < thread_count; t++)
+    {
+        threads.emplace_back([&, t]()
+        {
+            pin_current_thread_to_core(t);
+            std::string scratch;
+            prepare(scratch);
+            latencies[t].reserve(4096);
+            ready.fetch_add(1);
+            while (!go.load())
+            {
+                std::this_thread::yield();
+            }
+
+            do
+            {
+                auto batch_start = steady_clock::now();
+                for (unsigned long long i = 0; i < batch_size; i++)
+                {
+                    operation(scratch);
+                }
+                auto batch_end = steady_clock::now();
+                latencies[t].push_back(duration_cast<nanoseconds>(batch_end - batch_start).count() / static_cast<double>(batch_size));
+                iterations[t] += batch_size;
+            } while (!stop.load(std::memory_order_relaxed));
+        });
+    }
+
+    while (ready.load() < thread_count)
+    {
+        std::this_thread::yield();
+    }
+    auto start = steady_clock::now();
+    go.store(true);
+    std::this_thread::sleep_for(duration<double>(BENCHMARK_CASE_SECONDS));
+    stop.store(true);
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    double elapsed = duration_cast<duration<double>>(steady_clock::now() - start).count();
+
+    std::vector<double> samples;
+    unsigned long long total_iterations = 0;
+    for (unsigned int t = 0; t < thread_count; t++)
+    {
+        samples.insert(samples.end(), latencies[t].begin(), latencies[t].end());
+        total_iterations += iterations[t];
+    }
+
+    auto percentile = [&samples](double fraction)
+    {
+        if (samples.empty())
+        {
+            return 0.0;
+        }
+        size_t index = std::min(samples.size() - 1, static_cast<size_t>(fraction * samples.size()));
+        std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+        return samples[index];
+    };
+
+    BenchmarkResult result;
+    result.test = test;
+    result.threads = thread_count;
+    result.buffer_size = buffer.size();
+    result.iterations_per_second = total_iterations / elapsed;
+    result.bytes_per_second = result.iterations_per_second * buffer.size();
+    result.latency_p50_ns = percentile(0.50);
+    result.latency_p90_ns = percentile(0.90);
+    result.latency_p99_ns = percentile(0.99);
+    return result;
+}
+
+void print_benchmark_result(const BenchmarkResult &result)
+{
+    std::cout << std::left << std::setw(10) << result.test << std::right
+              << std::setw(8) << result.threads
+              << std::setw(12) << format_bytes(result.buffer_size)
+              << std::setw(20) << std::setprecision(0) << std::fixed << result.iterations_per_second
+              << std::setw(14) << format_bytes(result.bytes_per_second) + "/s"
+              << std::setw(16) << std::setprecision(1) << result.latency_p50_ns
+              << std::setw(16) << result.latency_p90_ns
+              << std::setw(16) << result.latency_p99_ns << std::endl;
+}
+
+void write_benchmark_results(const std::vector<BenchmarkResult> &results)
+{
+    std::ofstream csv(BENCHMARK_CSV_FILE);
+    csv << "test,threads,buffer_bytes,iterations_per_second,bytes_per_second,latency_p50_ns,latency_p90_ns,latency_p99_ns\n";
+    for (const BenchmarkResult &result : results)
+    {
+        csv << result.test << "," << result.threads << "," << result.buffer_size << ","
+            << std::setprecision(2) << std::fixed << result.iterations_per_second << "," << result.bytes_per_second << ","
+            << result.latency_p50_ns << "," << result.latency_p90_ns << "," << result.latency_p99_ns << "\n";
+    }
+
+    std::ofstream json(BENCHMARK_JSON_FILE);
+    json << "[\n";
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const BenchmarkResult &result = results[i];
+        json << "  {\"test\": \"" << result.test << "\", \"threads\": " << result.threads
+             << ", \"buffer_bytes\": " << result.buffer_size
+             << std::setprecision(2) << std::fixed
+             << ", \"iterations_per_second\": " << result.iterations_per_second
+             << ", \"bytes_per_second\": " << result.bytes_per_second
+             << ", \"latency_p50_ns\": " << result.latency_p50_ns
+             << ", \"latency_p90_ns\": " << result.latency_p90_ns
+             << ", \"latency_p99_ns\": " << result.latency_p99_ns << "}"
+             << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    json << "]\n";
+}
+
+void run_benchmark(const std::string &intention, unsigned int max_threads)
+{
+    const std::string unit = intention.empty() ? "I am love. " : intention;
+    std::vector<unsigned int> thread_counts;
+    for (unsigned int threads = 1; threads < max_threads; threads *= 2)
+    {
+        thread_counts.push_back(threads);
+    }
+    thread_counts.push_back(max_threads);
+
+    // Every thread may hold its own copy of the buffer, so leave room for all of them.
+    unsigned long long max_buffer = get_ninety_percent_free_memory() / (max_threads + 1);
+
+    std::cout << "Benchmarking up to " << format_bytes(max_buffer) << " with up to " << max_threads << " threads." << std::endl
+              << std::endl;
+    std::cout << std::left << std::setw(10) << "TEST" << std::right << std::setw(8) << "THREADS" << std::setw(12) << "BUFFER"
+              << std::setw(20) << "ITERATIONS/S" << std::setw(14) << "BYTES/S" << std::setw(16) << "P50 NS"
+              << std::setw(16) << "P90 NS" << std::setw(16) << "P99 NS" << std::endl;
+
+    const std::pair<std::string, RepetitionKernel> kernels[] = {
+        {"COPY", RepetitionKernel::Copy}, {"STREAM", RepetitionKernel::Stream}, {"NT", RepetitionKernel::NonTemporal}};
+    std::vector<BenchmarkResult> results;
+
+    for (unsigned long long size = BENCHMARK_MIN_BUFFER; size <= max_buffer && !interrupted; size *= 4)
+    {
+        const std::string buffer = build_benchmark_buffer(unit, size);
+
+        for (const auto &kernel : kernels)
+        {
+            for (unsigned int threads : thread_counts)
+            {
+                RepetitionKernel repetition_kernel = kernel.second;
+                results.push_back(run_benchmark_case(
+                    kernel.first, buffer, threads,
+                    [&](std::string &scratch) { prepare_repetition_buffer(repetition_kernel, buffer, scratch); },
+                    [&](std::string &scratch) { repeat_intention(repetition_kernel, buffer, scratch); }));
+                print_benchmark_result(results.back());
+            }
+        }
+
+        if (size <= BENCHMARK_MAX_OPTION_BUFFER)
+        {
+            results.push_back(run_benchmark_case(
+                "HASHING", buffer, 1, [](std::string &) {},
+                [&](std::string &scratch) { scratch = sha256_hex(buffer); }));
+            print_benchmark_result(results.back());
+
+            results.push_back(run_benchmark_case(
+                "COMPRESS", buffer, 1, [](std::string &) {},
+                [&](std::string &scratch) { scratch = compressMessage(buffer); }));
+            print_benchmark_result(results.back());
+        }
+    }
+
+    write_benchmark_results(results);
+    std::cout << std::endl
+              << "Benchmark results written to " << BENCHMARK_CSV_FILE << " and " << BENCHMARK_JSON_FILE << "." << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    std::string intention, process_intention, intention_value, duration, param_duration;
+    std::string param_intention, param_intention_2, param_timer, param_boostlevel, param_freq, param_color;
+    std::string param_usehololink, param_amplification, runtime_formatted, ref_rate;
+    std::string suffix_value = "HZ", HSUPLINK_FILE, param_restevery, param_restfor;
+    std::string param_compress, param_hashing, useHashing, useCompression, intention_hashed, param_file2, param_threads, param_kernel, bandwidth_display, param_benchmark, param_codec, param_level;
+    std::string param_file, intention_display = "", loading_message="LOADING INTO MEMORY...";
+    unsigned long long int multiplier = 0, amplification_int = 1000000000;
+    IterationCounter totalIterations, totalFreq;
+    unsigned long long int cpu_benchmark_count = 0, hashMultiplier = 0, freq = 0;
+    int seconds = 0, frequency_int = 0, restevery_int = 0, restfor_int = 0;
+    int digits = 0;
+    float ram_size_value = 1;
+
+    param_duration = "UNTIL STOPPED";
+    param_timer = "EXACT";
+    param_freq = "0";
+    param_intention = "X";
+    param_color = "WHITE";
+    param_usehololink = "NO";
+    param_boostlevel = "0";
+    param_amplification = "1000000000";
+    param_restevery = "0";
+    param_restfor = "0";
+    param_hashing = "X";
+    param_compress = "X";
+    param_file = "X";
+    param_file2 = "X";
+    param_threads = "X";
+    param_benchmark = "NO";
+    param_codec = "X";
+    param_level = "X";
+    param_kernel = "X";
+    HSUPLINK_FILE = "HSUPLINK.TXT";
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-h") || !strcmp(argv[i], "--help") || !strcmp(argv[i], "/?"))
+        {
+            print_help();
+            std::exit(EXIT_SUCCESS);
+        }
+        else if (!strcmp(argv[i], "-n") || !strcmp(argv[i], "--colorhelp"))
+        {
+            print_color_help();
+            std::exit(EXIT_SUCCESS);
+        }
+        else if (!strcmp(argv[i], "-d") || !strcmp(argv[i], "--dur"))
+        {
+            param_duration = argv[i + 1];
+        }
+        else if (!strcmp(argv[i], "-t") || !strcmp(argv[i], "--timer"))
         {
             param_timer = argv[i + 1];
         }
@@ -833,46 +2025,72 @@ int main(int argc, char **argv)
         {
             param_file2 = argv[i + 1];
         }
+        else if (!strcmp(argv[i], "-j") || !strcmp(argv[i], "--threads"))
+        {
+            param_threads = argv[i + 1];
+        }
+        else if (!strcmp(argv[i], "-k") || !strcmp(argv[i], "--kernel"))
+        {
+            param_kernel = argv[i + 1];
+        }
+        else if (!strcmp(argv[i], "--benchmark"))
+        {
+            param_benchmark = "YES";
+        }
+        else if (!strcmp(argv[i], "-z") || !strcmp(argv[i], "--codec"))
+        {
+            param_codec = argv[i + 1];
+        }
+        else if (!strcmp(argv[i], "-l") || !strcmp(argv[i], "--level"))
+        {
+            param_level = argv[i + 1];
+        }
     }
 
-    std::string boosted_intention = "";
-    
+    unsigned int thread_count = get_thread_count(param_threads);
+    RepetitionKernel kernel = get_repetition_kernel(param_kernel);
+
+    NestingChain nesting_chain;
+    bool boosted = false;
+
     if (param_boostlevel != "0")
     {
-        boosted_intention = getBoostIntention(param_boostlevel);
+        boosted = nesting_chain.load(std::stoi(param_boostlevel));
         intention_display = "Using Nesting File Quantumly: NEST-" + param_boostlevel + ".TXT with INTENTIONS.TXT";
     }
 
     if (param_usehololink == "YES")
     {
         std::cout << "Loading HOLO-LINK Files..." << std::flush;
-        if (!boosted_intention.empty())
+        if (param_boostlevel != "0")
         {
             // Use boosted content within Holo-Link framework
-            intention = getHSUPLINKContents(boosted_intention);
+            getHSUPLINKContents(intention, boosted ? nesting_chain.contents() : "0");
             intention_display = "Holo-Link with Boost Level " + param_boostlevel;
         }
         else
         {
             // Use regular INTENTIONS.TXT with Holo-Link
-            intention = getHSUPLINKContents();
+            getHSUPLINKContents(intention);
             intention_display = HSUPLINK_FILE;
         }
     }
-    else if (param_boostlevel != "0")
+    else if (param_boostlevel != "0" && !boosted)
     {
-        // Use boost without Holo-Link
-        intention = boosted_intention;
+        intention = "0";
     }
 
-    unsigned long long int INTENTION_MULTIPLIER = static_cast<unsigned long long int>(ram_size_value * 1024 * 1024 * 512);
+    // --imem is the whole budget. It holds the multiplied intention, which every thread reads, plus
+    // the full-size copy each thread repeats it into (STREAM only needs a small scratch buffer).
+    const unsigned long long int repetition_buffers = 1 + (kernel == RepetitionKernel::Stream ? 0 : thread_count);
+    unsigned long long int INTENTION_MULTIPLIER = static_cast<unsigned long long int>(ram_size_value * 1024 * 1024 * 1024 / repetition_buffers);
     unsigned long long int free_memory = get_ninety_percent_free_memory();
 
     if (free_memory != static_cast<unsigned long long>(-1))
     {
-        if (free_memory < INTENTION_MULTIPLIER)
+        if (free_memory / repetition_buffers < INTENTION_MULTIPLIER)
         {
-            INTENTION_MULTIPLIER = free_memory;
+            INTENTION_MULTIPLIER = free_memory / repetition_buffers;
         }
     }
     else
@@ -958,6 +2176,12 @@ int main(int argc, char **argv)
     std::cout << "by Anthro Teacher aka Thomas Sweet." << std::endl
               << std::endl;
 
+    if (param_benchmark == "YES")
+    {
+        run_benchmark(param_intention == "X" ? "" : param_intention, get_thread_count(param_threads == "X" ? "AUTO" : param_threads));
+        return 0;
+    }
+
     std::string file_contents_original, file_contents, file_contents2_original, file_contents2, intention_original;
 
     if (param_boostlevel == "0" && param_usehololink == "NO")
@@ -1001,10 +2225,22 @@ int main(int argc, char **argv)
         intention = intention_original;
     }
 
+    // A --file on its own that has no NUL bytes needs no transformation, so it is repeated
+    // straight from its mapped pages instead of being copied into intention.
+    MappedFile direct_file;
+    bool file_is_direct = false;
     if (param_file != "X" && param_boostlevel == "0" && param_usehololink == "NO")
     {
-        // Open param_intent file and read the full file contents into intention
-        readFileContents(param_file, file_contents_original);
+        if (param_file2 == "X" && intention_original.empty() && direct_file.map(param_file) &&
+            std::memchr(direct_file.view().data(), '\0', direct_file.view().size()) == nullptr)
+        {
+            file_is_direct = true;
+        }
+        else
+        {
+            // Open param_intent file and read the full file contents into intention
+            readFileContents(param_file, file_contents_original);
+        }
         //intention_display += "Contents of: ";
     }
     if (param_file2 != "X" && param_boostlevel == "0" && param_usehololink == "NO")
@@ -1014,68 +2250,59 @@ int main(int argc, char **argv)
         //intention_display = "Contents of: ";
     }
 
-    size_t length1 = file_contents_original.size();
+    size_t length1 = file_is_direct ? direct_file.view().size() : file_contents_original.size();
     size_t length2 = file_contents2_original.size();
     size_t length3 = intention_original.size();
-    file_contents = file_contents_original;
-    file_contents2 = file_contents2_original;
 
     size_t max_length = (std::max)({length1, length2, length3});
 
     if (intention_original != "" && intention_original != "X" && param_boostlevel == "0" && param_usehololink == "NO")
     {
         // Normalize intention
-        while ((intention.length() + length3) < max_length)
-        {
-            intention += intention_original;
-        }
+        intention = repeat_to_count(intention_original, normalize_copies(max_length, length3));
         intention_display = intention_original;
     }
 
     if (param_file != "X" && param_boostlevel == "0" && param_usehololink == "NO")
     {
         // Normalize file_contents
-        while ((file_contents.length() + length1) < max_length)
+        if (!file_is_direct)
         {
-            file_contents += file_contents_original;
+            file_contents = repeat_to_count(file_contents_original, normalize_copies(max_length, length1));
+            std::string().swap(file_contents_original);
         }
         intention_display += "(" + param_file + ")";
     }
     if (param_file2 != "X" && param_boostlevel == "0" && param_usehololink == "NO")
     {
         // Normalize file_contents2
-        while ((file_contents2.length() + length2) < max_length)
-        {
-            file_contents2 += file_contents2_original;
-        }
+        file_contents2 = repeat_to_count(file_contents2_original, normalize_copies(max_length, length2));
+        std::string().swap(file_contents2_original);
         intention_display += "(" + param_file2 + ")";
     }
 
-    intention += file_contents + file_contents2;
-    intention_value = intention;
+    intention.reserve(intention.size() + file_contents.size() + file_contents2.size());
+    intention += file_contents;
+    intention += file_contents2;
+    std::string().swap(file_contents);
+    std::string().swap(file_contents2);
+
+    // intention_source is the text being repeated; repeat_source is what the workers copy each iteration.
+    // A boost without Holo-Link is repeated straight from the resolved nesting chain.
+    const bool boost_is_direct = boosted && param_usehololink == "NO";
+    const std::string_view intention_source = file_is_direct    ? direct_file.view()
+                                              : boost_is_direct ? nesting_chain.contents()
+                                                                : std::string_view(intention);
+    std::string_view repeat_source;
     multiplier = 1;
 
     if (frequency_int == 0)
     {
         if (INTENTION_MULTIPLIER > 0) {
-            std::cout << loading_message << std::endl;
-            std::string temp = intention;
-
-            while (intention_value.length() < INTENTION_MULTIPLIER)
-            {
-                intention_value += intention;
-                ++multiplier;
-            }
-            //--multiplier; // Account for having to reduce at the end.
-
-            long long int intention_value_length = intention_value.length();
-            long long int intention_length = intention.length();
-            //long long int intention_length_val = intention_value_length - intention_length;
-
-            //intention_value = intention_value.substr(0, intention_length_val);
+            // The expanded buffer is only built once we know it is not about to be replaced by its hash.
+            multiplier = copies_to_fill(INTENTION_MULTIPLIER, intention_source.length());
             digits = std::to_string(multiplier).length();
         } else if (INTENTION_MULTIPLIER == 0) {
-            intention_value = intention;
             multiplier = 1;
         }
 
@@ -1126,24 +2353,18 @@ int main(int argc, char **argv)
             std::cout << "Multiplier: " << display_suffix(std::to_string(multiplier), digits - 1, "Iterations") << std::endl;
         }
 
+        // intention_value ends up as repeat_count copies of repeat_unit, or their compressed form.
+        std::string_view repeat_unit = intention_source;
+        unsigned long long repeat_count = multiplier;
+        bool compressing = (useCompression == "y" || useCompression == "yes");
+
         if (useHashing == "y" || useHashing == "yes")
         {
             std::cout << "Hashing...          \r";
-            intention_hashed = picosha2::hash256_hex_string(intention_value);
-            if (INTENTION_MULTIPLIER > 0)
-            {
-                intention_value.clear();
-                while (intention_value.length() < INTENTION_MULTIPLIER)
-                {
-                    intention_value += intention_hashed;
-                    ++hashMultiplier;
-                }
-            }
-            else
-            {
-                intention_value = intention_hashed;
-                hashMultiplier = 1;
-            }
+            intention_hashed = sha256_repeated_hex(intention_source, multiplier);
+            hashMultiplier = (INTENTION_MULTIPLIER > 0) ? copies_to_fill(INTENTION_MULTIPLIER, intention_hashed.length()) : 1;
+            repeat_unit = intention_hashed;
+            repeat_count = hashMultiplier;
 
             digits = std::to_string(hashMultiplier).length();
             std::cout << "Hash Multiplier: " << display_suffix(std::to_string(hashMultiplier), digits - 1, "Iterations") << std::endl;
@@ -1152,15 +2373,41 @@ int main(int argc, char **argv)
         {
             hashMultiplier = 1;
         }
+
+        if (!compressing)
+        {
+            if (INTENTION_MULTIPLIER > 0)
+            {
+                std::cout << loading_message << std::endl;
+            }
+            if (repeat_count > 1)
+            {
+                intention_value = repeat_to_count(repeat_unit, repeat_count);
+                repeat_source = intention_value;
+            }
+            else
+            {
+                repeat_source = repeat_unit;
+            }
+        }
         long long int originalIntentionSize, compressedIntentionSize, compressionFactor;
         int compressionFactor_digits, compressedIntentionSize_digits, originalIntention_digits;
 
-        if (useCompression == "y" || useCompression == "yes")
+        if (compressing)
         {
             std::cout << "Compressing...          \r";
-            originalIntentionSize = intention_value.length() * 2;
-            intention_value = compressMessage(intention_value);
-            compressedIntentionSize = intention_value.length() * 2;
+            CompressionCodec codec = get_compression_codec(param_codec);
+            int level = get_compression_level(codec, param_level);
+
+            auto compress_start = steady_clock::now();
+            unsigned long long uncompressed_bytes = repeat_unit.length() * repeat_count;
+            originalIntentionSize = uncompressed_bytes * 2;
+            intention_value = compress_repeated(repeat_unit, repeat_count, codec, level);
+            repeat_source = intention_value;
+            compressedIntentionSize = (std::max)(2LL, static_cast<long long int>(intention_value.length() * 2));
+            double compress_seconds = (std::max)(1e-9, std::chrono::duration<double>(steady_clock::now() - compress_start).count());
+            std::ostringstream compress_rate;
+            compress_rate << std::fixed << std::setprecision(1) << (uncompressed_bytes / compress_seconds / 1e6) << " MB/s";
             compressionFactor = (originalIntentionSize / compressedIntentionSize);
 
             compressionFactor_digits = std::to_string(compressionFactor).length();
@@ -1169,267 +2416,161 @@ int main(int argc, char **argv)
 
             std::cout << "Compression: " << display_suffix(std::to_string(compressionFactor), compressionFactor_digits - 1, "Iterations") << "X ["
                     << display_suffix(std::to_string(originalIntentionSize), originalIntention_digits - 1, "Frequency") << "B -> "
-                    << display_suffix(std::to_string(compressedIntentionSize), compressedIntentionSize_digits - 1, "Frequency") << "B]     " << std::endl;
+                    << display_suffix(std::to_string(compressedIntentionSize), compressedIntentionSize_digits - 1, "Frequency") << "B] "
+                    << compress_rate.str() << "     " << std::endl;
         }
     } else { // freq > 0
         multiplier = 1;
         hashMultiplier = 1;
         useCompression = "n";
         useHashing = "n";
-        intention_value = intention;
+        repeat_source = intention_source;
     }
 
     duration = param_duration;
 
-    process_intention.reserve(intention_value.size() + 20);
-
-    auto start = std::chrono::high_resolution_clock::now();
-    auto end = std::chrono::high_resolution_clock::now();
-
-    if (frequency_int == 0)
+    // Everything but a single-threaded --freq repeats on worker threads, and this thread
+    // only wakes once a second to total their counters and print the status line.
+    if (thread_count > 1 || frequency_int == 0)
     {
-        if (param_timer == "EXACT")
+        if (frequency_int == 0 && param_timer != "EXACT")
         {
-            do
-            {
-                start = std::chrono::high_resolution_clock::now();
-                end = std::chrono::high_resolution_clock::now();
-                while ((std::chrono::duration_cast<std::chrono::seconds>(end - start).count() < 1))
-                {
-                    process_intention.clear();
-                    process_intention.append(intention_value);
-                    freq++;
-                    end = std::chrono::high_resolution_clock::now();
-                }
-                ++seconds;
+            prepare_repetition_buffer(kernel, repeat_source, process_intention);
+            cpu_benchmark_count = repeat_for(std::chrono::seconds(1), kernel, repeat_source, process_intention);
 
-                totalFreq = MultiplyStrings(std::to_string(freq), std::to_string(multiplier));
-                totalFreq = MultiplyStrings(totalFreq, std::to_string(hashMultiplier));
-                totalIterations = FindSum(totalIterations, totalFreq);
-                digits = totalIterations.length();
-                freqDigits = totalFreq.length();
-                freq = 0;
+            if (amplification_int > cpu_benchmark_count) // Make sure the amplification doesn't exceed the benchmark
+            {
+                amplification_int = cpu_benchmark_count;
+            }
+        }
+        // The workers bring their own buffers.
+        std::string().swap(process_intention);
 
-                runtime_formatted = FormatTimeRun(seconds);
+        std::vector<WorkerCounter> worker_counters(thread_count);
+        std::vector<LatenessHistogram> worker_lateness(thread_count);
+        std::vector<std::thread> workers;
 
-                if (suffix_value == "EXP")
-                {
-                    std::cout << "[" + runtime_formatted + "]"
-                              << " (" << std::setprecision(3) << std::fixed
-                              << (std::stoull(totalIterations.substr(0, 4)) / std::pow(10, 3)) << "x10^" << digits - 1 << " / "
-                              << (std::stoull(totalFreq.substr(0, 4)) / std::pow(10, 3)) << "x10^" << freqDigits - 1
-                              << " Hz): " << intention_display << "     \r" << std::flush;
-                }
-                else // suffix_value = "HZ"
-                {
-                    std::cout << "[" + runtime_formatted + "]"
-                              << " (" << display_suffix(totalIterations, digits - 1, "Iterations") << " / "
-                              << display_suffix(totalFreq, freqDigits - 1, "Frequency")
-                              << "Hz): " << intention_display << "     \r" << std::flush;
-                }
+        for (unsigned int i = 0; i < thread_count; i++)
+        {
+            workers.emplace_back(repetition_worker, i, thread_count, repeat_source, kernel, param_timer == "EXACT",
+                                 amplification_int, frequency_int, std::ref(worker_counters[i]), std::ref(worker_lateness[i]));
+        }
 
-                if (runtime_formatted == duration || interrupted)
-                {
-                    std::cout << std::endl
-                              << std::flush;
-                    std::exit(EXIT_SUCCESS);
-                }
+        unsigned long long last_iterations = 0;
+        LatenessHistogram::Snapshot reported_lateness{};
+        auto next_tick = steady_clock::now();
 
-                if ((restevery_int > 0) && (seconds % restevery_int == 0))
-                {
-                    start = std::chrono::high_resolution_clock::now();
-                    end = std::chrono::high_resolution_clock::now();
-
-                    if (suffix_value == "EXP")
-                    {
-                        std::cout << "[" + runtime_formatted + "]"
-                                  << " (" << std::setprecision(3) << std::fixed
-                                  << (std::stoull(totalIterations.substr(0, 4)) / std::pow(10, 3)) << "x10^" << digits - 1 << " / "
-                                  << (std::stoull(totalFreq.substr(0, 4)) / std::pow(10, 3)) << "x10^" << freqDigits - 1
-                                  << " Hz): " << intention_display << "     \r" << std::flush;
-                    }
-                    else // suffix_value = "HZ"
-                    {
-                        std::cout << "[" + runtime_formatted + "]"
-                                  << " (" << display_suffix(totalIterations, digits - 1, "Iterations") << " / "
-                                  << display_suffix(totalFreq, freqDigits - 1, "Frequency")
-                                  << "Hz): " << intention_display << "     \r" << std::flush;
-                    }
-                    while ((std::chrono::duration_cast<std::chrono::seconds>(end - start).count() < restfor_int))
-                    {
-                        end = std::chrono::high_resolution_clock::now();
-                    }
-                }
-            } while (1);
-            std::cout << std::endl;
-        }
-        else // End param_timer = EXACT
-        {    // BEGIN INEXACT timer
-            auto b_start = std::chrono::high_resolution_clock::now();
-            auto b_end = std::chrono::high_resolution_clock::now();
+        while (!interrupted)
+        {
+            next_tick += std::chrono::seconds(1);
+            std::this_thread::sleep_until(next_tick);
 
-            while ((std::chrono::duration_cast<std::chrono::seconds>(b_end - b_start).count() < 1))
-            {
-                process_intention.clear();
-                process_intention.append(intention_value);
-                cpu_benchmark_count++;
-                b_end = std::chrono::high_resolution_clock::now();
-            }
+            unsigned long long current_iterations = sum_counters(worker_counters);
+            freq = current_iterations - last_iterations;
+            last_iterations = current_iterations;
+            ++seconds;
 
-            if (amplification_int > cpu_benchmark_count) // Make sure the amplification doesn't exceed the benchmark
+            totalFreq = freq;
+            totalFreq *= multiplier;
+            totalFreq *= hashMultiplier;
+            totalIterations += totalFreq;
+            if (param_kernel != "X")
             {
-                amplification_int = cpu_benchmark_count;
+                bandwidth_display = format_bandwidth(freq * repeat_source.size());
             }
+            freq = 0;
 
-            do
+            std::string lateness_display;
+            if (frequency_int > 0)
             {
-                start = std::chrono::high_resolution_clock::now();
-                end = std::chrono::high_resolution_clock::now();
-                while ((std::chrono::duration_cast<std::chrono::seconds>(end - start).count() < 1))
+                LatenessHistogram::Snapshot lateness{};
+                for (const LatenessHistogram &histogram : worker_lateness)
                 {
-                    for (unsigned long long int i = 0; i < amplification_int; i++)
-                    {
-                        process_intention.clear();
-                        process_intention.append(intention_value);
-                    }
-
-                    freq += amplification_int;
-                    end = std::chrono::high_resolution_clock::now();
+                    histogram.accumulate(lateness);
                 }
-                seconds++;
-                runtime_formatted = FormatTimeRun(seconds);
+                lateness_display = format_lateness(lateness, reported_lateness);
+            }
 
-                totalFreq = MultiplyStrings(std::to_string(freq), std::to_string(multiplier));
-                totalFreq = MultiplyStrings(totalFreq, std::to_string(hashMultiplier));
-                totalIterations = FindSum(totalIterations, totalFreq);
+            runtime_formatted = FormatTime(seconds);
+            print_status(runtime_formatted, totalIterations, totalFreq, suffix_value, bandwidth_display + lateness_display, intention_display);
 
-                digits = totalIterations.length();
-                freqDigits = totalFreq.length();
-                freq = 0;
+            if (runtime_formatted == duration)
+            {
+                break;
+            }
 
-                if (suffix_value == "EXP")
-                {
-                    std::cout << "[" + runtime_formatted + "]"
-                              << " (" << std::setprecision(3) << std::fixed
-                              << (std::stoull(totalIterations.substr(0, 4)) / std::pow(10, 3)) << "x10^" << digits - 1 << " / "
-                              << (std::stoull(totalFreq.substr(0, 4)) / std::pow(10, 3)) << "x10^" << freqDigits - 1
-                              << " Hz): " << intention_display << "     \r" << std::flush;
-                }
-                else // suffix_value = "HZ"
-                {
-                    std::cout << "[" + runtime_formatted + "]"
-                              << " (" << display_suffix(totalIterations, digits - 1, "Iterations") << " / "
-                              << display_suffix(totalFreq, freqDigits - 1, "Frequency")
-                              << "Hz): " << intention_display << "     \r" << std::flush;
-                }
+            if ((restevery_int > 0) && (seconds % restevery_int == 0))
+            {
+                resting.store(true);
+                std::this_thread::sleep_for(std::chrono::seconds(restfor_int));
+                resting.store(false);
 
-                if (runtime_formatted == duration || interrupted)
-                {
-                    std::cout << std::endl
-                              << std::flush;
-                    std::exit(EXIT_SUCCESS);
-                }
+                // Don't count the iterations that finished during the rest towards the next second.
+                last_iterations = sum_counters(worker_counters);
+                next_tick = steady_clock::now();
+            }
+        }
 
-                if ((restevery_int > 0) && (seconds % restevery_int == 0))
-                {
-                    start = std::chrono::high_resolution_clock::now();
-                    end = std::chrono::high_resolution_clock::now();
-
-                    if (suffix_value == "EXP")
-                    {
-                        std::cout << "[" + runtime_formatted + "]"
-                                  << " (" << std::setprecision(3) << std::fixed
-                                  << (std::stoull(totalIterations.substr(0, 4)) / std::pow(10, 3)) << "x10^" << digits - 1 << " / "
-                                  << (std::stoull(totalFreq.substr(0, 4)) / std::pow(10, 3)) << "x10^" << freqDigits - 1
-                                  << " Hz): " << intention_display << "     \r" << std::flush;
-                    }
-                    else // suffix_value = "HZ"
-                    {
-                        std::cout << "[" + runtime_formatted + "]"
-                                  << " (" << display_suffix(totalIterations, digits - 1, "Iterations") << " / "
-                                  << display_suffix(totalFreq, freqDigits - 1, "Frequency")
-                                  << "Hz): " << intention_display << "     \r" << std::flush;
-                    }
-                    while ((std::chrono::duration_cast<std::chrono::seconds>(end - start).count() < restfor_int))
-                    {
-                        end = std::chrono::high_resolution_clock::now();
-                    }
-                }
-            } while (1);
-            std::cout << std::endl;
-        } // End param_timer INEXACT
+        interrupted.store(true);
+        for (auto &worker : workers)
+        {
+            worker.join();
+        }
+        std::cout << std::endl;
     }
     else // End param_freq = 0
     {    // Begin param_freq nonzero
-        do
+        prepare_repetition_buffer(kernel, repeat_source, process_intention);
+        RateScheduler scheduler(frequency_int);
+        LatenessHistogram lateness;
+        LatenessHistogram::Snapshot reported_lateness{};
+        // The schedule starts no earlier than the first window, so each window owns exactly its own ticks.
+        auto next_tick = steady_clock::now();
+        scheduler.restart();
+
+        while (!interrupted)
         {
-            // Get the frequency of the HPET timer
-            //auto frequency = std::chrono::high_resolution_clock::period::den / std::chrono::high_resolution_clock::period::num;
-
-            int64_t target_interval = static_cast<int64_t>(1000000000 / frequency_int);
-
-            auto start = std::chrono::high_resolution_clock::now();
-            auto start2 = std::chrono::high_resolution_clock::now();
-            auto end = std::chrono::high_resolution_clock::now();
-
-            while (true)
+            // Repeat every tick that falls due before the next report, then wait out the
+            // rest of the second, so the status line keeps to the clock like the threaded path.
+            next_tick += std::chrono::seconds(1);
+            while (!interrupted && scheduler.next_deadline() < next_tick)
             {
-                auto now = high_resolution_clock::now();
-                auto duration = duration_cast<nanoseconds>(now - start2);
-
-                if (duration.count() >= target_interval) {
-                    process_intention.clear();
-                    process_intention.append(intention_value);
-                    freq += 1;
-                    start2 = now;
-
-                    auto sleep_duration = nanoseconds(target_interval) - duration;
-                    if (sleep_duration > nanoseconds(0)) {
-                        std::this_thread::sleep_for(sleep_duration);
-                    }
-                }
-
-                end = high_resolution_clock::now();
-
-                if (std::chrono::duration_cast<std::chrono::seconds>(end - start).count() >= 1) {
-                    break;
+                unsigned long long due = scheduler.wait(lateness, ULLONG_MAX);
+                for (unsigned long long i = 0; i < due; i++)
+                {
+                    repeat_intention(kernel, repeat_source, process_intention);
                 }
+                freq += due;
             }
+            std::this_thread::sleep_until(next_tick);
 
-            ++freq;
             ++seconds;
-            runtime_formatted = FormatTimeRun(seconds);
-
-            totalFreq = std::to_string(freq);
-            totalIterations = FindSum(totalIterations, totalFreq);
+            runtime_formatted = FormatTime(seconds);
 
-            digits = totalIterations.length();
-            freqDigits = totalFreq.length();
-            freq = 0;
-
-            if (suffix_value == "EXP")
+            totalFreq = freq;
+            totalIterations += totalFreq;
+            if (param_kernel != "X")
             {
-                std::cout << "[" + runtime_formatted + "]"
-                          << " (" << std::setprecision(3) << std::fixed
-                          << (std::stoull(totalIterations.substr(0, 4)) / std::pow(10, 3)) << "x10^" << digits - 1 << " / "
-                          << (std::stoull(totalFreq.substr(0, 4)) / std::pow(10, 3)) << "x10^" << freqDigits - 1
-                          << " Hz): " << intention_display << "     \r" << std::flush;
+                bandwidth_display = format_bandwidth(freq * repeat_source.size());
             }
-            else // suffix_value = "HZ"
+            freq = 0;
+
+            LatenessHistogram::Snapshot lateness_counts{};
+            lateness.accumulate(lateness_counts);
+            print_status(runtime_formatted, totalIterations, totalFreq, suffix_value, bandwidth_display + format_lateness(lateness_counts, reported_lateness), intention_display);
+
+            if (runtime_formatted == duration)
             {
-                std::cout << "[" + runtime_formatted + "]"
-                          << " (" << display_suffix(totalIterations, digits - 1, "Iterations") << " / "
-                          << display_suffix(totalFreq, freqDigits - 1, "Frequency")
-                          << "Hz): " << intention_display << "     \r" << std::flush;
+                break;
             }
 
-            if (runtime_formatted == duration || interrupted)
+            if ((restevery_int > 0) && (seconds % restevery_int == 0))
             {
-                std::cout << std::endl
-                          << std::flush;
-                std::exit(EXIT_SUCCESS);
+                std::this_thread::sleep_for(std::chrono::seconds(restfor_int));
+                next_tick = steady_clock::now();
+                scheduler.restart();
             }
-        } while (1);
+        }
         std::cout << std::endl;
     } // End repetition_period nonzero
 
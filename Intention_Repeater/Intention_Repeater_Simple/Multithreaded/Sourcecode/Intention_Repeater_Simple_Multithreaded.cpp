@@ -1,7 +1,8 @@
 /*
 Intention Repeater Simple (Multithreaded)
 by Anthro Teacher, WebGPT and Claude 3 Opus
-To compile: g++ -O3 -Wall -static Intention_Repeater_Simple_Multithreaded.cpp -o Intention_Repeater_Simple_Multithreaded.exe -lz
+To compile: cmake -S ../../.. -B build && cmake --build build --target Intention_Repeater_Simple_Multithreaded
+or: g++ -O3 -Wall -static -std=c++20 -pthread -I../../../Intention_Core/Sourcecode Intention_Repeater_Simple_Multithreaded.cpp ../../../Intention_Core/Sourcecode/compression.cpp ../../../Intention_Core/Sourcecode/display.cpp ../../../Intention_Core/Sourcecode/repetition.cpp -o Intention_Repeater_Simple_Multithreaded.exe -lz
 */
 
 #include <iostream>
@@ -14,23 +15,26 @@ To compile: g++ -O3 -Wall -static Intention_Repeater_Simple_Multithreaded.cpp -o
 #include <signal.h>
 #include <iterator>
 #include <atomic>
-#include <mutex>
+#include <memory>
 #include <algorithm>
 #include "picosha2.h"
+#include <cstdint>
 #include <cstring>
-#include "zlib.h"
+#include "compression.h"
+#include "display.h"
+#include "iteration_counter.h"
+#include "repetition.h"
+#include "worker_counter.h"
 
-#define ONE_MINUTE 60
-#define ONE_HOUR 3600
 #define NUM_THREADS 8
+#define SCRATCH_SIZE (1024 * 1024)
 
 using namespace std;
 
 string VERSION = "v1.6";
 
 atomic<bool> interrupted(false);
-atomic<unsigned long long> freqs[NUM_THREADS];
-mutex io_mutex;
+WorkerCounter counters[NUM_THREADS];
 
 void signalHandler(int signum)
 {
@@ -38,182 +42,25 @@ void signalHandler(int signum)
     interrupted = true;
 }
 
-std::string compressMessage(const std::string &message)
+void ProcessIntention(int threadId, shared_ptr<const string> intentionMultiplied)
 {
-    z_stream zs;
-    memset(&zs, 0, sizeof(zs));
+    const string &intention = *intentionMultiplied;
+    string processIntention;
+    processIntention.reserve(SCRATCH_SIZE + 20);
 
-    if (deflateInit(&zs, Z_DEFAULT_COMPRESSION) != Z_OK)
-    {
-        return ""; // Compression initialization failed
-    }
-
-    zs.next_in = (Bytef *)message.data();
-    zs.avail_in = message.size();
-
-    std::string compressed;
-    char outbuffer[32768]; // Output buffer
-    int ret;
-    do
-    {
-        zs.next_out = reinterpret_cast<Bytef *>(outbuffer);
-        zs.avail_out = sizeof(outbuffer);
-
-        ret = deflate(&zs, Z_FINISH);
-
-        if (compressed.size() < zs.total_out)
-        {
-            compressed.append(outbuffer, zs.total_out - compressed.size());
-        }
-    } while (ret == Z_OK);
-
-    deflateEnd(&zs);
-
-    if (ret != Z_STREAM_END)
-    {
-        return ""; // Compression failed
-    }
-
-    return compressed;
-}
-
-string MultiplyStrings(const string &num1, const string &num2)
-{
-    int len1 = num1.size();
-    int len2 = num2.size();
-    vector<int> result(len1 + len2, 0);
-
-    for (int i = len1 - 1; i >= 0; --i)
-    {
-        for (int j = len2 - 1; j >= 0; --j)
-        {
-            int mul = (num1[i] - '0') * (num2[j] - '0');
-            int sum = mul + result[i + j + 1];
-
-            result[i + j + 1] = sum % 10;
-            result[i + j] += sum / 10;
-        }
-    }
-
-    string resultStr;
-    for (int num : result)
-    {
-        if (!(resultStr.empty() && num == 0))
-        {
-            resultStr.push_back(num + '0');
-        }
-    }
-
-    return resultStr.empty() ? "0" : resultStr;
-}
-
-void ProcessIntention(int threadId, string intentionMultiplied)
-{
+    unsigned long long localFreq = 0;
     while (!interrupted)
     {
-        string processIntention;
-        processIntention.reserve(intentionMultiplied.size() + 20); // Adjust based on expected size
-        unsigned long long localFreq = 0;
-        auto start = chrono::high_resolution_clock::now();
-        auto end = start + chrono::seconds(1);
-        while (chrono::high_resolution_clock::now() < end)
+        // Stream the shared intention through the scratch buffer, reusing the allocated space
+        for (size_t offset = 0; offset < intention.size(); offset += SCRATCH_SIZE)
         {
-            // Clear previous value and reuse the allocated space
-            processIntention.clear();
-            // Append the fixed part and the changing part
-            processIntention.append(intentionMultiplied);
-            processIntention.append(to_string(localFreq));
-            // Replace with actual processing if needed
-            localFreq++;
+            processIntention.assign(intention, offset, SCRATCH_SIZE);
         }
-        freqs[threadId] = localFreq;
-    }
-}
-
-std::string FormatTime(long long int seconds_elapsed)
-{
-    int hours = seconds_elapsed / ONE_HOUR;
-    int minutes = (seconds_elapsed % ONE_HOUR) / ONE_MINUTE;
-    int seconds = seconds_elapsed % ONE_MINUTE;
-
-    std::stringstream ss;
-    ss << std::setw(2) << std::setfill('0') << hours << ":"
-       << std::setw(2) << std::setfill('0') << minutes << ":"
-       << std::setw(2) << std::setfill('0') << seconds;
-
-    return ss.str();
-}
-
-std::string DisplaySuffix(std::string num, int power, std::string designator)
-{
-    std::string suffix_array = designator == "Iterations" ? " kMBTqQsSOND" : " kMGTPEZYR";
-    long long unsigned int index = power / 3;
-    char suffix = index < suffix_array.length() ? suffix_array[index] : ' ';
-    std::string result = num.substr(0, power % 3 + 1) + "." + num.substr(power % 3 + 1, 3) + suffix;
-    return result;
-}
-
-// Utility function to find the sum of two numbers represented as a string in CPP
-std::string FindSum(std::string a, std::string b)
-{
-
-    std::vector<int> finalsum; // Stores the final sum of two number
-
-    int carry = 0; // Stores carry at each stage of calculation
-
-    /* Step 1 starts here */
-
-    int i = a.size() - 1,
-        j = b.size() - 1; // Start adding from lowest significant bit
-    while ((i >= 0) && (j >= 0))
-    {                                                // Loop until either of number exhausts first
-        int x = (a[i] - '0') + (b[j] - '0') + carry; // Calculate the sum of digit in final sum by adding
-                                                     // respective digits with previous carry.
-        finalsum.push_back(x % 10);                  // Store the respective digit of the final sum in a vector.
-        carry = x / 10;                              // update the carry. The carry for next step is the
-                                                     // remaining number after forming the digit of final sum.
-        i--;                                         // Move one step towards the left in both the string(numbers)
-        j--;
-    }
-    /*  Step 2 starts here */
-
-    while (i >= 0)
-    {                                 // If the number 1 was greater than number 2, then there must
-                                      // be some digits to be taken care off.
-        int x = (a[i] - '0') + carry; // Add the remaining digits to the carry one
-                                      // by one and store the unit digit.
-        finalsum.push_back(x % 10);
-        carry = x / 10; // update the carry from each step.
-        i--;
-    }
-    /* Step 3 starts here */
-
-    while (j >= 0)
-    {                                 // If the number 2 was greater than number 1, then there must
-                                      // be some digits to be taken care off.
-        int x = (b[j] - '0') + carry; // Add the remaining digits to the carry one
-                                      // by one and store the unit digit.
-        finalsum.push_back(x % 10);
-        carry = x / 10; // update the carry from each step.
-        j--;
+        // Append the changing part
+        processIntention.append(to_string(localFreq));
+        // Only this thread writes its counter, so a relaxed store is enough
+        counters[threadId].iterations.store(++localFreq, memory_order_relaxed);
     }
-    /* Step 4 starts here */
-
-    while (carry)
-    {                                   // If after finishing addition of the two numbers, if there is
-                                        // still carry/leftover then we need to take it into the final
-                                        // sum.
-        finalsum.push_back(carry % 10); // Store digit one by one.
-        carry = carry / 10;             // Reduce carry
-    }
-    /* Step 5 starts here */
-    std::stringstream final_iter;
-    // Since vector pushes value at last, the most significant digits starts at
-    // the end of the vector. Thus print reverse.
-
-    std::copy(finalsum.rbegin(), finalsum.rend(), std::ostream_iterator<int>(final_iter, ""));
-
-    return final_iter.str();
 }
 
 void print_help()
@@ -230,7 +77,9 @@ void print_help()
     cout << " e) --compress or -c, example: --compress y [Use Compression]" << endl;
     cout << " f) --file or -f, example: --file \"intentions.txt\" [File to Read Intentions From]" << endl;
     cout << " g) --file2 or -f2, example: --file2 \"me.jpg\" [File to Read Intentions From]" << endl;
-    cout << " h) --help or -? or /? [This help]" << endl;
+    cout << " h) --codec or -z, example: --codec zstd [Compression Codec: zlib, zstd or lz4]" << endl;
+    cout << " i) --level or -l, example: --level 9 [Compression Level]" << endl;
+    cout << " j) --help or -? or /? [This help]" << endl;
 }
 
 void readFileContents(const std::string &filename,
@@ -269,6 +118,7 @@ int main(int argc, char **argv)
 
     string intention = "", param_intent = "X", param_imem = "X", param_duration = "INFINITY", param_hashing = "X", param_file2 = "X";
     string useHashing, param_compress = "X", useCompression, param_file = "X", intention_display = "", intention_value = "";
+    string param_codec = "X", param_level = "X";
     int numGBToUse = 1;
 
     for (int i = 1; i < argc; i++)
@@ -306,6 +156,14 @@ int main(int argc, char **argv)
         {
             param_file2 = argv[i + 1];
         }
+        else if (!strcmp(argv[i], "-z") || !strcmp(argv[i], "--codec"))
+        {
+            param_codec = argv[i + 1];
+        }
+        else if (!strcmp(argv[i], "-l") || !strcmp(argv[i], "--level"))
+        {
+            param_level = argv[i + 1];
+        }
     }
 
     std::string file_contents_original, file_contents, file_contents2_original, file_contents2, intention_original;
@@ -373,29 +231,20 @@ int main(int argc, char **argv)
     if (intention_original != "" && intention_original != "X")
     {
         // Normalize intention
-        while ((intention.length() + length3) < max_length)
-        {
-            intention += intention_original;
-        }
+        intention = repeat_to_count(intention_original, normalize_copies(max_length, length3));
         intention_display = intention_original;
     }
 
     if (param_file != "X")
     {
         // Normalize file_contents
-        while ((file_contents.length() + length1) < max_length)
-        {
-            file_contents += file_contents_original;
-        }
+        file_contents = repeat_to_count(file_contents_original, normalize_copies(max_length, length1));
         intention_display += "(" + param_file + ")";
     }
     if (param_file2 != "X")
     {
         // Normalize file_contents2
-        while ((file_contents2.length() + length2) < max_length)
-        {
-            file_contents2 += file_contents2_original;
-        }
+        file_contents2 = repeat_to_count(file_contents2_original, normalize_copies(max_length, length2));
         intention_display += "(" + param_file2 + ")";
     }
 
@@ -483,7 +332,7 @@ int main(int argc, char **argv)
     }
 
     std::string intentionMultiplied, intentionHashed = "";
-    long long unsigned int ramSize = 1024 * 1024 * 1024 * numGBToUse / 2, multiplier = 0, hashMultiplier = 0;
+    long long unsigned int ramSize = 1024ULL * 1024 * 1024 * numGBToUse / 2, multiplier = 0, hashMultiplier = 0;
 
     if (!interrupted)
     {
@@ -496,11 +345,8 @@ int main(int argc, char **argv)
 
     if (numGBToUse > 0)
     {
-        while (intentionMultiplied.length() < ramSize)
-        {
-            intentionMultiplied += intention;
-            ++multiplier;
-        }
+        multiplier = copies_to_fill(ramSize, intention.length());
+        intentionMultiplied = repeat_to_count(intention, multiplier);
     }
     else
     {
@@ -511,14 +357,10 @@ int main(int argc, char **argv)
     if (useHashing == "y" || useHashing == "yes")
     {
         intentionHashed = picosha2::hash256_hex_string(intentionMultiplied);
-        intentionMultiplied.clear();
         if (numGBToUse > 0)
         {
-            while (intentionMultiplied.length() < ramSize)
-            {
-                intentionMultiplied += intentionHashed;
-                ++hashMultiplier;
-            }
+            hashMultiplier = copies_to_fill(ramSize, intentionHashed.length());
+            intentionMultiplied = repeat_to_count(intentionHashed, hashMultiplier);
         }
         else
         {
@@ -533,39 +375,43 @@ int main(int argc, char **argv)
 
     if (useCompression == "y" || useCompression == "yes")
     {
-        intentionMultiplied = compressMessage(intentionMultiplied);
+        CompressionCodec codec = get_compression_codec(param_codec);
+        intentionMultiplied = compressMessage(intentionMultiplied, codec, get_compression_level(codec, param_level));
     }
 
+    shared_ptr<const string> sharedIntention = make_shared<const string>(move(intentionMultiplied));
+
     for (int i = 0; i < NUM_THREADS; ++i)
     {
-        threads[i] = thread(ProcessIntention, i, intentionMultiplied);
+        threads[i] = thread(ProcessIntention, i, sharedIntention);
     }
 
-    unsigned long long freq = 0, seconds = 0;
-    string totalIterations = "0", totalFreq = "0";
+    unsigned long long freq = 0, seconds = 0, lastIterations = 0;
+    auto nextTick = chrono::steady_clock::now();
+    IterationCounter totalIterations, totalFreq;
 
     while (!interrupted)
     {
-        this_thread::sleep_for(chrono::seconds(1)); // Wait for 1 second
+        nextTick += chrono::seconds(1);
+        this_thread::sleep_until(nextTick); // Wait for 1 second
 
-        for (int i = 0; i < NUM_THREADS; ++i)
-        {
-            freq += freqs[i]; // Sum all frequencies
-            freqs[i] = 0;     // Reset for the next count
-        }
+        unsigned long long currentIterations = sum_counters(counters, NUM_THREADS);
+        freq = currentIterations - lastIterations;
+        lastIterations = currentIterations;
 
-        totalFreq = MultiplyStrings(to_string(freq), to_string(multiplier));
-        totalFreq = MultiplyStrings(totalFreq, to_string(hashMultiplier));
-        totalIterations = FindSum(totalIterations, totalFreq);
-        int digits = totalIterations.length();
-        int freq_digits = totalFreq.length();
-        freq = 0;
+        totalFreq = freq;
+        totalFreq *= multiplier;
+        totalFreq *= hashMultiplier;
+        totalIterations += totalFreq;
 
-        lock_guard<mutex> lock(io_mutex);
+        string iterationsText = totalIterations.str(), freqText = totalFreq.str();
+        int digits = iterationsText.length();
+        int freq_digits = freqText.length();
+        freq = 0;
 
         cout << "[" << FormatTime(++seconds) << "] "
-             << " (" << DisplaySuffix(totalIterations, digits - 1, "Iterations")
-             << " / " << DisplaySuffix(totalFreq, freq_digits - 1, "Frequency") << "Hz): " << intention_display
+             << " (" << display_suffix(iterationsText, digits - 1, "Iterations")
+             << " / " << display_suffix(freqText, freq_digits - 1, "Frequency") << "Hz): " << intention_display
              << string(5, ' ') << "\r" << flush;
         if (param_duration == FormatTime(seconds))
         {
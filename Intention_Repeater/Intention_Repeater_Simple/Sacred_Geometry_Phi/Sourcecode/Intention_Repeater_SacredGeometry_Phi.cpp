@@ -1,29 +1,33 @@
 /*
 Intention Repeater Simple Sacred Geometry & Phi
 by Anthro Teacher, WebGPT and Claude 3 Opus
-To compile: g++ -O3 -Wall -static Intention_Repeater_Simple.cpp -o Intention_Repeater_Simple.exe -lz
+To compile: cmake -S ../../.. -B build && cmake --build build --target Intention_Repeater_SacredGeometry_Phi
+or: g++ -O3 -Wall -static -std=c++20 -pthread -I../../../Intention_Core/Sourcecode Intention_Repeater_SacredGeometry_Phi.cpp ../../../Intention_Core/Sourcecode/compression.cpp ../../../Intention_Core/Sourcecode/display.cpp ../../../Intention_Core/Sourcecode/repetition.cpp -o Intention_Repeater_SacredGeometry_Phi.exe -lz
 */
 
 #include "picosha2.h"
-#include "zlib.h"
+#include "compression.h"
+#include "display.h"
+#include "iteration_counter.h"
+#include "repetition.h"
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <csignal>
+#include <cstdint>
 #include <cstring>
 #include <iomanip>
 #include <iostream>
 #include <string>
 #include <thread>
 #include <vector>
-#include <unordered_map>
+#include <charconv>
 #include <cmath>
+#include <string_view>
 
 using namespace std;
 using namespace std::chrono;
 
-const int ONE_MINUTE = 60;
-const int ONE_HOUR = 3600;
-
 string VERSION = "v1.6";
 
 std::atomic<bool> interrupted(false);
@@ -36,204 +40,117 @@ void signalHandler(int signum)
 
 const int NODE_COUNT = 13; // Metatron's Cube has 13 circles/nodes
 
-struct Node {
-    std::string data;
-    std::vector<int> connections;
+// Metatron's Cube as a CSR table: the neighbours of node i are
+// METATRON_EDGES[METATRON_EDGE_OFFSETS[i]] up to METATRON_EDGE_OFFSETS[i + 1], in ascending order.
+constexpr int METATRON_EDGE_OFFSETS[NODE_COUNT + 1] = {0, 6, 14, 22, 30, 38, 46, 54, 61, 68, 75, 82, 89, 96};
+constexpr int METATRON_EDGES[] = {
+    1, 2, 3, 4, 5, 6,
+    0, 2, 3, 4, 5, 6, 7, 8,
+    0, 1, 3, 4, 5, 6, 9, 10,
+    0, 1, 2, 4, 5, 6, 11, 12,
+    0, 1, 2, 3, 5, 6, 7, 10,
+    0, 1, 2, 3, 4, 6, 8, 9,
+    0, 1, 2, 3, 4, 5, 11, 12,
+    1, 4, 8, 9, 10, 11, 12,
+    1, 5, 7, 9, 10, 11, 12,
+    2, 5, 7, 8, 10, 11, 12,
+    2, 4, 7, 8, 9, 11, 12,
+    3, 6, 7, 8, 9, 10, 12,
+    3, 6, 7, 8, 9, 10, 11};
+constexpr int METATRON_EDGE_COUNT = sizeof(METATRON_EDGES) / sizeof(METATRON_EDGES[0]);
+static_assert(METATRON_EDGE_COUNT == METATRON_EDGE_OFFSETS[NODE_COUNT], "Every node's neighbours must be in METATRON_EDGES");
+
+// The nodes are consecutive slices of the one intentionMultiplied buffer, so neighbours with
+// consecutive numbers are also one contiguous slice. Each node keeps its neighbours merged
+// into such runs (at most one per edge, same offsets as the edge table), and a turn of the
+// cube only appends those views.
+struct MetatronCube {
+    std::string_view nodes[NODE_COUNT];
+    std::string_view runs[METATRON_EDGE_COUNT];
+    int runEnd[NODE_COUNT];
+    size_t longestNeighbourhood = 0; // Total length of the largest neighbourhood
 };
 
-std::unordered_map<int, Node> createMetatronCube() {
-    std::unordered_map<int, Node> metatronCube;
-    // Initialize nodes
-    for (int i = 0; i < NODE_COUNT; ++i) {
-        metatronCube[i] = {"", {}};
+// Appends length bytes of the endless repetition of unit, starting phase bytes into it.
+// The first copy is rotated into place and the rest doubled from it, so nothing is built twice.
+void appendRepeated(std::string& out, const std::string& unit, size_t phase, size_t length) {
+    size_t start = out.size();
+    size_t first = std::min(length, unit.size() - phase);
+    out.append(unit, phase, first);
+    out.append(unit, 0, std::min(length - first, phase));
+    while (out.size() - start < length) {
+        size_t filled = out.size() - start;
+        out.append(out, start, std::min(filled, length - filled));
     }
-    // Define connections based on Metatron's Cube structure
-    metatronCube[0].connections = {1, 2, 3, 4, 5, 6};
-    metatronCube[1].connections = {0, 2, 3, 4, 5, 6, 7, 8};
-    metatronCube[2].connections = {0, 1, 3, 4, 5, 6, 9, 10};
-    metatronCube[3].connections = {0, 1, 2, 4, 5, 6, 11, 12};
-    metatronCube[4].connections = {0, 1, 2, 3, 5, 6, 7, 10};
-    metatronCube[5].connections = {0, 1, 2, 3, 4, 6, 8, 9};
-    metatronCube[6].connections = {0, 1, 2, 3, 4, 5, 11, 12};
-    metatronCube[7].connections = {1, 4, 8, 9, 10, 11, 12};
-    metatronCube[8].connections = {1, 5, 7, 9, 10, 11, 12};
-    metatronCube[9].connections = {2, 5, 7, 8, 10, 11, 12};
-    metatronCube[10].connections = {2, 4, 7, 8, 9, 11, 12};
-    metatronCube[11].connections = {3, 6, 7, 8, 9, 10, 12};
-    metatronCube[12].connections = {3, 6, 7, 8, 9, 10, 11};
-    // Continue for all nodes...
-    return metatronCube;
 }
 
-void allocateMemoryWithPhi(std::unordered_map<int, Node>& metatronCube, std::string& intentionMultiplied, const std::string& intention, size_t ramSize, size_t& multiplier) {
+// Lays out the 13 phi-sized chunks of the intention repeated to ramSize, back to back. Chunk i
+// starts i * chunkSize bytes into the repetition and stops at its end, exactly as if it were
+// cut out of a copy that was built first. The intention must not be empty.
+void allocateMemoryWithPhi(std::string& intentionMultiplied, const std::string& intention, size_t ramSize, size_t& multiplier) {
     const double phi = (1 + sqrt(5)) / 2; // Golden ratio
-    size_t intentionLength = intention.size();
-    std::string expandedIntention = intention;
-    while (expandedIntention.size() < ramSize) {
-        expandedIntention += intention;
-        multiplier++;
-    }
-
-    size_t totalLength = ramSize;
-    size_t phiIndex = 1;
-    size_t remainingLength = totalLength;
+    const unsigned long long copies = copies_to_fill(ramSize, intention.size());
+    const unsigned long long expandedSize = copies * intention.size();
+    multiplier = copies - 1; // Counts the copies added after the first, as the multiplier always has
 
+    size_t remainingLength = ramSize;
     intentionMultiplied.clear();
+    intentionMultiplied.reserve(ramSize);
 
     for (int i = 0; i < NODE_COUNT; ++i) {
-        size_t chunkSize = static_cast<size_t>(totalLength / pow(phi, phiIndex));
+        size_t chunkSize = static_cast<size_t>(ramSize / pow(phi, i + 1));
         chunkSize = std::min(chunkSize, remainingLength);
-        metatronCube[i].data = expandedIntention.substr(i * chunkSize % expandedIntention.size(), chunkSize);
-        intentionMultiplied += metatronCube[i].data;
+        unsigned long long offset = i * chunkSize % expandedSize;
+        appendRepeated(intentionMultiplied, intention, offset % intention.size(), std::min<unsigned long long>(chunkSize, expandedSize - offset));
         remainingLength -= chunkSize;
-        ++phiIndex;
-    }
-}
-
-void repeatIntentionMetatronCube(std::unordered_map<int, Node>& metatronCube, unsigned long long& freq) {
-    std::string processIntention;
-    for (const auto& [id, node] : metatronCube) {
-        processIntention.clear();
-        for (int connection : node.connections) {
-            processIntention += metatronCube[connection].data;
-        }
-        processIntention += std::to_string(freq);
-        ++freq;
-    }
-}
-
-// Function to compress a string using zlib
-std::string compressMessage(const std::string &message) {
-    z_stream zs;
-    memset(&zs, 0, sizeof(zs));
-
-    if (deflateInit(&zs, Z_DEFAULT_COMPRESSION) != Z_OK) {
-        return ""; // Compression initialization failed
-    }
-
-    zs.next_in = (Bytef *)message.data();
-    zs.avail_in = message.size();
-
-    std::string compressed;
-    char outbuffer[32768]; // Output buffer
-    int ret;
-    do {
-        zs.next_out = reinterpret_cast<Bytef *>(outbuffer);
-        zs.avail_out = sizeof(outbuffer);
-
-        ret = deflate(&zs, Z_FINISH);
-
-        if (compressed.size() < zs.total_out) {
-            compressed.append(outbuffer, zs.total_out - compressed.size());
-        }
-    } while (ret == Z_OK);
-
-    deflateEnd(&zs);
-
-    if (ret != Z_STREAM_END) {
-        return ""; // Compression failed
     }
-
-    return compressed;
-}
-
-string FormatTime(long long seconds)
-{
-    int hours = seconds / ONE_HOUR;
-    int minutes = (seconds % ONE_HOUR) / ONE_MINUTE;
-    int secs = seconds % ONE_MINUTE;
-
-    ostringstream oss;
-    oss << setw(2) << setfill('0') << hours << ":" << setw(2) << setfill('0')
-        << minutes << ":" << setw(2) << setfill('0') << secs;
-
-    return oss.str();
 }
 
-// Function to update Metatron's Cube with intentionMultiplied
-void updateMetatronCubeWithIntention(std::unordered_map<int, Node>& metatronCube, const std::string& intentionMultiplied) {
-    size_t chunkSize = intentionMultiplied.size() / NODE_COUNT;
-    size_t remainder = intentionMultiplied.size() % NODE_COUNT;
+// Splits intentionMultiplied evenly over the nodes and merges each node's neighbours into runs.
+void updateMetatronCubeWithIntention(MetatronCube& metatronCube, const std::string& intentionMultiplied) {
+    std::string_view buffer(intentionMultiplied);
+    size_t chunkSize = buffer.size() / NODE_COUNT;
+    size_t remainder = buffer.size() % NODE_COUNT;
 
     size_t offset = 0;
     for (int i = 0; i < NODE_COUNT; ++i) {
-        size_t currentChunkSize = chunkSize + (i < remainder ? 1 : 0);
-        metatronCube[i].data = intentionMultiplied.substr(offset, currentChunkSize);
+        size_t currentChunkSize = chunkSize + (static_cast<size_t>(i) < remainder ? 1 : 0);
+        metatronCube.nodes[i] = buffer.substr(offset, currentChunkSize);
         offset += currentChunkSize;
     }
-}
-
-string MultiplyStrings(const string &num1, const string &num2)
-{
-    int len1 = num1.size();
-    int len2 = num2.size();
-    vector<int> result(len1 + len2, 0);
-
-    for (int i = len1 - 1; i >= 0; --i)
-    {
-        for (int j = len2 - 1; j >= 0; --j)
-        {
-            int mul = (num1[i] - '0') * (num2[j] - '0');
-            int sum = mul + result[i + j + 1];
-
-            result[i + j + 1] = sum % 10;
-            result[i + j] += sum / 10;
-        }
-    }
 
-    string resultStr;
-    for (int num : result)
-    {
-        if (!(resultStr.empty() && num == 0))
-        {
-            resultStr.push_back(num + '0');
+    metatronCube.longestNeighbourhood = 0;
+    for (int i = 0; i < NODE_COUNT; ++i) {
+        int run = METATRON_EDGE_OFFSETS[i];
+        size_t neighbourhood = 0;
+        for (int edge = METATRON_EDGE_OFFSETS[i]; edge < METATRON_EDGE_OFFSETS[i + 1]; ++edge) {
+            const std::string_view& node = metatronCube.nodes[METATRON_EDGES[edge]];
+            if (edge > METATRON_EDGE_OFFSETS[i] && METATRON_EDGES[edge] == METATRON_EDGES[edge - 1] + 1) {
+                std::string_view& last = metatronCube.runs[run - 1];
+                last = std::string_view(last.data(), last.size() + node.size());
+            } else {
+                metatronCube.runs[run++] = node;
+            }
+            neighbourhood += node.size();
         }
+        metatronCube.runEnd[i] = run;
+        metatronCube.longestNeighbourhood = std::max(metatronCube.longestNeighbourhood, neighbourhood);
     }
-
-    return resultStr.empty() ? "0" : resultStr;
-}
-
-string DisplaySuffix(const string &num, int power, const string &designator)
-{
-    const string suffixArray =
-        designator == "Iterations" ? " kMBTqQsSOND" : " kMGTPEZYR";
-    size_t index = power / 3;
-    char suffix = index < suffixArray.length() ? suffixArray[index] : ' ';
-    string result = num.substr(0, power % 3 + 1) + "." +
-                    num.substr(power % 3 + 1, 3) + suffix;
-    return result;
 }
 
-string FindSum(const string &a, const string &b)
-{
-    string result;
-    int carry = 0;
-
-    int i = a.size() - 1;
-    int j = b.size() - 1;
-
-    while (i >= 0 || j >= 0 || carry > 0)
-    {
-        int sum = carry;
-
-        if (i >= 0)
-        {
-            sum += a[i] - '0';
-            --i;
-        }
-
-        if (j >= 0)
-        {
-            sum += b[j] - '0';
-            --j;
+// One turn of the cube: every node repeats its neighbours and the running frequency.
+// processIntention is reserved for the longest neighbourhood, so this never allocates.
+void repeatIntentionMetatronCube(const MetatronCube& metatronCube, std::string& processIntention, unsigned long long& freq) {
+    char digits[24];
+    for (int i = 0; i < NODE_COUNT; ++i) {
+        processIntention.clear();
+        for (int run = METATRON_EDGE_OFFSETS[i]; run < metatronCube.runEnd[i]; ++run) {
+            processIntention.append(metatronCube.runs[run]);
         }
-
-        result.push_back(sum % 10 + '0');
-        carry = sum / 10;
+        char *end = std::to_chars(digits, digits + sizeof(digits), freq).ptr;
+        processIntention.append(digits, end - digits);
+        ++freq;
     }
-
-    reverse(result.begin(), result.end());
-    return result;
 }
 
 void print_help()
@@ -261,7 +178,12 @@ void print_help()
     std::cout << " g) --file2 or -f2, example: --file2 \"me.jpg\" [File to "
                  "Read Intentions From]"
               << endl;
-    std::cout << " h) --help or -? or /? [This help]" << endl;
+    std::cout << " h) --codec or -z, example: --codec zstd [Compression Codec: "
+                 "zlib, zstd or lz4]"
+              << endl;
+    std::cout << " i) --level or -l, example: --level 9 [Compression Level]"
+              << endl;
+    std::cout << " j) --help or -? or /? [This help]" << endl;
 }
 
 void readFileContents(const std::string &filename,
@@ -294,7 +216,8 @@ int main(int argc, char **argv)
     string intention = "", intention_display = "", param_intent = "X",
            param_imem = "X", param_duration = "INFINITY", param_file = "X";
     string param_hashing = "X", useHashing, param_compress = "X", useCompression,
-           processIntention, intention_value="", param_file2="X";
+           processIntention, intention_value="", param_file2="X", param_codec="X",
+           param_level="X";
     int numGBToUse = 1;
 
     for (int i = 1; i < argc; i++)
@@ -333,6 +256,14 @@ int main(int argc, char **argv)
         {
             param_file2 = argv[i + 1];
         }
+        else if (!strcmp(argv[i], "-z") || !strcmp(argv[i], "--codec"))
+        {
+            param_codec = argv[i + 1];
+        }
+        else if (!strcmp(argv[i], "-l") || !strcmp(argv[i], "--level"))
+        {
+            param_level = argv[i + 1];
+        }
     }
 
     std::cout << "Intention Repeater Simple Sacred Geometry & Phi " << VERSION << endl;
@@ -405,34 +336,31 @@ int main(int argc, char **argv)
     if (intention_original != "" && intention_original != "X")
     {
         // Normalize intention
-        while ((intention.length() + length3) < max_length)
-        {
-            intention += intention_original;
-        }
+        intention = repeat_to_count(intention_original, normalize_copies(max_length, length3));
         intention_display = intention_original;
     }
 
     if (param_file != "X")
     {
         // Normalize file_contents
-        while ((file_contents.length() + length1) < max_length)
-        {
-            file_contents += file_contents_original;
-        }
+        file_contents = repeat_to_count(file_contents_original, normalize_copies(max_length, length1));
         intention_display += "(" + param_file + ")";
     }
     if (param_file2 != "X")
     {
         // Normalize file_contents2
-        while ((file_contents2.length() + length2) < max_length)
-        {
-            file_contents2 += file_contents2_original;
-        }
+        file_contents2 = repeat_to_count(file_contents2_original, normalize_copies(max_length, length2));
         intention_display += "(" + param_file2 + ")";
     }
 
     intention += file_contents + file_contents2;
 
+    if (intention.empty())
+    {
+        std::cerr << "Nothing to repeat: the intention and files are empty" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
     if (!interrupted)
     {
         if (param_imem == "X")
@@ -527,44 +455,26 @@ int main(int argc, char **argv)
         return 0;
     }
 
-    std::unordered_map<int, Node> metatronCube = createMetatronCube();
-
-    intentionMultiplied = intention;
-    
-    size_t phiIndex = 1;
+    MetatronCube metatronCube;
 
     if (numGBToUse > 0)
     {
-        allocateMemoryWithPhi(metatronCube, intentionMultiplied, intention, ramSize, multiplier);
-        /*
-        while (intentionMultiplied.length() < ramSize)
-        {
-            size_t chunkSize = static_cast<size_t>(ramSize / pow(phi, phiIndex));
-            intentionMultiplied += intention.substr(0, chunkSize % intention.size());
-            ++multiplier;
-            ++phiIndex
-        }
-        */
+        allocateMemoryWithPhi(intentionMultiplied, intention, ramSize, multiplier);
     }
     else
     {
         intentionMultiplied = intention;
         multiplier = 1;
-        phiIndex = 1;
     }
 
     if (useHashing == "y" || useHashing == "yes")
     {
         intentionHashed = picosha2::hash256_hex_string(intentionMultiplied);
         
-        intentionMultiplied.clear();
         if (numGBToUse > 0)
         {
-            while (intentionMultiplied.length() < ramSize)
-            {
-                intentionMultiplied += intentionHashed;
-                ++hashMultiplier;
-            }
+            hashMultiplier = copies_to_fill(ramSize, intentionHashed.length());
+            intentionMultiplied = repeat_to_count(intentionHashed, hashMultiplier);
         }
         else
         {
@@ -575,16 +485,16 @@ int main(int argc, char **argv)
 
     if (useCompression == "y" || useCompression == "yes")
     {
-        intentionMultiplied = compressMessage(intentionMultiplied);
+        CompressionCodec codec = get_compression_codec(param_codec);
+        intentionMultiplied = compressMessage(intentionMultiplied, codec, get_compression_level(codec, param_level));
     }
 
     // Update metatronCube with the processed intentionMultiplied
     updateMetatronCubeWithIntention(metatronCube, intentionMultiplied);
 
-    //processIntention.reserve(intentionMultiplied.size() +
-    //                         20); // Adjust based on expected size
+    processIntention.reserve(metatronCube.longestNeighbourhood + 20);
 
-    string totalIterations = "0", totalFreq = "0";
+    IterationCounter totalIterations, totalFreq;
     unsigned long long freq = 0, seconds = 0;
 
     while (!interrupted)
@@ -593,31 +503,24 @@ int main(int argc, char **argv)
         auto end = start + chrono::seconds(1);
         while (high_resolution_clock::now() < end)
         {
-            repeatIntentionMetatronCube(metatronCube, freq);
-            /*
-            // Clear previous value and reuse the allocated space
-            processIntention.clear();
-            // Append the fixed part and the changing part
-            processIntention.append(intentionMultiplied);
-            processIntention.append(to_string(freq));
-            
-            freq++;
-            */
+            repeatIntentionMetatronCube(metatronCube, processIntention, freq);
         }
 
-        totalFreq = MultiplyStrings(to_string(freq), to_string(multiplier));
-        totalFreq = MultiplyStrings(totalFreq, to_string(hashMultiplier));
-        totalIterations = FindSum(totalIterations, totalFreq);
+        totalFreq = freq;
+        totalFreq *= multiplier;
+        totalFreq *= hashMultiplier;
+        totalIterations += totalFreq;
 
-        int digits = totalIterations.length();
-        int freqDigits = totalFreq.length();
+        string iterationsText = totalIterations.str(), freqText = totalFreq.str();
+        int digits = iterationsText.length();
+        int freqDigits = freqText.length();
         ++seconds;
         freq = 0;
 
         std::cout << "[" + FormatTime(seconds) + "] Repeating:"
                   << " ("
-                  << DisplaySuffix(totalIterations, digits - 1, "Iterations")
-                  << " / " << DisplaySuffix(totalFreq, freqDigits - 1, "Frequency")
+                  << display_suffix(iterationsText, digits - 1, "Iterations")
+                  << " / " << display_suffix(freqText, freqDigits - 1, "Frequency")
                   << "Hz): " << intention_display << string(5, ' ') << "\r"
                   << flush;
         if (param_duration == FormatTime(seconds))
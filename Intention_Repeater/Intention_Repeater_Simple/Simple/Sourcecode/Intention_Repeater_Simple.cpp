@@ -1,14 +1,21 @@
 /*
 Intention Repeater Simple
 by Anthro Teacher, WebGPT and Claude 3 Opus
-To compile: g++ -O3 -Wall -static Intention_Repeater_Simple.cpp -o Intention_Repeater_Simple.exe -lz
+To compile: cmake -S ../../.. -B build && cmake --build build --target Intention_Repeater_Simple
+or: g++ -O3 -Wall -static -std=c++20 -pthread -I../../../Intention_Core/Sourcecode Intention_Repeater_Simple.cpp ../../../Intention_Core/Sourcecode/compression.cpp ../../../Intention_Core/Sourcecode/display.cpp ../../../Intention_Core/Sourcecode/repetition.cpp -o Intention_Repeater_Simple.exe -lz
 */
 
 #include "picosha2.h"
-#include "zlib.h"
+#include "compression.h"
+#include "display.h"
+#include "iteration_counter.h"
+#include "repetition.h"
+
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <csignal>
+#include <cstdint>
 #include <cstring>
 #include <iomanip>
 #include <iostream>
@@ -19,9 +26,6 @@ To compile: g++ -O3 -Wall -static Intention_Repeater_Simple.cpp -o Intention_Rep
 using namespace std;
 using namespace std::chrono;
 
-const int ONE_MINUTE = 60;
-const int ONE_HOUR = 3600;
-
 string VERSION = "v1.6";
 
 std::atomic<bool> interrupted(false);
@@ -32,131 +36,6 @@ void signalHandler(int signum)
     interrupted.store(true);
 }
 
-std::string compressMessage(const std::string &message)
-{
-    z_stream zs;
-    memset(&zs, 0, sizeof(zs));
-
-    if (deflateInit(&zs, Z_DEFAULT_COMPRESSION) != Z_OK)
-    {
-        return ""; // Compression initialization failed
-    }
-
-    zs.next_in = (Bytef *)message.data();
-    zs.avail_in = message.size();
-
-    std::string compressed;
-    char outbuffer[32768]; // Output buffer
-    int ret;
-    do
-    {
-        zs.next_out = reinterpret_cast<Bytef *>(outbuffer);
-        zs.avail_out = sizeof(outbuffer);
-
-        ret = deflate(&zs, Z_FINISH);
-
-        if (compressed.size() < zs.total_out)
-        {
-            compressed.append(outbuffer, zs.total_out - compressed.size());
-        }
-    } while (ret == Z_OK);
-
-    deflateEnd(&zs);
-
-    if (ret != Z_STREAM_END)
-    {
-        return ""; // Compression failed
-    }
-
-    return compressed;
-}
-
-string FormatTime(long long seconds)
-{
-    int hours = seconds / ONE_HOUR;
-    int minutes = (seconds % ONE_HOUR) / ONE_MINUTE;
-    int secs = seconds % ONE_MINUTE;
-
-    ostringstream oss;
-    oss << setw(2) << setfill('0') << hours << ":" << setw(2) << setfill('0')
-        << minutes << ":" << setw(2) << setfill('0') << secs;
-
-    return oss.str();
-}
-
-string MultiplyStrings(const string &num1, const string &num2)
-{
-    int len1 = num1.size();
-    int len2 = num2.size();
-    vector<int> result(len1 + len2, 0);
-
-    for (int i = len1 - 1; i >= 0; --i)
-    {
-        for (int j = len2 - 1; j >= 0; --j)
-        {
-            int mul = (num1[i] - '0') * (num2[j] - '0');
-            int sum = mul + result[i + j + 1];
-
-            result[i + j + 1] = sum % 10;
-            result[i + j] += sum / 10;
-        }
-    }
-
-    string resultStr;
-    for (int num : result)
-    {
-        if (!(resultStr.empty() && num == 0))
-        {
-            resultStr.push_back(num + '0');
-        }
-    }
-
-    return resultStr.empty() ? "0" : resultStr;
-}
-
-string DisplaySuffix(const string &num, int power, const string &designator)
-{
-    const string suffixArray =
-        designator == "Iterations" ? " kMBTqQsSOND" : " kMGTPEZYR";
-    size_t index = power / 3;
-    char suffix = index < suffixArray.length() ? suffixArray[index] : ' ';
-    string result = num.substr(0, power % 3 + 1) + "." +
-                    num.substr(power % 3 + 1, 3) + suffix;
-    return result;
-}
-
-string FindSum(const string &a, const string &b)
-{
-    string result;
-    int carry = 0;
-
-    int i = a.size() - 1;
-    int j = b.size() - 1;
-
-    while (i >= 0 || j >= 0 || carry > 0)
-    {
-        int sum = carry;
-
-        if (i >= 0)
-        {
-            sum += a[i] - '0';
-            --i;
-        }
-
-        if (j >= 0)
-        {
-            sum += b[j] - '0';
-            --j;
-        }
-
-        result.push_back(sum % 10 + '0');
-        carry = sum / 10;
-    }
-
-    reverse(result.begin(), result.end());
-    return result;
-}
-
 void print_help()
 {
     std::cout << "Intention Repeater Simple " << VERSION << " by Anthro Teacher."
@@ -182,7 +61,12 @@ void print_help()
     std::cout << " g) --file2 or -f2, example: --file2 \"me.jpg\" [File to "
                  "Read Intentions From]"
               << endl;
-    std::cout << " h) --help or -? or /? [This help]" << endl;
+    std::cout << " h) --codec or -z, example: --codec zstd [Compression Codec: "
+                 "zlib, zstd or lz4]"
+              << endl;
+    std::cout << " i) --level or -l, example: --level 9 [Compression Level]"
+              << endl;
+    std::cout << " j) --help or -? or /? [This help]" << endl;
 }
 
 void readFileContents(const std::string &filename,
@@ -215,7 +99,8 @@ int main(int argc, char **argv)
     string intention = "", intention_display = "", param_intent = "X",
            param_imem = "X", param_duration = "INFINITY", param_file = "X";
     string param_hashing = "X", useHashing, param_compress = "X", useCompression,
-           processIntention, intention_value="", param_file2="X";
+           processIntention, intention_value="", param_file2="X", param_codec="X",
+           param_level="X";
     int numGBToUse = 1;
 
     for (int i = 1; i < argc; i++)
@@ -254,6 +139,14 @@ int main(int argc, char **argv)
         {
             param_file2 = argv[i + 1];
         }
+        else if (!strcmp(argv[i], "-z") || !strcmp(argv[i], "--codec"))
+        {
+            param_codec = argv[i + 1];
+        }
+        else if (!strcmp(argv[i], "-l") || !strcmp(argv[i], "--level"))
+        {
+            param_level = argv[i + 1];
+        }
     }
 
     std::cout << "Intention Repeater Simple " << VERSION << endl;
@@ -324,29 +217,20 @@ int main(int argc, char **argv)
     if (intention_original != "" && intention_original != "X")
     {
         // Normalize intention
-        while ((intention.length() + length3) < max_length)
-        {
-            intention += intention_original;
-        }
+        intention = repeat_to_count(intention_original, normalize_copies(max_length, length3));
         intention_display = intention_original;
     }
 
     if (param_file != "X")
     {
         // Normalize file_contents
-        while ((file_contents.length() + length1) < max_length)
-        {
-            file_contents += file_contents_original;
-        }
+        file_contents = repeat_to_count(file_contents_original, normalize_copies(max_length, length1));
         intention_display += "(" + param_file + ")";
     }
     if (param_file2 != "X")
     {
         // Normalize file_contents2
-        while ((file_contents2.length() + length2) < max_length)
-        {
-            file_contents2 += file_contents2_original;
-        }
+        file_contents2 = repeat_to_count(file_contents2_original, normalize_copies(max_length, length2));
         intention_display += "(" + param_file2 + ")";
     }
 
@@ -448,11 +332,8 @@ int main(int argc, char **argv)
 
     if (numGBToUse > 0)
     {
-        while (intentionMultiplied.length() < ramSize)
-        {
-            intentionMultiplied += intention;
-            ++multiplier;
-        }
+        multiplier = copies_to_fill(ramSize, intention.length());
+        intentionMultiplied = repeat_to_count(intention, multiplier);
     }
     else
     {
@@ -463,14 +344,10 @@ int main(int argc, char **argv)
     if (useHashing == "y" || useHashing == "yes")
     {
         intentionHashed = picosha2::hash256_hex_string(intentionMultiplied);
-        intentionMultiplied.clear();
         if (numGBToUse > 0)
         {
-            while (intentionMultiplied.length() < ramSize)
-            {
-                intentionMultiplied += intentionHashed;
-                ++hashMultiplier;
-            }
+            hashMultiplier = copies_to_fill(ramSize, intentionHashed.length());
+            intentionMultiplied = repeat_to_count(intentionHashed, hashMultiplier);
         }
         else
         {
@@ -481,13 +358,14 @@ int main(int argc, char **argv)
 
     if (useCompression == "y" || useCompression == "yes")
     {
-        intentionMultiplied = compressMessage(intentionMultiplied);
+        CompressionCodec codec = get_compression_codec(param_codec);
+        intentionMultiplied = compressMessage(intentionMultiplied, codec, get_compression_level(codec, param_level));
     }
 
     processIntention.reserve(intentionMultiplied.size() +
                              20); // Adjust based on expected size
 
-    string totalIterations = "0", totalFreq = "0";
+    IterationCounter totalIterations, totalFreq;
     unsigned long long freq = 0, seconds = 0;
 
     while (!interrupted)
@@ -504,19 +382,21 @@ int main(int argc, char **argv)
             freq++;
         }
 
-        totalFreq = MultiplyStrings(to_string(freq), to_string(multiplier));
-        totalFreq = MultiplyStrings(totalFreq, to_string(hashMultiplier));
-        totalIterations = FindSum(totalIterations, totalFreq);
+        totalFreq = freq;
+        totalFreq *= multiplier;
+        totalFreq *= hashMultiplier;
+        totalIterations += totalFreq;
 
-        int digits = totalIterations.length();
-        int freqDigits = totalFreq.length();
+        string iterationsText = totalIterations.str(), freqText = totalFreq.str();
+        int digits = iterationsText.length();
+        int freqDigits = freqText.length();
         ++seconds;
         freq = 0;
 
         std::cout << "[" + FormatTime(seconds) + "] Repeating:"
                   << " ("
-                  << DisplaySuffix(totalIterations, digits - 1, "Iterations")
-                  << " / " << DisplaySuffix(totalFreq, freqDigits - 1, "Frequency")
+                  << display_suffix(iterationsText, digits - 1, "Iterations")
+                  << " / " << display_suffix(freqText, freqDigits - 1, "Frequency")
                   << "Hz): " << intention_display << string(5, ' ') << "\r"
                   << flush;
         if (param_duration == FormatTime(seconds))
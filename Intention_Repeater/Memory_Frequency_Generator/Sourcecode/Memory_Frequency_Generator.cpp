@@ -15,11 +15,12 @@ Created: 4/26/2024
 #include <algorithm>
 #include <cctype>
 #include <regex>
+#include "frame_writer.h"
 
 const double PI = 3.14159265358979323846;
 const std::string VERSION = "v1.4";
 
-void writeWAVFileChunk(const std::string &filename, const std::vector<double> &waveformChunk, double sampleRate, int numChannels, int bitsPerSample)
+void writeWAVFileChunk(const std::string &filename, const std::vector<float> &waveformChunk, double sampleRate, int numChannels, int bitsPerSample)
 {
     std::ofstream file(filename, std::ios::binary);
     if (!file)
@@ -53,69 +54,112 @@ void writeWAVFileChunk(const std::string &filename, const std::vector<double> &w
     file.write(reinterpret_cast<const char *>(&dataChunkSize), 4);
 
     // Write waveform data
-    for (double sample : waveformChunk)
+    FrameWriter frameWriter(file);
+    for (float sample : waveformChunk)
     {
-        float sampleFloat = static_cast<float>(sample);
-        file.write(reinterpret_cast<const char *>(&sampleFloat), sizeof(float));
+        frameWriter.put(sample);
     }
+    frameWriter.finish();
 }
 
-void generateSquareWave(std::vector<double> &waveform, double frequency, double sampleRate, int numSamples)
+// Phase-coherent oscillator. The phase is kept in cycles as a double, so it never drifts however long the generator runs,
+// and each chunk is shaped in float with branch-free loops the compiler can vectorize.
+class Oscillator
 {
-    std::vector<double> squareWave(numSamples);
-    double timeStep = 1.0 / sampleRate;
-    double period = 1.0 / frequency;
-    double dutyCycle = 0.5; // 50% duty cycle (square wave)
+public:
+    static constexpr size_t chunkSize = 4096;
 
-    for (int i = 0; i < numSamples; i++)
+    Oscillator(std::string waveformType, double frequency, double sampleRate)
+        : step(frequency / sampleRate)
     {
-        double time = i * timeStep;
-        double value = std::fmod(time, period) < dutyCycle * period ? 1.0 : -1.0;
-        waveform[i] = value * 0.9; // scale to [-0.9, 0.9]
+        std::transform(waveformType.begin(), waveformType.end(), waveformType.begin(), ::toupper);
+        shape = waveformType == "SQUARE" ? Shape::Square : waveformType == "TRIANGLE" ? Shape::Triangle : Shape::Sine;
     }
-}
-
-void generateTriangleWave(std::vector<double> &waveform, double frequency, double sampleRate, int numSamples)
-{
-    double timeStep = 1.0 / sampleRate;
-    double period = 1.0 / frequency;
-    double dbToLinear = std::pow(10.0, -8.627 / 20.0); // convert dB to linear scale
 
-    // calculate the mean value of the triangle wave
-    double sum = 0.0;
-    for (int i = 0; i < numSamples; i++)
+    // Renders the next count (up to chunkSize) samples into output and advances the phase past them
+    void render(float *output, size_t count)
     {
-        double time = i * timeStep;
-        double value = std::fmod(time, period);
-        value = 2.0 * (value / period) - 1.0; // scale to [-1, 1]
-        value = 4.0 * std::abs(value) - 1.0;  // triangle wave
-        sum += dbToLinear * 0.9 * value;
+        float cycle[chunkSize];
+        for (size_t i = 0; i < count; ++i)
+        {
+            // position is positive and small, so truncating to int is a floor that vectorizes without SSE4.1
+            const double position = phase + static_cast<double>(i) * step;
+            cycle[i] = static_cast<float>(position - static_cast<double>(static_cast<int32_t>(position)));
+        }
+        switch (shape)
+        {
+        case Shape::Square:
+            for (size_t i = 0; i < count; ++i)
+            {
+                output[i] = cycle[i] < 0.5f ? 0.9f : -0.9f;
+            }
+            break;
+        case Shape::Triangle:
+            for (size_t i = 0; i < count; ++i)
+            {
+                output[i] = triangleScale * (4.0f * std::fabs(2.0f * cycle[i] - 1.0f) - 2.0f);
+            }
+            break;
+        default:
+            for (size_t i = 0; i < count; ++i)
+            {
+                output[i] = 0.9f * sineOfCycle(cycle[i]);
+            }
+            break;
+        }
+        phase += static_cast<double>(count) * step;
+        phase -= std::floor(phase);
     }
-    double meanValue = sum / numSamples;
 
-    // generate the triangle wave with the mean value subtracted
-    for (int i = 0; i < numSamples; i++)
+private:
+    enum class Shape
+    {
+        Sine,
+        Square,
+        Triangle
+    };
+
+    // -8.627 dB (10^(-8.627/20)) at 90%. 4|2x-1|-1 averages exactly 1 over a cycle, so subtracting 1 centres it without a second pass
+    static constexpr float triangleScale = 0.9f * 0.3703821f;
+
+    // sin(2*pi*x) for x in [0, 1): folded onto [0, pi/2] and evaluated with an odd polynomial, accurate to float precision
+    static inline float sineOfCycle(float x)
     {
-        double time = i * timeStep;
-        double value = std::fmod(time, period);
-        value = 2.0 * (value / period) - 1.0; // scale to [-1, 1]
-        value = 4.0 * std::abs(value) - 1.0;  // triangle wave
-        waveform[i] = dbToLinear * 0.9 * value - meanValue;
+        const float u = 2.0f * x - 1.0f;
+        const float folded = std::min(std::fabs(u), 1.0f - std::fabs(u));
+        const float r = 3.14159265f * folded;
+        const float r2 = r * r;
+        const float sine = r * (1.0f + r2 * (-1.0f / 6.0f + r2 * (1.0f / 120.0f + r2 * (-1.0f / 5040.0f + r2 * (1.0f / 362880.0f + r2 * (-1.0f / 39916800.0f))))));
+        return u < 0.0f ? sine : -sine;
     }
-}
 
-// Generate a sine wave
-void generateSineWave(std::vector<double> &waveform, double frequency, double sampleRate, int numSamples)
+    Shape shape;
+    double step;
+    double phase = 0.0;
+};
+
+// Holds the most recent samples of one generator. Chunks are written at writeIndex and wrap around, so the buffer is always one
+// continuous stretch of the waveform that ends just before writeIndex.
+struct WaveformRing
 {
-    double angularFrequency = 2 * PI * frequency;
+    std::vector<float> samples;
+    size_t writeIndex = 0;
+    bool wrapped = false;
+
+    explicit WaveformRing(size_t size) : samples(size) {}
 
-    for (int i = 0; i < numSamples; ++i)
+    // Copy of everything written so far, oldest sample first
+    std::vector<float> ordered() const
     {
-        double t = i / sampleRate;
-        double value = std::sin(angularFrequency * t) * 0.9;
-        waveform[i] = value;
+        if (!wrapped)
+        {
+            return std::vector<float>(samples.begin(), samples.begin() + writeIndex);
+        }
+        std::vector<float> result(samples.begin() + writeIndex, samples.end());
+        result.insert(result.end(), samples.begin(), samples.begin() + writeIndex);
+        return result;
     }
-}
+};
 
 int computeSampleRate(double frequency)
 {
@@ -136,29 +180,20 @@ int computeSampleRate(double frequency)
     return sampleRate;
 }
 
-void generateWaveform(std::vector<double> &waveform, double frequency, double sampleRate, int bufferSize, std::atomic<bool> &quit, std::string waveformType)
+void generateWaveform(WaveformRing &ring, double frequency, double sampleRate, std::atomic<bool> &quit, std::string waveformType)
 {
-    int index = 0;
-
-    // Convert waveform type to uppercase
-    std::transform(waveformType.begin(), waveformType.end(), waveformType.begin(), ::toupper);
+    Oscillator oscillator(waveformType, frequency, sampleRate);
 
     while (!quit)
     {
-        if (waveformType == "SQUARE")
-        {
-            generateSquareWave(waveform, frequency, sampleRate, bufferSize);
-        }
-        else if (waveformType == "TRIANGLE")
+        const size_t count = std::min(Oscillator::chunkSize, ring.samples.size() - ring.writeIndex);
+        oscillator.render(ring.samples.data() + ring.writeIndex, count);
+        ring.writeIndex += count;
+        if (ring.writeIndex == ring.samples.size())
         {
-            generateTriangleWave(waveform, frequency, sampleRate, bufferSize);
+            ring.writeIndex = 0;
+            ring.wrapped = true;
         }
-        else
-        {
-            generateSineWave(waveform, frequency, sampleRate, bufferSize);
-        }
-
-        index = (index + bufferSize) % waveform.size();
     }
 }
 
@@ -202,7 +237,7 @@ int main()
 
     double sampleRate = computeSampleRate(frequency);
 
-    std::vector<std::vector<double>> waveforms(numGenerators, std::vector<double>(bufferSize));
+    std::vector<WaveformRing> waveforms(numGenerators, WaveformRing(bufferSize));
     std::vector<std::thread> threads;
     std::atomic<bool> quit(false);
 
@@ -210,7 +245,7 @@ int main()
 
     for (int i = 0; i < numGenerators; ++i)
     {
-        threads.emplace_back(generateWaveform, std::ref(waveforms[i]), frequency, sampleRate, bufferSize, std::ref(quit), waveformType);
+        threads.emplace_back(generateWaveform, std::ref(waveforms[i]), frequency, sampleRate, std::ref(quit), waveformType);
     }
 
     std::cout << "Waveforms are being repeated in memory. Press 'q' and Enter to quit." << std::endl;
@@ -234,7 +269,7 @@ int main()
 
     // Write the waveform from the first generator to the WAV file
     std::string fileName = strFrequency + "Hz_" + waveformType + ".wav";
-    writeWAVFileChunk(fileName, waveforms[0], sampleRate, 1, 32);
+    writeWAVFileChunk(fileName, waveforms[0].ordered(), sampleRate, 1, 32);
     std::cout << "Waveform written to " << fileName << std::endl;
 
     return 0;
@@ -1,7 +1,8 @@
 /*
 Multi-Format to WAV Repeater with Smoothing
 by Anthro Teacher and Nathan
-To Compile: g++ -O3 -Wall -static Multi-Format_to_WAV_Repeater_Smoothing.cpp -o Multi-Format_to_WAV_Repeater_Smoothing.exe -std=c++20
+To Compile: cmake -S ../.. -B build && cmake --build build --target Multi-Format_to_WAV_Repeater_Smoothing
+or: g++ -O3 -Wall -static -std=c++20 -pthread -I../../Intention_Core/Sourcecode Multi-Format_to_WAV_Repeater_Smoothing.cpp ../../Intention_Core/Sourcecode/display.cpp ../../Intention_Core/Sourcecode/frame_writer.cpp ../../Intention_Core/Sourcecode/wav_header.cpp -o Multi-Format_to_WAV_Repeater_Smoothing.exe
 */
 
 #include <iostream>
@@ -14,66 +15,53 @@ To Compile: g++ -O3 -Wall -static Multi-Format_to_WAV_Repeater_Smoothing.cpp -o
 #include <array>
 #include <string>
 #include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <iomanip>
+#include <chrono>
 #include <algorithm>
 #include <climits>
 #include <sstream>
+#include "display.h"
+#include "frame_writer.h"
+#include "wav_header.h"
 using namespace std;
 using namespace filesystem;
-#ifdef _WIN64
-#define BYTEALIGNMENTFORWAVPRODUCER 8
-#else
-#define BYTEALIGNMENTFORWAVPRODUCER 4
-#endif
 #include <bit>
 
 std::string VERSION = "v2.4";
 namespace fs = std::filesystem;
 
 /// ////////////////////////////////////////////START OF RIFF WAVE TAG ///////////////////////////////////////////////////////////////////////////
-const uint32_t headerChunkSize = 0; /// PLACE HOLDER FOR RIFF HEADER CHUNK SIZE
+thread_local bool useRF64 = false;                                    /// SET BY createWavFile FROM THE PROJECTED DATA SIZE BEFORE ANY HEADER IS WRITTEN
 /// /////////FORMAT CHUNK////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// THE RENDER SETTINGS BELOW ARE thread_local: BATCH MODE RENDERS EVERY JOB ON ITS OWN THREAD, AND EACH JOB ONLY SEES ITS OWN COPY
 uint16_t audioFormat = 1;   /// 3 is float 1 is PCM                            /// AN UNKNOWN AT THIS TIME
-uint16_t numChannels = 0;   /// 8;                                                     /// NUMBER OF CHANNELS FOR OUR AUDIO I PRESUME 1 SAMPLE PER CHANNEL
-uint32_t sampleRate = 0;    ///  765000.0;                                       /// PRESUMABLY THE NUMBER OF SAMPLES PER SECOND
-uint16_t bitsPerSample = 0; /// 16                                                     /// THE NUMBER OF BITS PER SAMPLE 2 BYTES // SAME AS AMPWIDTH
-uint32_t byteRate = 0;      // sampleRate * numChannels * bitsPerSample / 8;                                                                                     /// THE ABOVE COVERTED INTO BYTES
-uint16_t blockAlign = 0;    // numChannels * bitsPerSample / 8;                                                                                                /// NOT SURE YET PROBABLY ALIGNMENT PACKING TYPE OF VARIABLE
-uint32_t formatSize = 0;    // sizeof(audioFormat) + sizeof(numChannels) + sizeof(sampleRate) + sizeof(byteRate) + sizeof(blockAlign) + sizeof(bitsPerSample); /// FORMAT CHUNK SIZE
-uint32_t sampleMax = 0;     //(bitsPerSample == 16 ? 32767 : 2147483647);
-uint32_t sampleMin = 0;     //(bitsPerSample == 16 ? 32767 : 2147483647);
-double frequency = 0.0;     /// Frequency To Play At
-double smoothing = -1.0;    /// Interpolation Smoothing
-double volume = -1.0;
+thread_local uint16_t numChannels = 0;   /// 8;                                                     /// NUMBER OF CHANNELS FOR OUR AUDIO I PRESUME 1 SAMPLE PER CHANNEL
+thread_local uint32_t sampleRate = 0;    ///  765000.0;                                       /// PRESUMABLY THE NUMBER OF SAMPLES PER SECOND
+thread_local uint16_t bitsPerSample = 0; /// 16                                                     /// THE NUMBER OF BITS PER SAMPLE 2 BYTES // SAME AS AMPWIDTH
+thread_local uint32_t byteRate = 0;      // sampleRate * numChannels * bitsPerSample / 8;                                                                                     /// THE ABOVE COVERTED INTO BYTES
+thread_local uint16_t blockAlign = 0;    // numChannels * bitsPerSample / 8;                                                                                                /// NOT SURE YET PROBABLY ALIGNMENT PACKING TYPE OF VARIABLE
+thread_local uint32_t formatSize = 0;    // sizeof(audioFormat) + sizeof(numChannels) + sizeof(sampleRate) + sizeof(byteRate) + sizeof(blockAlign) + sizeof(bitsPerSample); /// FORMAT CHUNK SIZE
+thread_local uint32_t sampleMax = 0;     //(bitsPerSample == 16 ? 32767 : 2147483647);
+thread_local uint32_t sampleMin = 0;     //(bitsPerSample == 16 ? 32767 : 2147483647);
+thread_local double frequency = 0.0;     /// Frequency To Play At
+thread_local double smoothing = -1.0;    /// Interpolation Smoothing
+thread_local double volume = -1.0;
 uint32_t durationInSeconds = -1; /// 10                                                                                           ///DURATION OF THE WAV FILE
 // uint32_t numOfDataCyclesToWrite = durationInSeconds * sampleRate * numChannels; /// THE NUMBER OF CYCLES WE COPY DATA INTO OUR DATA CHUNK
 // vector<uint16_t> silenceSamples(numOfDataCyclesToWrite, 1);                     /// VECTOR OF EMPTY DATA FOR OUR SILENT WAV FILE
-std::string continue_input, volume_percent = "0", inputFile = "", frequency_input = "0", smoothing_percent = "0", sampling_rate_input = "0";
-int ascii_range = 0, min_ascii = 0, max_ascii = 0;
-long long int numSamples = 0;
+thread_local std::string continue_input, volume_percent = "0", inputFile = "", frequency_input = "0", smoothing_percent = "0", sampling_rate_input = "0";
+thread_local int ascii_range = 0, min_ascii = 0, max_ascii = 0;
+thread_local long long int numSamples = 0;
 double PI = 3.141592653589793238462643383279502884197;
-std::string filename = "", samplingOption = "", intention = "", intentionOriginal = "", intentionMode = "";
-std::vector<char> binaryIntentionData;
-std::vector<char> binaryIntentionDataOriginal;
+thread_local std::string filename = "", samplingOption = "", intention = "", intentionOriginal = "", intentionMode = "";
+thread_local std::vector<char> binaryIntentionData;
+thread_local std::vector<char> binaryIntentionDataOriginal;
+thread_local unsigned int renderThreads = 0; /// THREADS PER RENDER, 0 MEANS ONE PER CORE
+thread_local bool showProgress = true;       /// OFF FOR BATCH JOBS SO PARALLEL RENDERS DON'T TALK OVER EACH OTHER
 /// //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-/*
-void addPadding(std::ofstream &file)
-{
-    int currentPosition = file.tellp();
-    //std::cout << "Checking Pading Details Current Pos# " << currentPosition << std::endl;
-    int remainder = currentPosition % BYTEALIGNMENTFORWAVPRODUCER;
-    //std::cout << "Checking Pading Details Remainder# " << remainder << std::endl;
-    if (remainder != 0)
-    {
-        int paddingSize = BYTEALIGNMENTFORWAVPRODUCER - remainder;
-        std::cout << "Checking Pading Details Padding Size# " << paddingSize << std::endl;
-        for (int i = 0; i < paddingSize; ++i)
-        {
-            const uint8_t paddingByte = 0;
-            file.write(reinterpret_cast<const char *>(&paddingByte), sizeof(paddingByte));
-        }
-    }
-}
-*/
 std::string removeNonAlphanumeric(const std::string &str)
 {
     std::string result;
@@ -86,77 +74,7 @@ std::string removeNonAlphanumeric(const std::string &str)
     }
     return result;
 }
-void ensureDataAlignment(ofstream &wavFile)
-{
-    long pos = wavFile.tellp();
-    long align = pos % 2;
-    if (align != 0)
-    {
-        uint8_t paddingByte = 0;
-        wavFile.write(reinterpret_cast<const char *>(&paddingByte), sizeof(paddingByte));
-    }
-}
-void writeRiffHeader(ofstream &wavFile)
-{
-    wavFile.seekp(0, std::ios::beg);
-    wavFile.write("RIFF", 4);                                                                 /// HEADER NAME FOR WAVE FILE ///                                         ///WRITING RIFF HEADER CALLING SIGN INTO FILE
-    wavFile.write(reinterpret_cast<const char *>(&headerChunkSize), sizeof(headerChunkSize)); /// WRITING PLACEHOLDER FOR RIFF HEADER CHUNK SIZE INTO FILE
-    // std::cout << "Checking Pading Details Current Pos# " << wavFile.tellp() << std::endl;
-}
-/// PRESUMES that when you call the function you are at end of file///
-void writeRiffHeaderSizeElement(ofstream &wavFile)
-{
-    int fileLength = static_cast<int>(wavFile.tellp());
-    uint32_t fileSizeMinus8 = static_cast<uint32_t>(fileLength - 8);
-    wavFile.seekp(4, ios::beg);
-    wavFile.write(reinterpret_cast<const char *>(&fileSizeMinus8), sizeof(fileSizeMinus8));
-    wavFile.seekp(0, ios::end);
-}
-/// EXAMPLE: writeFormatHeader(wavFile,formatSize,audioFormat,numChannels,sampleRate,byteRate,blockAlign,bitsPerSample);
-void writeFormatHeader(ofstream &wavFile, const uint32_t formatSize, const uint16_t audioFormat, const uint16_t numChannels, const uint32_t sampleRate, const uint32_t byteRate,
-                       /*                                 */ const uint16_t blockAlign, const uint16_t bitsPerSample)
-{
-    wavFile.write("WAVEfmt ", 8);                                                         /// WRITING FORMAT CHUNK HEADER CALLING SIGN INTO FILE
-    wavFile.write(reinterpret_cast<const char *>(&formatSize), sizeof(formatSize));       /// WRITING FORMAT CHUNK SIZE INTO THE FILE
-    wavFile.write(reinterpret_cast<const char *>(&audioFormat), sizeof(audioFormat));     /// WRITING FORMAT CHUNK ELEMENT - AUDIO FORMAT TO THE FILE
-    wavFile.write(reinterpret_cast<const char *>(&numChannels), sizeof(numChannels));     /// WRITING FORMAT CHUNK ELEMENT - NUMBER OF CHANNELS TO THE FILE
-    wavFile.write(reinterpret_cast<const char *>(&sampleRate), sizeof(sampleRate));       /// WRITING FORMAT CHUNK ELEMENT - SAMPLE RATE TO THE FILE
-    wavFile.write(reinterpret_cast<const char *>(&byteRate), sizeof(byteRate));           /// WRITING FORMAT CHUNK ELEMENT - BYTE RATE TO THE FILE
-    wavFile.write(reinterpret_cast<const char *>(&blockAlign), sizeof(blockAlign));       /// WRITING FORMAT CHUNK ELEMENT - BLOCK ALIGNMENT TO THE FILE
-    wavFile.write(reinterpret_cast<const char *>(&bitsPerSample), sizeof(bitsPerSample)); /// WRITING FORMAT CHUNK ELEMENT - BITS PER SAMPLE TO THE FILE
-    // std::cout << "Checking Pading Details Current Pos# " << wavFile.tellp() << std::endl;
-    //     addPadding(wavFile);
-}
-void writeListSubChunk(ofstream &wavFile, const char *ID, const char *data, const uint32_t dataSize, const uint32_t isNullTerminated = 1)
-{
-    wavFile.write(ID, strlen(ID));                                                                                                              /// WRITE THE INFO CHUNK ID
-    uint32_t alignedDataSize = (dataSize + BYTEALIGNMENTFORWAVPRODUCER - isNullTerminated) & ~(BYTEALIGNMENTFORWAVPRODUCER - isNullTerminated); /// CHECK FOR WORD ALIGNMENT FOR CHUNK
-    wavFile.write(reinterpret_cast<const char *>(&alignedDataSize), sizeof(alignedDataSize));                                                   /// WRITE THE SIZE OF THE CHUNK
-    wavFile.write(data, dataSize);                                                                                                              /// WRITE THE DATA OF THE CHUNK
-    if (alignedDataSize == dataSize)
-        alignedDataSize += BYTEALIGNMENTFORWAVPRODUCER; /// FOR LOOKS SAKE IN THE HEX EDITOR WE HAVE ALIGNMENT NO MATTER WHAT
-    for (uint32_t i = dataSize; i < alignedDataSize; ++i)
-    { /// IF DATA DOESNT END ON ALIGNMENT ADD PADDING
-        const uint8_t paddingByte = 0;
-        wavFile.write(reinterpret_cast<const char *>(&paddingByte), sizeof(paddingByte));
-    }
-}
 
-void writeListSubChunk(ofstream &wavFile, const char *ID, const std::string &data)
-{
-    wavFile.write(ID, strlen(ID));                                                                        /// WRITE THE INFO CHUNK ID
-    const uint32_t dataSize = data.length() + 1;                                                          /// SIZE OF CHUNK TO BE ADDED DEFAULTLY
-    uint32_t alignedDataSize = (dataSize + BYTEALIGNMENTFORWAVPRODUCER) & ~(BYTEALIGNMENTFORWAVPRODUCER); /// CHECK FOR WORD ALIGNMENT FOR CHUNK
-    wavFile.write(reinterpret_cast<const char *>(&alignedDataSize), sizeof(alignedDataSize));             /// WRITE THE SIZE OF THE CHUNK
-    wavFile.write(data.c_str(), data.length());                                                           /// WRITE THE DATA OF THE CHUNK
-    if (alignedDataSize == dataSize)
-        alignedDataSize += BYTEALIGNMENTFORWAVPRODUCER; /// FOR LOOKS SAKE IN THE HEX EDITOR WE HAVE ALIGNMENT NO MATTER WHAT
-    for (uint32_t i = dataSize; i < alignedDataSize; ++i)
-    { /// IF DATA DOESNT END ON ALIGNMENT ADD PADDING
-        const uint8_t paddingByte = 0;
-        wavFile.write(reinterpret_cast<const char *>(&paddingByte), sizeof(paddingByte));
-    }
-}
 uint32_t utf8_codepoint(const wchar_t ch)
 {
     if (ch < 0x80)
@@ -185,19 +103,6 @@ void readFileContents(const std::string &filename, std::vector<char> &intention_
     file.close();
 }
 
-uint32_t writeListHeader(ofstream &wavFile)
-{
-    wavFile.write("LIST", 4);                                                                 /// WRITING LIST HEADER ID
-    const uint32_t listHeaderChunkSizePos = wavFile.tellp();                                  /// GETTING LIST HEADER SIZE ELEMENT POS FOR RETURN VALUE
-    wavFile.write(reinterpret_cast<const char *>(&headerChunkSize), sizeof(headerChunkSize)); /// WRITING PLACEHOLDER SIZE ELEMENT
-    return listHeaderChunkSizePos;                                                            /// RETURNING THE LIST HEADER SIZE ELEMENT POSITION
-}
-void writeListHeaderSizeChunkElement(ofstream &wavFile, const uint32_t position, const uint32_t value)
-{
-    wavFile.seekp(position, ios::beg);                        /// GOING BACK TO FILL IN LIST SIZE ///
-    wavFile.write(reinterpret_cast<const char *>(&value), 4); /// FILLING IN LIST SIZE WITH PROPER NUMERATION ////
-    wavFile.seekp(0, ios::end);                               /// SEEKING END OF FILE ///
-}
 ///////////////PRELIMINARY DATA CHUNK VARIABLES/////////////////
 int ord(char c)
 {
@@ -214,6 +119,142 @@ std::pair<int, int> findMinMaxASCII(const std::string &input)
     auto minMaxPair = std::minmax_element(input.begin(), input.end());
     return {static_cast<int>(*minMaxPair.first), static_cast<int>(*minMaxPair.second)};
 }
+/// ////////////////////////////////////////////SAMPLE SYNTHESIS//////////////////////////////////////////////////////////////////////////////////
+constexpr double quarterTurnPerPhaseUnit = 1.5707963267948966 / 4611686018427387904.0; /// PI/2 OVER 2^62
+
+/// TURNS CYCLES PER SAMPLE INTO A 64-BIT FIXED POINT PHASE STEP WHERE 2^64 IS ONE FULL TURN
+uint64_t fixedPhaseStep(double cyclesPerSample)
+{
+    cyclesPerSample -= std::floor(cyclesPerSample);
+    return static_cast<uint64_t>(std::ldexp(cyclesPerSample, 64));
+}
+/// SINE OF A FIXED POINT PHASE. THE TOP TWO BITS (AFTER AN EIGHTH TURN OFFSET) PICK THE QUADRANT EXACTLY AND
+/// TAYLOR POLYNOMIALS COVER THE REMAINING -PI/4..PI/4 TO DOUBLE PRECISION, WITH NO LIBRARY CALL OR BRANCH
+inline double fixedPhaseSin(uint64_t phase)
+{
+    const uint64_t shifted = phase + (1ULL << 61);
+    const uint64_t quadrant = shifted >> 62;
+    const double x = static_cast<double>(static_cast<int64_t>(shifted & ((1ULL << 62) - 1)) - (1LL << 61)) * quarterTurnPerPhaseUnit;
+    const double x2 = x * x;
+    const double sine = x * (1.0 + x2 * (-1.0 / 6.0 + x2 * (1.0 / 120.0 + x2 * (-1.0 / 5040.0 + x2 * (1.0 / 362880.0 + x2 * (-1.0 / 39916800.0 + x2 * (1.0 / 6227020800.0 + x2 * (-1.0 / 1307674368000.0))))))));
+    const double cosine = 1.0 + x2 * (-1.0 / 2.0 + x2 * (1.0 / 24.0 + x2 * (-1.0 / 720.0 + x2 * (1.0 / 40320.0 + x2 * (-1.0 / 3628800.0 + x2 * (1.0 / 479001600.0 + x2 * (-1.0 / 87178291200.0 + x2 * (1.0 / 20922789888000.0))))))));
+    const double value = (quadrant & 1) ? cosine : sine;
+    return (quadrant & 2) ? -value : value;
+}
+/// RENDERS totalSamples FRAMES OF frameSize BYTES ONE FrameWriter BLOCK AT A TIME. EACH BLOCK IS SPLIT INTO ONE SLICE PER CORE
+/// AND EVERY THREAD RENDERS ITS OWN SLICE IN PLACE, WHILE THE PREVIOUS BLOCK IS STILL BEING WRITTEN OUT
+template <typename RenderSlice>
+void renderDataChunk(ofstream &wavFile, uint64_t totalSamples, size_t frameSize, RenderSlice renderSlice)
+{
+    const unsigned int threadCount = renderThreads ? renderThreads : std::max(1u, std::thread::hardware_concurrency());
+    const uint64_t samplesPerBlock = FrameWriter::blockSize / frameSize;
+    FrameWriter frameWriter(wavFile, showProgress ? totalSamples : 0, frameSize);
+    for (uint64_t first = 0; first < totalSamples; first += samplesPerBlock)
+    {
+        const uint64_t count = std::min(samplesPerBlock, totalSamples - first);
+        const uint64_t slice = (count + threadCount - 1) / threadCount;
+        char *block = frameWriter.reserve(count * frameSize);
+        std::vector<std::thread> renderers;
+        for (uint64_t start = slice; start < count; start += slice)
+        {
+            renderers.emplace_back(renderSlice, block + start * frameSize, first + start, std::min(slice, count - start));
+        }
+        renderSlice(block, first, std::min(slice, count));
+        for (auto &renderer : renderers)
+        {
+            renderer.join();
+        }
+    }
+    frameWriter.finish();
+}
+/// THE JOB SETTINGS A SLICE READS. THE GLOBALS ARE thread_local, SO THEY ARE COPIED HERE ON THE JOB THREAD BEFORE THE SLICES FAN OUT
+struct SliceSettings
+{
+    double smoothing;
+    double volume;
+    double sampleMax;
+    int numChannels;
+};
+/// ONE SLICE OF TEXT MODE: CHARACTER AMPLITUDES INTERPOLATED ACROSS samplesPerCharacter SAMPLES, RIDING ON THE CARRIER
+template <typename SampleType>
+void renderTextSlice(char *output, uint64_t first, uint64_t count, const std::string &intention, const std::array<double, 256> &amplitudes, double samplesPerCharacter, uint64_t phaseStep, const SliceSettings &settings)
+{
+    SampleType *samples = reinterpret_cast<SampleType *>(output);
+    const uint64_t length = intention.size();
+    uint64_t wrapBase = static_cast<uint64_t>(first / samplesPerCharacter) / length * length;
+    uint64_t phase = (first + 1) * phaseStep; /// THE CARRIER ADVANCES BEFORE EACH SAMPLE
+    for (uint64_t n = 0; n < count; ++n, phase += phaseStep)
+    {
+        const double position = static_cast<double>(first + n) / samplesPerCharacter;
+        const double whole = std::floor(position);
+        uint64_t char_index = static_cast<uint64_t>(whole) - wrapBase;
+        while (char_index >= length)
+        {
+            wrapBase += length;
+            char_index -= length;
+        }
+        const uint64_t next_index = (char_index + 1 == length) ? 0 : char_index + 1;
+
+        const double amplitude_current = amplitudes[static_cast<unsigned char>(intention[char_index])];
+        const double amplitude_next = amplitudes[static_cast<unsigned char>(intention[next_index])];
+        /// EXACT REMAINDER LIKE fmod(i, samplesPerCharacter): WHEN position ROUNDED UP ONTO A WHOLE NUMBER THE SAMPLE STILL BELONGS AT THE END OF THE LAST CHARACTER
+        const double sample_index = static_cast<double>(first + n);
+        double remainder = std::fma(-whole, samplesPerCharacter, sample_index);
+        if (remainder < 0.0)
+        {
+            remainder = std::fma(-(whole - 1.0), samplesPerCharacter, sample_index);
+        }
+        const double interpolation_factor = remainder / samplesPerCharacter;
+        const double amplitude_interpolated = 2.0 * (amplitude_current + (amplitude_next - amplitude_current) * interpolation_factor) - 1.0;
+
+        long long int sample_value;
+        if (settings.smoothing == 0.0)
+        {
+            sample_value = amplitude_interpolated * fixedPhaseSin(phase) * settings.sampleMax * settings.volume;
+        }
+        else
+        {
+            double trendingWave = settings.smoothing * fixedPhaseSin(phase);
+            double smoothedAmplitude = (1.0 - settings.smoothing) * amplitude_interpolated;
+            sample_value = (trendingWave + smoothedAmplitude) * settings.sampleMax * settings.volume;
+        }
+
+        const SampleType value = static_cast<SampleType>(sample_value);
+        for (int j = 0; j < settings.numChannels; ++j)
+        {
+            samples[n * settings.numChannels + j] = value;
+        }
+    }
+}
+/// ONE SLICE OF BINARY MODE: ONE INPUT BYTE PER SAMPLE, BLENDED WITH THE CARRIER BY THE SMOOTHING FACTOR
+template <typename SampleType>
+void renderBinarySlice(char *output, uint64_t first, uint64_t count, const std::vector<char> &binaryIntentionData, const std::array<double, 256> &normalizedValues, uint64_t phaseStep, const SliceSettings &settings)
+{
+    SampleType *samples = reinterpret_cast<SampleType *>(output);
+    uint64_t phase = first * phaseStep; /// THE CARRIER ADVANCES AFTER EACH SAMPLE
+    for (uint64_t n = 0; n < count; ++n, phase += phaseStep)
+    {
+        double normalizedCharValue = normalizedValues[static_cast<unsigned char>(binaryIntentionData[first + n])];
+        double sineValue = fixedPhaseSin(phase);
+
+        double modulatedValue;
+        if (settings.smoothing == 1.0)
+        {
+            modulatedValue = sineValue;
+        }
+        else if (settings.smoothing > 0 && settings.smoothing < 1.0)
+        {
+            modulatedValue = (normalizedCharValue * (1.0 - settings.smoothing)) + (sineValue * settings.smoothing);
+        }
+        else
+        {
+            modulatedValue = normalizedCharValue;
+        }
+
+        long sample_value = static_cast<long>(modulatedValue * settings.volume * settings.sampleMax);
+        samples[n] = static_cast<SampleType>(sample_value);
+    }
+}
 void writeDataChunk_Text(ofstream &wavFile)
 {
     if (intentionMode == "File")
@@ -221,7 +262,10 @@ void writeDataChunk_Text(ofstream &wavFile)
         intention = std::string(binaryIntentionData.begin(), binaryIntentionData.end());
     }
 
-    std::cout << "Length of intention: " << intention.length() << std::endl;
+    if (showProgress)
+    {
+        std::cout << "Length of intention: " << intention.length() << std::endl;
+    }
 
     auto [minOrd, maxOrd] = findMinMaxASCII(intention);
     min_ascii = minOrd;
@@ -235,12 +279,7 @@ void writeDataChunk_Text(ofstream &wavFile)
     //    long samples_per_character = sampleRate / frequency;
     //    double phaseIncrement = (2.0f * PI * frequency) / static_cast<float>(sampleRate);
 
-    wavFile.write("data", 4);
-    const uint32_t dataChunkSizePos = wavFile.tellp();
-    wavFile.write(reinterpret_cast<const char *>(&headerChunkSize), sizeof(headerChunkSize));
-
-    double phaseIncrement = (2.0 * PI * frequency) / sampleRate;
-    double phase = 0.0; // Phase accumulator
+    const std::streamoff dataChunkSizePos = writeDataChunkHeader(wavFile);
 
     byteRate = sampleRate * numChannels * bitsPerSample / 8;                                                                                     /// THE ABOVE COVERTED INTO BYTES
     blockAlign = numChannels * bitsPerSample / 8;                                                                                                /// NOT SURE YET PROBABLY ALIGNMENT PACKING TYPE OF VARIABLE
@@ -248,75 +287,34 @@ void writeDataChunk_Text(ofstream &wavFile)
 
     numSamples = (sampleRate / frequency) * intention.length();
 
-    std::vector<char> frames;
-    const size_t bufferSize = 1024 * 1024; // Adjust the buffer size as needed
-
-    for (uint32_t i = 0; i < numSamples; ++i)
+    std::array<double, 256> amplitudes;
+    for (int c = 0; c < 256; ++c)
     {
-        long char_index = fmod((i / (sampleRate / frequency)), intention.size());
-        wchar_t current_char = intention[char_index];
-        wchar_t next_char = intention[(char_index + 1) % intention.size()];
-
+        wchar_t current_char = static_cast<char>(c);
         uint32_t current_codepoint = utf8_codepoint(current_char);
-        uint32_t next_codepoint = utf8_codepoint(next_char);
-
-        double amplitude_current = ((current_codepoint)-min_ascii) / static_cast<double>(ascii_range);
-        double amplitude_next = ((next_codepoint)-min_ascii) / static_cast<double>(ascii_range);
-        double interpolation_factor = fmod(i, (static_cast<double>(sampleRate / frequency))) / (sampleRate / frequency);
-
-        double amplitude_interpolated = 2.0 * (amplitude_current + (amplitude_next - amplitude_current) * interpolation_factor) - 1.0;
-
-        phase += phaseIncrement;
-        if (phase > 2.0 * PI)
-        {
-            phase -= 2.0 * PI;
-        }
+        amplitudes[c] = ((current_codepoint)-min_ascii) / static_cast<double>(ascii_range);
+    }
 
-        long long int sample_value;
-        if (smoothing == 0.0)
+    const double samplesPerCharacter = sampleRate / frequency;
+    const uint64_t phaseStep = fixedPhaseStep(frequency / sampleRate);
+    const size_t frameSize = numChannels * (bitsPerSample == 32 ? sizeof(int32_t) : sizeof(int16_t));
+    const SliceSettings settings{smoothing, volume, static_cast<double>(sampleMax), numChannels};
+    const std::string &text = intention;
+    if (numSamples > 0)
+    {
+        if (bitsPerSample == 32)
         {
-            sample_value = amplitude_interpolated * sin(phase) * sampleMax * volume;
+            renderDataChunk(wavFile, numSamples, frameSize, [&](char *output, uint64_t first, uint64_t count)
+                            { renderTextSlice<int32_t>(output, first, count, text, amplitudes, samplesPerCharacter, phaseStep, settings); });
         }
         else
         {
-            double trendingWave = smoothing * sin(phase);
-            double smoothedAmplitude = (1.0 - smoothing) * amplitude_interpolated;
-            sample_value = (trendingWave + smoothedAmplitude) * sampleMax * volume;
-        }
-
-        for (int j = 0; j < numChannels; ++j)
-        {
-            if (bitsPerSample == 32)
-            {
-                int32_t sample_value_32bit = static_cast<int32_t>(sample_value);
-                frames.insert(frames.end(), reinterpret_cast<char *>(&sample_value_32bit), reinterpret_cast<char *>(&sample_value_32bit) + sizeof(sample_value_32bit));
-            }
-            else
-            {
-                int16_t sample_value_16bit = static_cast<int16_t>(sample_value);
-                frames.insert(frames.end(), reinterpret_cast<char *>(&sample_value_16bit), reinterpret_cast<char *>(&sample_value_16bit) + sizeof(sample_value_16bit));
-            }
-        }
-
-        if (frames.size() >= bufferSize * numChannels * (bitsPerSample / 8))
-        {
-            wavFile.write(frames.data(), frames.size());
-            frames.clear();
+            renderDataChunk(wavFile, numSamples, frameSize, [&](char *output, uint64_t first, uint64_t count)
+                            { renderTextSlice<int16_t>(output, first, count, text, amplitudes, samplesPerCharacter, phaseStep, settings); });
         }
-
-        if (i % 100000 == 0)
-        {
-            std::cout << "\rProgress: " << std::fixed << std::setprecision(2) << static_cast<float>(i) / static_cast<float>(numSamples) * 100.0f << "% Samples Written: " << std::to_string(i) << "     \r" << std::flush;
-        }
-    }
-
-    if (frames.size() > 0)
-    {
-        wavFile.write(frames.data(), frames.size());
-        frames.clear();
     }
 
-    uint32_t actualDataSize = static_cast<uint32_t>(static_cast<int64_t>(wavFile.tellp()) - dataChunkSizePos - 4);
+    uint64_t actualDataSize = static_cast<uint64_t>(static_cast<std::streamoff>(wavFile.tellp()) - dataChunkSizePos - 4);
     if (actualDataSize % 2 != 0)
     {
         uint8_t paddingByte = 0;
@@ -325,20 +323,13 @@ void writeDataChunk_Text(ofstream &wavFile)
     }
     // Ensure data alignment after writing the main data chunk
     ensureDataAlignment(wavFile);
-    wavFile.seekp(dataChunkSizePos, ios::beg);
-    wavFile.write(reinterpret_cast<const char *>(&actualDataSize), 4);
-    wavFile.seekp(0, ios::end);
+    writeDataChunkSizeElement(wavFile, dataChunkSizePos, actualDataSize, numSamples, useRF64);
 
-    std::cout << "\rProgress: 100.00%"
-              << " Samples Written: " << std::to_string(numSamples) << "     \r" << std::endl;
-
-    if (frames.size() > 0)
+    if (showProgress)
     {
-        wavFile.write(frames.data(), frames.size());
-        frames.clear();
+        std::cout << "\rProgress: 100.00%"
+                  << " Samples Written: " << std::to_string(numSamples) << "     \r" << std::endl;
     }
-    std::cout << "\rProgress: 100.00%"
-              << " Samples Written: " << std::to_string(numSamples) << "     \r" << std::endl;
 }
 void writeDataChunk_Binary(std::ofstream &wavFile)
 {
@@ -367,63 +358,31 @@ void writeDataChunk_Binary(std::ofstream &wavFile)
     int rangeValue = maxCharValue - minCharValue;
     double sampleMax = (bitsPerSample == 16 ? 32767 : 2147483647);
     // double scalingFactor = sampleMax / rangeValue;
-    uint32_t numSamples = binaryIntentionData.size();
-    std::vector<char> sample_buffer;
-
-    double phaseIncrement = 2.0 * PI * frequency / sampleRate;
-    double phase = 0.0;
-    wavFile.write("data", 4);
-    const uint32_t dataChunkSizePos = wavFile.tellp();
-    wavFile.write(reinterpret_cast<const char *>(&headerChunkSize), sizeof(headerChunkSize));
+    uint64_t numSamples = binaryIntentionData.size();
 
-    for (uint32_t i = 0; i < numSamples; ++i)
+    std::array<double, 256> normalizedValues;
+    for (int c = 0; c < 256; ++c)
     {
-        double charValue = static_cast<unsigned char>(binaryIntentionData[i]) - minCharValue;
-        double normalizedCharValue = (charValue / rangeValue) * 2.0 - 1.0; // Normalize to [-1, 1]
-
-        double sineValue = std::sin(phase);
-        phase += phaseIncrement;
-        if (phase >= 2.0 * PI)
-            phase -= 2.0 * PI;
-
-        // Modulate based on smoothing
-        double modulatedValue;
-        if (smoothing == 1.0)
-        {
-            modulatedValue = sineValue;
-        }
-        else if (smoothing > 0 && smoothing < 1.0)
-        {
-            modulatedValue = (normalizedCharValue * (1.0 - smoothing)) + (sineValue * smoothing);
-        }
-        else
-        {
-            modulatedValue = normalizedCharValue;
-        }
-
-        long sample_value = static_cast<long>(modulatedValue * volume * sampleMax);
+        double charValue = c - minCharValue;
+        normalizedValues[c] = (charValue / rangeValue) * 2.0 - 1.0; // Normalize to [-1, 1]
+    }
 
-        // Write sample_value to sample_buffer
-        if (bitsPerSample == 32)
-        {
-            int32_t val = static_cast<int32_t>(sample_value);
-            sample_buffer.insert(sample_buffer.end(), reinterpret_cast<char *>(&val), reinterpret_cast<char *>(&val) + sizeof(val));
-        }
-        else
-        {
-            int16_t val = static_cast<int16_t>(sample_value);
-            sample_buffer.insert(sample_buffer.end(), reinterpret_cast<char *>(&val), reinterpret_cast<char *>(&val) + sizeof(val));
-        }
+    const std::streamoff dataChunkSizePos = writeDataChunkHeader(wavFile);
 
-        // Write buffer to file and clear every 100000 samples
-        if (i % 100000 == 0 && i > 0)
-        {
-            wavFile.write(sample_buffer.data(), sample_buffer.size());
-            sample_buffer.clear();
-            std::cout << "\rProgress: " << std::fixed << std::setprecision(2) << static_cast<float>(i) / static_cast<float>(numSamples) * 100.0f << "% Samples Written: " << i << "     \r" << std::flush;
-        }
+    const uint64_t phaseStep = fixedPhaseStep(frequency / sampleRate);
+    const SliceSettings settings{smoothing, volume, sampleMax, numChannels};
+    const std::vector<char> &data = binaryIntentionData;
+    if (bitsPerSample == 32)
+    {
+        renderDataChunk(wavFile, numSamples, sizeof(int32_t), [&](char *output, uint64_t first, uint64_t count)
+                        { renderBinarySlice<int32_t>(output, first, count, data, normalizedValues, phaseStep, settings); });
+    }
+    else
+    {
+        renderDataChunk(wavFile, numSamples, sizeof(int16_t), [&](char *output, uint64_t first, uint64_t count)
+                        { renderBinarySlice<int16_t>(output, first, count, data, normalizedValues, phaseStep, settings); });
     }
-    uint32_t actualDataSize = static_cast<uint32_t>(static_cast<int64_t>(wavFile.tellp()) - dataChunkSizePos - 4);
+    uint64_t actualDataSize = static_cast<uint64_t>(static_cast<std::streamoff>(wavFile.tellp()) - dataChunkSizePos - 4);
     if (actualDataSize % 2 != 0)
     {
         uint8_t paddingByte = 0;
@@ -432,114 +391,10 @@ void writeDataChunk_Binary(std::ofstream &wavFile)
     }
     // Ensure data alignment after writing the main data chunk
     ensureDataAlignment(wavFile);
-
-    wavFile.seekp(dataChunkSizePos, ios::beg);
-    wavFile.write(reinterpret_cast<const char *>(&actualDataSize), sizeof(actualDataSize));
-    wavFile.seekp(0, ios::end);
-
-    // Write any remaining samples in buffer to file
-    if (!sample_buffer.empty())
-    {
-        wavFile.write(sample_buffer.data(), sample_buffer.size());
-        sample_buffer.clear();
-    }
+    writeDataChunkSizeElement(wavFile, dataChunkSizePos, actualDataSize, numSamples, useRF64);
 }
 /// //////////////////////////////END OF RIFF TAG////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /// /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-/// /////////////////////////////START OF ID3V2 TAG////////////////////////////////////////////////////////////////////////////////////////////
-const uint8_t majorVersion = 0x04; // ID3v2.4 version number
-const uint8_t minorVersion = 0x00; // Revision number
-const uint8_t paddingByte = 0x00;  // Zero byte
-void writeLittleEndian(std::ofstream &file, uint32_t value)
-{
-    file.put(value & 0xFF);
-    file.put((value >> 8) & 0xFF);
-    file.put((value >> 16) & 0xFF);
-    file.put((value >> 24) & 0xFF);
-}
-void writeBigEndian(std::ofstream &file, uint32_t value)
-{
-    file.put((value >> 24) & 0xFF);
-    file.put((value >> 16) & 0xFF);
-    file.put((value >> 8) & 0xFF);
-    file.put(value & 0xFF);
-}
-uint32_t checkForAndWritePadding(ofstream &wavFile)
-{ /// Calculate padding needed to align frame start to a multiple of 4 bytes
-    const uint32_t paddingSize = (BYTEALIGNMENTFORWAVPRODUCER - (wavFile.tellp() % BYTEALIGNMENTFORWAVPRODUCER)) % BYTEALIGNMENTFORWAVPRODUCER;
-    for (uint32_t i = 0; i < paddingSize; ++i)
-    {
-        wavFile.write(reinterpret_cast<const char *>(&paddingByte), sizeof(paddingByte));
-    }
-    return paddingSize;
-}
-void writePadding(ofstream &wavFile)
-{ /// Calculate padding needed to align frame start to a multiple of 4 bytes
-    uint32_t paddingSize = (BYTEALIGNMENTFORWAVPRODUCER - (wavFile.tellp() % BYTEALIGNMENTFORWAVPRODUCER)) % BYTEALIGNMENTFORWAVPRODUCER;
-    if (paddingSize == 0)
-        paddingSize = BYTEALIGNMENTFORWAVPRODUCER;
-    for (uint32_t i = 0; i < paddingSize; ++i)
-    {
-        wavFile.write(reinterpret_cast<const char *>(&paddingByte), sizeof(paddingByte));
-    }
-}
-uint32_t createID3Header(ofstream &wavFile, const uint32_t tagSize = 0, const uint8_t flags = 0x00)
-{
-    //    const uint32_t paddingAdded = checkForAndWritePadding(wavFile);
-    wavFile.write("ID3", 3);                                         /// WRITE TAG OF HEADER OF ID3TAG
-    wavFile.write(reinterpret_cast<const char *>(&majorVersion), 1); /// WRITE MAJOR VERSION
-    wavFile.write(reinterpret_cast<const char *>(&minorVersion), 1); /// WRITE MINOR VERSION
-    wavFile.write(reinterpret_cast<const char *>(&flags), 1);        /// WRITE FLAGS
-    const uint32_t ID3HeaderSizeElementLocation = wavFile.tellp();
-    const uint32_t actualTagSize = tagSize;
-    if constexpr (std::endian::native == std::endian::little)
-    { /// WRITE TAG SIZE = SIZE OF ID3 TAG MINUS HEADER
-        writeLittleEndian(wavFile, actualTagSize);
-    }
-    else if constexpr (std::endian::native == std::endian::big)
-    {
-        writeBigEndian(wavFile, actualTagSize);
-    }
-    else
-    {
-        wavFile.write(reinterpret_cast<const char *>(&actualTagSize), 4);
-    }
-    return ID3HeaderSizeElementLocation;
-}
-void createID3Footer(ofstream &wavFile, const uint32_t tagSize = 0, const uint8_t flags = 0x00)
-{
-    //    checkForAndWritePadding(wavFile);
-    wavFile.write("3DI", 3);                                         /// WRITE TAG OF FOOTER OF ID3TAG WHICH IS BACKWARDS HEADER ID
-    wavFile.write(reinterpret_cast<const char *>(&majorVersion), 1); /// WRITE MAJOR VERSION
-    wavFile.write(reinterpret_cast<const char *>(&minorVersion), 1); /// WRITE MINOR VERSION
-    wavFile.write(reinterpret_cast<const char *>(&flags), 1);        /// WRITE FLAGS
-    wavFile.write(reinterpret_cast<const char *>(&tagSize), 4);      /// WRITE TAG SIZE
-}
-uint32_t createID3FrameHeader(ofstream &wavFile, const char *frameID, const uint32_t frameSize = 0, const uint16_t flags = 0x00)
-{
-    //    checkForAndWritePadding(wavFile);
-    wavFile.write(frameID, 4); /// The frame ID is made out of the characters capital A-Z and 0-9. Identifiers beginning with �X�, �Y� and �Z�
-    const uint32_t frameSizePosition = wavFile.tellp();
-    wavFile.write(reinterpret_cast<const char *>(&frameSize), 4);
-    wavFile.write(reinterpret_cast<const char *>(&flags), 2);
-    return frameSizePosition;
-}
-void setID3HeaderSize(ofstream &wavFile, const uint32_t frameSizeElementLocation, const uint32_t frameChunkSize)
-{
-    const uint32_t currentPos = wavFile.tellp();
-    wavFile.seekp(frameSizeElementLocation, std::ios::beg);
-    wavFile.write(reinterpret_cast<const char *>(&frameChunkSize), 4);
-    wavFile.seekp(currentPos, std::ios::beg);
-    createID3Footer(wavFile, frameChunkSize);
-}
-void insertID3Frame(ofstream &wavFile, const string &key, const string &value)
-{
-    const uint32_t frameSize = key.size() + value.size() + 1; /// Size of frame = size of key + size of value + 1 (for null terminator)
-    createID3FrameHeader(wavFile, key.c_str(), frameSize);
-    wavFile.write("\0", 1); // Null terminator between key and value
-    wavFile.write(value.c_str(), value.size());
-}
-/// ////////////////////////////////////////////////END OF ID3V2 TAG///////////////////////////////////////////////////////////////////////////
 /// CONVERT A TEXT FILE TO A VECTOR OF SINGLE BYTES ///
 std::string readFileToString(const string &filename)
 {
@@ -553,6 +408,17 @@ std::string readFileToString(const string &filename)
     buffer << fileStream.rdbuf(); /// READ FILE CONTENTS INTO STRING BUFFER ///
     return buffer.str();          /// RETURN THE STRINGSTREAM AS A STRING ///
 }
+/// BYTES OF SAMPLE DATA THE CHOSEN SAMPLING OPTION WILL WRITE, WORKED OUT THE SAME WAY AS THE writeDataChunk FUNCTIONS DO
+uint64_t projectedDataSize()
+{
+    if (samplingOption == "1")
+    {
+        return static_cast<uint64_t>(binaryIntentionData.size()) * (bitsPerSample / 8);
+    }
+    const size_t intentionLength = (intentionMode == "File") ? binaryIntentionData.size() : intention.length();
+    const uint64_t projectedSamples = static_cast<uint64_t>((sampleRate / frequency) * intentionLength);
+    return projectedSamples * numChannels * (bitsPerSample / 8);
+}
 /// Function to create WAV file with binary data repeated until 1 minute ///
 void createWavFile(const string &filename)
 {
@@ -563,8 +429,15 @@ void createWavFile(const string &filename)
         exit(EXIT_FAILURE);
     }
 
+    // Files whose data will not fit a 32 bit RIFF size are written as RF64
+    useRF64 = projectedDataSize() > RIFF_SIZE_LIMIT;
+    if (useRF64 && showProgress)
+    {
+        std::cout << "Output is larger than 4 GB, writing RF64." << std::endl;
+    }
+
     // Writing headers and data chunks
-    writeRiffHeader(wavFile);
+    writeRiffHeader(wavFile, useRF64);
     writeFormatHeader(wavFile, formatSize, audioFormat, numChannels, sampleRate, byteRate, blockAlign, bitsPerSample);
     if (samplingOption == "1")
     {
@@ -578,7 +451,7 @@ void createWavFile(const string &filename)
     // Ensure alignment before finalizing the file
     ensureDataAlignment(wavFile);
 
-    writeRiffHeaderSizeElement(wavFile); // Finalizes the RIFF header size
+    writeRiffHeaderSizeElement(wavFile, useRF64); // Finalizes the RIFF header size
     wavFile.close();
 }
 short removeOldFile(const std::string &filename)
@@ -598,30 +471,6 @@ bool is_hz_suffix(const std::string &str)
 {
     return str.size() >= 2 && (str.substr(str.size() - 2) == "HZ" || str.substr(str.size() - 2) == "hz" || str.substr(str.size() - 2) == "Hz");
 }
-std::string display_suffix(std::string num, int power, std::string designator)
-{
-    if (power < 3)
-    {
-        return num;
-    }
-
-    std::string s;
-
-    if (designator == "Iterations")
-    {
-        constexpr char iterations_suffix_array[] = {' ', 'k', 'M', 'B', 'T', 'q', 'Q', 's', 'S', 'O', 'N', 'D'};
-        s = iterations_suffix_array[power / 3];
-    }
-    else // designator == "Frequency"
-    {
-        constexpr char frequency_suffix_array[] = {' ', 'k', 'M', 'G', 'T', 'P', 'E', 'Z', 'Y', 'R'};
-        s = frequency_suffix_array[power / 3];
-    }
-
-    std::string str2 = num.substr(0, power % 3 + 1) + "." + num.substr(power % 3 + 1, 3) + s;
-
-    return str2;
-}
 bool checkFileExtension(const std::string &filename)
 {
     int len = filename.length();
@@ -650,6 +499,33 @@ bool file_exists(const std::string &file_path)
 {
     return fs::exists(file_path);
 }
+/// APPENDS THE INTENTION (OR THE FILE CONTENTS) repeatIntention TIMES ONTO WHAT WAS ENTERED
+void repeatIntentionData(int repeatIntention)
+{
+    for (int i = 0; i < repeatIntention; ++i)
+    {
+        if (intentionMode == "Intention")
+        {
+            intention += intentionOriginal;
+        }
+        else if (intentionMode == "File")
+        {
+            binaryIntentionData.insert(binaryIntentionData.end(), binaryIntentionDataOriginal.begin(), binaryIntentionDataOriginal.end());
+        }
+    }
+}
+/// 32 BIT PCM AND EVERYTHING THE FORMAT CHUNK DERIVES FROM sampleRate AND numChannels
+void setSampleFormat()
+{
+    bitsPerSample = 32;
+
+    sampleMax = (bitsPerSample == 16 ? 32767 : 2147483647);
+    sampleMin = (bitsPerSample == 16 ? -32768 : -2147483648);
+
+    byteRate = sampleRate * numChannels * bitsPerSample / 8;                                                                                     /// THE ABOVE COVERTED INTO BYTES
+    blockAlign = numChannels * bitsPerSample / 8;                                                                                                /// NOT SURE YET PROBABLY ALIGNMENT PACKING TYPE OF VARIABLE
+    formatSize = sizeof(audioFormat) + sizeof(numChannels) + sizeof(sampleRate) + sizeof(byteRate) + sizeof(blockAlign) + sizeof(bitsPerSample); /// FORMAT CHUNK SIZE
+}
 void setupQuestions()
 {
     bool bool_file_exists = false;
@@ -716,17 +592,7 @@ void setupQuestions()
         }
     }
     // intention = "";
-    for (int i = 0; i < repeatIntention; ++i)
-    {
-        if (intentionMode == "Intention")
-        {
-            intention += intentionOriginal;
-        }
-        else if (intentionMode == "File")
-        {
-            binaryIntentionData.insert(binaryIntentionData.end(), binaryIntentionDataOriginal.begin(), binaryIntentionDataOriginal.end());
-        }
-    }
+    repeatIntentionData(repeatIntention);
 
     while (sampleRate < 44100 || sampleRate > 767500)
     {
@@ -756,14 +622,7 @@ void setupQuestions()
         }
     }
 
-    bitsPerSample = 32;
-
-    sampleMax = (bitsPerSample == 16 ? 32767 : 2147483647);
-    sampleMin = (bitsPerSample == 16 ? -32768 : -2147483648);
-
-    byteRate = sampleRate * numChannels * bitsPerSample / 8;                                                                                     /// THE ABOVE COVERTED INTO BYTES
-    blockAlign = numChannels * bitsPerSample / 8;                                                                                                /// NOT SURE YET PROBABLY ALIGNMENT PACKING TYPE OF VARIABLE
-    formatSize = sizeof(audioFormat) + sizeof(numChannels) + sizeof(sampleRate) + sizeof(byteRate) + sizeof(blockAlign) + sizeof(bitsPerSample); /// FORMAT CHUNK SIZE
+    setSampleFormat();
 
     while (frequency < 1)
     {
@@ -894,7 +753,7 @@ void setupQuestions()
     if (samplingOption == "1")
     {
         int digits;
-        int binarySize = intentionSize * bitsPerSample / 8.0 / 10;
+        long long int binarySize = intentionSize * bitsPerSample / 8.0 / 10;
         digits = std::to_string(binarySize).length();
 
         std::cout << "Estimated File Size: " << display_suffix(std::to_string(binarySize), digits, "Frequency") << "B, Continue: (y/N)? ";
@@ -904,7 +763,7 @@ void setupQuestions()
     else if (samplingOption == "2")
     {
         int digits;
-        int textSize = (intentionSize / frequency) * sampleRate * bitsPerSample * numChannels / 8.0 / 10;
+        long long int textSize = (intentionSize / frequency) * sampleRate * bitsPerSample * numChannels / 8.0 / 10;
         digits = std::to_string(textSize).length();
         std::cout << "Estimated File Size: " << display_suffix(std::to_string(textSize), digits, "Frequency") << "B, Continue: (y/N)? ";
         std::getline(std::cin, continue_input);
@@ -950,11 +809,431 @@ NO_OPTIMIZE void stringMemoryAllocation(const std::string &textParameter)
     //    std::cout <<"Intent Processor Thread Exitting\n";
 }
 
-int main()
+/// ////////////////////////////////////////////BATCH MODE//////////////////////////////////////////////////////////////////////////////////////
+/// ANY COMMAND LINE ARGUMENT SKIPS THE QUESTIONS. EACH JOB IS ONE WAV FILE DESCRIBED BY THE SAME FLAGS, EITHER ON THE COMMAND LINE OR ONE JOB
+/// PER LINE OF A MANIFEST. JOBS RUN ON A POOL OF WORKER THREADS AND SHARE A MEMORY BUDGET SO A BIG QUEUE DOESN'T LOAD EVERYTHING AT ONCE
+const uint64_t defaultBatchMemoryMB = 2048;
+struct WavJob
+{
+    std::string intention;            /// TEXT TO ENCODE, OR A FILENAME WHEN IT ENDS IN A 3 OR 4 LETTER EXTENSION (SAME RULE AS THE PROMPT)
+    std::string samplingOption = "2"; /// "1" BINARY TO WAV, "2" TEXT TO WAV
+    int repeat = 1;
+    uint32_t sampleRate = 48000;
+    uint16_t numChannels = 1;
+    std::string frequency = "432";
+    std::string smoothing = "5";
+    std::string volume = "25";
+    std::string outputFile;           /// EMPTY MEANS THE NAME THE INTERACTIVE MODE WOULD PICK
+    std::string origin = "command line";
+};
+void print_help()
+{
+    const std::string helpText = R"(Run without flags to answer the questions interactively.
+
+Job Flags (one WAV file per job):
+ a) --intent or -i, example: --intent "I am love." or --intent picture.jpg
+ b) --mode or -o, example: --mode text
+ c) --repeat or -r, example: --repeat 10
+ d) --rate or -s, example: --rate 96000
+ e) --channels or -c, example: --channels 2
+ f) --freq or -f, example: --freq 528
+ g) --smoothing or -m, example: --smoothing 5
+ h) --volume or -v, example: --volume 25
+ i) --output or -w, example: --output love.wav
+
+Batch Flags:
+ j) --manifest or -b, example: --manifest jobs.txt
+ k) --jobs or -j, example: --jobs 4
+ l) --memory or -x, example: --memory 4096
+ m) --help or -h or /?
+
+--intent = Intention, or a filename to convert from. Required unless --manifest is given.
+--mode = binary (1) for one input byte per sample, or text (2) for frequency characters per second. Default = text.
+--repeat = # Times to repeat the intention (1 to 1000000). Affects length of WAV, not strength. Default = 1.
+--rate = Sampling rate (44100 to 767500). Default = 48000.
+--channels = Channels (1 to 8). Default = 1.
+--freq = Frequency in Hz. Default = 432.
+--smoothing = Smoothing factor in percent (0 to 100). Default = 5.
+--volume = Volume in percent (0 to 99). Default = 25.
+--output = WAV filename. Default = <freq>Hz_SmoothingPercent_<smoothing>_<rate>.wav, numbered when two jobs would share a name.
+--manifest = Text file with one job per line, written with the job flags above. Blank lines and lines starting with # are skipped.
+             Job flags given on the command line are the defaults for every line.
+--jobs = Number of WAV files rendered at the same time. The cores are divided between them. Default = 1.
+--memory = Memory budget in MB shared by the running jobs. A job waits until its input fits. Default = 2048.
+)";
+    std::cout << helpText;
+}
+/// THE FLAGS parseJobFlag ACCEPTS, SO AN UNKNOWN FLAG IS REPORTED AS SUCH EVEN WHEN NO VALUE FOLLOWS IT
+bool isJobFlag(const std::string &flag)
+{
+    static const std::vector<std::string> jobFlags = {
+        "-i", "--intent", "-o", "--mode", "-r", "--repeat", "-s", "--rate", "-c", "--channels",
+        "-f", "--freq", "-m", "--smoothing", "-v", "--volume", "-w", "--output"};
+    return std::find(jobFlags.begin(), jobFlags.end(), flag) != jobFlags.end();
+}
+/// APPLIES ONE JOB FLAG. RETURNS false WITH error SET WHEN THE FLAG IS UNKNOWN OR ITS VALUE IS OUT OF RANGE
+bool parseJobFlag(WavJob &job, const std::string &flag, const std::string &value, std::string &error)
+{
+    try
+    {
+        if (flag == "-i" || flag == "--intent")
+        {
+            job.intention = value;
+        }
+        else if (flag == "-o" || flag == "--mode")
+        {
+            std::string mode = value;
+            std::transform(mode.begin(), mode.end(), mode.begin(), ::tolower);
+            if (mode == "1" || mode == "binary")
+            {
+                job.samplingOption = "1";
+            }
+            else if (mode == "2" || mode == "text")
+            {
+                job.samplingOption = "2";
+            }
+            else
+            {
+                error = "--mode must be binary or text";
+                return false;
+            }
+        }
+        else if (flag == "-r" || flag == "--repeat")
+        {
+            job.repeat = std::stoi(value);
+            if (job.repeat < 1 || job.repeat > 1000000)
+            {
+                error = "--repeat must be 1 to 1000000";
+                return false;
+            }
+        }
+        else if (flag == "-s" || flag == "--rate")
+        {
+            const long rate = std::stol(value);
+            if (rate < 44100 || rate > 767500)
+            {
+                error = "--rate must be 44100 to 767500";
+                return false;
+            }
+            job.sampleRate = static_cast<uint32_t>(rate);
+        }
+        else if (flag == "-c" || flag == "--channels")
+        {
+            const int channels = std::stoi(value);
+            if (channels < 1 || channels > 8)
+            {
+                error = "--channels must be 1 to 8";
+                return false;
+            }
+            job.numChannels = static_cast<uint16_t>(channels);
+        }
+        else if (flag == "-f" || flag == "--freq")
+        {
+            job.frequency = is_hz_suffix(value) ? value.substr(0, value.size() - 2) : value;
+            if (std::stod(job.frequency) < 1)
+            {
+                error = "--freq must be at least 1 Hz";
+                return false;
+            }
+        }
+        else if (flag == "-m" || flag == "--smoothing" || flag == "-v" || flag == "--volume")
+        {
+            const bool isSmoothing = (flag == "-m" || flag == "--smoothing");
+            std::string percent = value;
+            if (!percent.empty() && percent.back() == '%')
+            {
+                percent.pop_back();
+            }
+            const double fraction = std::stod(percent) / 100;
+            if (fraction < 0.0 || fraction > (isSmoothing ? 1.0 : 0.99))
+            {
+                error = isSmoothing ? "--smoothing must be 0 to 100" : "--volume must be 0 to 99";
+                return false;
+            }
+            (isSmoothing ? job.smoothing : job.volume) = percent;
+        }
+        else if (flag == "-w" || flag == "--output")
+        {
+            job.outputFile = value;
+        }
+        else
+        {
+            error = "unknown option " + flag;
+            return false;
+        }
+    }
+    catch (...)
+    {
+        error = "invalid value for " + flag + ": " + value;
+        return false;
+    }
+    return true;
+}
+/// ONE LINE OF A MANIFEST: THE SAME FLAGS AS THE COMMAND LINE, WITH "DOUBLE QUOTES" AROUND VALUES THAT CONTAIN SPACES
+bool parseManifestLine(const std::string &line, WavJob &job, std::string &error)
+{
+    std::istringstream tokens(line);
+    std::string flag, value;
+    while (tokens >> std::quoted(flag))
+    {
+        if (!isJobFlag(flag))
+        {
+            error = "unknown option " + flag;
+            return false;
+        }
+        if (!(tokens >> std::quoted(value)))
+        {
+            error = "missing value for " + flag;
+            return false;
+        }
+        if (!parseJobFlag(job, flag, value, error))
+        {
+            return false;
+        }
+    }
+    if (job.intention.empty())
+    {
+        error = "no --intent";
+        return false;
+    }
+    return true;
+}
+bool readManifest(const std::string &manifestFile, const WavJob &defaults, std::vector<WavJob> &jobs)
+{
+    std::ifstream manifest(manifestFile);
+    if (!manifest)
+    {
+        std::cerr << "Error: Unable to open manifest " << manifestFile << std::endl;
+        return false;
+    }
+    std::string line, error;
+    bool valid = true;
+    for (size_t lineNumber = 1; std::getline(manifest, line); ++lineNumber)
+    {
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.pop_back();
+        }
+        const size_t start = line.find_first_not_of(" \t");
+        if (start == std::string::npos || line[start] == '#')
+        {
+            continue;
+        }
+        WavJob job = defaults;
+        job.intention.clear();
+        job.origin = manifestFile + " line " + std::to_string(lineNumber);
+        if (parseManifestLine(line, job, error))
+        {
+            jobs.push_back(job);
+        }
+        else
+        {
+            std::cerr << "Error: " << job.origin << ": " << error << std::endl;
+            valid = false;
+        }
+    }
+    return valid;
+}
+/// ROUGH PEAK MEMORY OF A JOB: THE INPUT, ITS REPEATED COPY (TWICE WHEN A FILE IS RENDERED AS TEXT) AND THE WRITER'S TWO BLOCKS
+uint64_t estimateJobMemory(const WavJob &job)
+{
+    const bool isFile = checkFileExtension(job.intention) && file_exists(job.intention);
+    const uint64_t inputSize = isFile ? fs::file_size(job.intention) : job.intention.size();
+    const uint64_t repeatedCopies = (isFile && job.samplingOption == "2") ? 2 * job.repeat : job.repeat;
+    return inputSize * (repeatedCopies + 1) + 2 * FrameWriter::blockSize;
+}
+/// GIVES EVERY JOB WITHOUT --output THE INTERACTIVE DEFAULT NAME, NUMBERING THE ONES THAT WOULD OVERWRITE AN EARLIER JOB
+void assignOutputFiles(std::vector<WavJob> &jobs)
+{
+    std::vector<std::string> taken;
+    for (size_t i = 0; i < jobs.size(); ++i)
+    {
+        WavJob &job = jobs[i];
+        if (job.outputFile.empty())
+        {
+            job.outputFile = job.frequency + "Hz_SmoothingPercent_" + job.smoothing + "_" + std::to_string(job.sampleRate) + ".wav";
+            if (std::find(taken.begin(), taken.end(), job.outputFile) != taken.end())
+            {
+                job.outputFile.insert(job.outputFile.size() - 4, "_" + std::to_string(i + 1));
+            }
+        }
+        taken.push_back(job.outputFile);
+    }
+}
+/// RUNS ON A FRESH THREAD, SO EVERY thread_local SETTING STARTS FROM ITS DEFAULT. FILLS THEM IN LIKE setupQuestions() AND RENDERS
+bool renderJob(const WavJob &job, unsigned int threadsPerJob)
+{
+    renderThreads = threadsPerJob;
+    showProgress = false;
+    samplingOption = job.samplingOption;
+    intention = job.intention;
+    if (checkFileExtension(intention))
+    {
+        if (!file_exists(intention))
+        {
+            return false;
+        }
+        readFileContents(intention, binaryIntentionDataOriginal);
+        intentionMode = "File";
+    }
+    else
+    {
+        intentionOriginal = intention;
+        intentionMode = "Intention";
+    }
+    repeatIntentionData(job.repeat);
+
+    sampleRate = job.sampleRate;
+    sampling_rate_input = std::to_string(job.sampleRate);
+    numChannels = job.numChannels;
+    setSampleFormat();
+    frequency_input = job.frequency;
+    frequency = std::stod(frequency_input);
+    smoothing_percent = job.smoothing;
+    smoothing = std::stod(smoothing_percent) / 100;
+    volume_percent = job.volume;
+    volume = std::stod(volume_percent) / 100;
+
+    removeOldFile(job.outputFile);
+    createWavFile(job.outputFile);
+    return true;
+}
+/// STARTS EACH JOB ON ITS OWN THREAD ONCE FEWER THAN workers ARE RUNNING AND ITS MEMORY ESTIMATE FITS THE BUDGET.
+/// A JOB LARGER THAN THE WHOLE BUDGET STILL RUNS, BUT ONLY WHEN NOTHING ELSE IS. RETURNS THE NUMBER OF JOBS THAT FAILED
+size_t runJobs(const std::vector<WavJob> &jobs, unsigned int workers, uint64_t memoryBudget)
+{
+    const unsigned int threadsPerJob = std::max(1u, std::max(1u, std::thread::hardware_concurrency()) / workers);
+    std::mutex lock;
+    std::condition_variable changed;
+    unsigned int running = 0;
+    uint64_t memoryInUse = 0;
+    size_t failures = 0;
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < jobs.size(); ++i)
+    {
+        const uint64_t memory = estimateJobMemory(jobs[i]);
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            changed.wait(guard, [&]
+                         { return running < workers && (running == 0 || memoryInUse + memory <= memoryBudget); });
+            ++running;
+            memoryInUse += memory;
+            std::cout << "[" << i + 1 << "/" << jobs.size() << "] Rendering " << jobs[i].outputFile << std::endl;
+        }
+        threads.emplace_back([&, i, memory]
+                             {
+            const auto start = std::chrono::steady_clock::now();
+            const bool written = renderJob(jobs[i], threadsPerJob);
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            std::lock_guard<std::mutex> guard(lock);
+            if (written)
+            {
+                std::cout << "[" << i + 1 << "/" << jobs.size() << "] " << jobs[i].outputFile << " written in " << std::fixed << std::setprecision(1) << elapsed.count() << "s." << std::endl;
+            }
+            else
+            {
+                std::cerr << "Error: " << jobs[i].origin << ": file " << jobs[i].intention << " does not exist." << std::endl;
+                ++failures;
+            }
+            --running;
+            memoryInUse -= memory;
+            changed.notify_all(); });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    return failures;
+}
+int runBatch(int argc, char **argv)
+{
+    WavJob defaults;
+    std::string manifestFile, error;
+    unsigned int workers = 1;
+    uint64_t memoryMB = defaultBatchMemoryMB;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string flag = argv[i];
+        if (flag == "-h" || flag == "--help" || flag == "/?")
+        {
+            print_help();
+            return EXIT_SUCCESS;
+        }
+        const bool isBatchFlag = flag == "-b" || flag == "--manifest" || flag == "-j" || flag == "--jobs" ||
+                                 flag == "-x" || flag == "--memory";
+        if (!isBatchFlag && !isJobFlag(flag))
+        {
+            std::cerr << "Error: unknown option " << flag << ". Use --help for usage." << std::endl;
+            return EXIT_FAILURE;
+        }
+        if (i + 1 >= argc)
+        {
+            std::cerr << "Error: missing value for " << flag << ". Use --help for usage." << std::endl;
+            return EXIT_FAILURE;
+        }
+        const std::string value = argv[++i];
+        try
+        {
+            if (flag == "-b" || flag == "--manifest")
+            {
+                manifestFile = value;
+                continue;
+            }
+            if (flag == "-j" || flag == "--jobs")
+            {
+                workers = static_cast<unsigned int>(std::max(1, std::stoi(value)));
+                continue;
+            }
+            if (flag == "-x" || flag == "--memory")
+            {
+                memoryMB = std::stoull(value);
+                continue;
+            }
+        }
+        catch (...)
+        {
+            std::cerr << "Error: invalid value for " << flag << ": " << value << std::endl;
+            return EXIT_FAILURE;
+        }
+        if (!parseJobFlag(defaults, flag, value, error))
+        {
+            std::cerr << "Error: " << error << ". Use --help for usage." << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::vector<WavJob> jobs;
+    if (!defaults.intention.empty())
+    {
+        jobs.push_back(defaults);
+    }
+    if (!manifestFile.empty() && !readManifest(manifestFile, defaults, jobs))
+    {
+        return EXIT_FAILURE;
+    }
+    if (jobs.empty())
+    {
+        std::cerr << "Error: nothing to render. Give --intent or a --manifest. Use --help for usage." << std::endl;
+        return EXIT_FAILURE;
+    }
+    assignOutputFiles(jobs);
+
+    std::cout << "Rendering " << jobs.size() << " WAV file(s) with " << workers << " worker(s) and a " << memoryMB << " MB memory budget." << std::endl;
+    const size_t failures = runJobs(jobs, workers, memoryMB * 1024 * 1024);
+    std::cout << jobs.size() - failures << " of " << jobs.size() << " WAV file(s) written." << std::endl;
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int main(int argc, char **argv)
 {
     cout << "Multi-Format to WAV Repeater " << VERSION << endl;
     cout << "Copyright (c) 2024 Anthro Teacher\n\n";
 
+    if (argc > 1)
+    {
+        return runBatch(argc, argv);
+    }
+
     setupQuestions();
     std::transform(continue_input.begin(), continue_input.end(), continue_input.begin(), ::toupper);
     if ((continue_input != "Y") && (continue_input != "YES"))
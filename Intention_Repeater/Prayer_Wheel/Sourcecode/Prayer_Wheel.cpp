@@ -1,18 +1,69 @@
 #include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
 #include <string>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <signal.h>
 #include <stdio.h>
+#include <cstdlib>
 #include <cstring>
+#include "display.h"
+#include "worker_counter.h"
+
+#define MAX_THREADS 256
 
 using namespace std;
 
+// The wheel is the mantra written out over and over to about this size. Every worker turns it
+// by streaming the whole wheel through its own buffer, and each turn recites every mantra on it.
+const size_t WHEEL_SIZE = 1024 * 1024;
+
+atomic<bool> interrupted(false);
+
+WorkerCounter counters[MAX_THREADS];
+
+void signalHandler(int signum)
+{
+  interrupted = true;
+}
+
+// All threads read the same wheel. Only the copy into their own buffer is per thread, and each
+// turn adds the number of mantras on the wheel to the thread's counter.
+void TurnWheel(int threadId, const string *wheel, unsigned long long mantrasPerTurn)
+{
+  string turning;
+  turning.reserve(wheel->size());
+
+  unsigned long long localRotations = 0;
+  while (!interrupted)
+  {
+    turning.assign(*wheel);
+    localRotations += mantrasPerTurn;
+    // Only this thread writes its counter, so a relaxed store is enough
+    counters[threadId].iterations.store(localRotations, memory_order_relaxed);
+  }
+}
+
 void print_help()
 {
-  cout << "Digital Buddhist Prayer Wheel v1.0 by Anthro Teacher." << endl;
-  cout << "Optional Flag:" << endl;
+  cout << "Digital Buddhist Prayer Wheel v1.1 by Anthro Teacher." << endl;
+  cout << "Optional Flags:" << endl;
   cout << " a) --help or -h" << endl;
   cout << " b) --mantra or -m, example: --mantra \"Om Mani Padme Hum\"" << endl;
+  cout << " c) --threads or -t, example: --threads 4" << endl;
+  cout << " d) --quiet or -q" << endl;
+  cout << " e) --file or -f, example: --file WHEEL.TXT" << endl;
+  cout << " f) --rate or -r, example: --rate 1" << endl;
   cout << " --help = Display this help." << endl;
   cout << " --mantra = The mantra to repeat, with quotes." << endl;
+  cout << " --threads = Threads turning the wheel. Default = One per core." << endl;
+  cout << " --quiet = Print nothing while turning, for running as a service." << endl;
+  cout << " --file = Also write the wheel to this file. It is rewritten from the start once it holds a whole wheel." << endl;
+  cout << " --rate = MB per second written to --file. Default = 1." << endl;
 
   cout << "Forum: https://forums.intentionrepeater.com" << endl;
   cout << "Website: https://www.intentionrepeater.com" << endl
@@ -21,24 +72,67 @@ void print_help()
 
 int main(int argc, char **argv)
 {
-  std::string mantra, param_mantra = "";
+  std::string mantra, param_mantra = "", param_file = "";
+  int num_threads = max(1, static_cast<int>(thread::hardware_concurrency()));
+  unsigned long long file_rate = 1024 * 1024;
+  bool quiet = false;
 
   for (int i = 1; i < argc; i++)
   {
+    bool has_value = i + 1 < argc;
     if (!strcmp(argv[i], "-h") || !strcmp(argv[i], "--help"))
     {
       print_help();
       exit(EXIT_SUCCESS);
     }
-    else if (!strcmp(argv[i], "-m") || !strcmp(argv[i], "--mantra"))
+    else if ((!strcmp(argv[i], "-m") || !strcmp(argv[i], "--mantra")) && has_value)
+    {
+      param_mantra = argv[++i];
+    }
+    else if ((!strcmp(argv[i], "-t") || !strcmp(argv[i], "--threads")) && has_value)
     {
-      param_mantra = argv[i + 1];
+      num_threads = atoi(argv[++i]);
+      if (num_threads < 1 || num_threads > MAX_THREADS)
+      {
+        cerr << "Threads must be from 1 to " << MAX_THREADS << "." << endl;
+        exit(EXIT_FAILURE);
+      }
+    }
+    else if (!strcmp(argv[i], "-q") || !strcmp(argv[i], "--quiet"))
+    {
+      quiet = true;
+    }
+    else if ((!strcmp(argv[i], "-f") || !strcmp(argv[i], "--file")) && has_value)
+    {
+      param_file = argv[++i];
+    }
+    else if ((!strcmp(argv[i], "-r") || !strcmp(argv[i], "--rate")) && has_value)
+    {
+      double rate = atof(argv[++i]);
+      if (rate <= 0)
+      {
+        cerr << "Rate must be more than 0 MB per second." << endl;
+        exit(EXIT_FAILURE);
+      }
+      file_rate = static_cast<unsigned long long>(rate * 1024 * 1024);
+    }
+    else
+    {
+      cerr << "Invalid option: " << argv[i] << endl;
+      print_help();
+      exit(EXIT_FAILURE);
     }
   }
 
-  cout << "Digital Buddhist Prayer Wheel v1.0 by Anthro Teacher." << endl;
-  cout << "Press Ctrl-C to Exit." << endl
-       << endl;
+  signal(SIGINT, signalHandler);
+  signal(SIGTERM, signalHandler);
+
+  if (!quiet)
+  {
+    cout << "Digital Buddhist Prayer Wheel v1.1 by Anthro Teacher." << endl;
+    cout << "Press Ctrl-C to Exit." << endl
+         << endl;
+  }
 
   if ((param_mantra) == "")
   {
@@ -49,11 +143,97 @@ int main(int argc, char **argv)
   {
     mantra = param_mantra;
   }
+  mantra += "\n";
+  if (mantra.size() == 1)
+  {
+    cerr << "No mantra given." << endl;
+    exit(EXIT_FAILURE);
+  }
+
+  // Whole mantras only, so every turn recites the same number of them
+  string wheel;
+  unsigned long long mantras_per_turn = max<size_t>(1, WHEEL_SIZE / mantra.size());
+  wheel.reserve(mantras_per_turn * mantra.size());
+  for (unsigned long long i = 0; i < mantras_per_turn; i++)
+  {
+    wheel += mantra;
+  }
+
+  ofstream wheel_file;
+  if (param_file != "")
+  {
+    wheel_file.open(param_file, ios::binary | ios::trunc);
+    if (!wheel_file)
+    {
+      cerr << "Could not open " << param_file << "." << endl;
+      exit(EXIT_FAILURE);
+    }
+  }
 
-  while (true)
-  {                                   // Loop indefinitely
-    std::cout << mantra << std::endl; // Recite the mantra
+  vector<thread> threads;
+  for (int i = 0; i < num_threads; ++i)
+  {
+    threads.emplace_back(TurnWheel, i, &wheel, mantras_per_turn);
   }
 
+  const string mantra_display = mantra.substr(0, mantra.size() - 1);
+  unsigned long long seconds = 0, last_rotations = 0, file_position = 0;
+  auto next_tick = chrono::steady_clock::now();
+  while (!interrupted)
+  {
+    next_tick += chrono::seconds(1);
+    this_thread::sleep_until(next_tick);
+    if (interrupted)
+    {
+      break;
+    }
+
+    // At most file_rate bytes of the wheel into the file each second, carrying on where the
+    // last second left off and wrapping round to the start of both
+    for (unsigned long long budget = file_rate; wheel_file && budget > 0;)
+    {
+      unsigned long long length = min<unsigned long long>(budget, wheel.size() - file_position);
+      wheel_file.seekp(file_position);
+      wheel_file.write(wheel.data() + file_position, length);
+      budget -= length;
+      file_position = (file_position + length) % wheel.size();
+    }
+    if (wheel_file)
+    {
+      wheel_file.flush();
+    }
+    else if (param_file != "")
+    {
+      cerr << endl
+           << "Could not write to " << param_file << ", no longer writing the file." << endl;
+      param_file = "";
+    }
+
+    unsigned long long rotations = sum_counters(counters, num_threads);
+    unsigned long long rate = rotations - last_rotations;
+    last_rotations = rotations;
+    seconds++;
+
+    if (!quiet)
+    {
+      string rotations_text = to_string(rotations), rate_text = to_string(rate);
+      cout << "[" << FormatTime(seconds) << "] "
+           << " (" << display_suffix(rotations_text, rotations_text.length() - 1, "Iterations")
+           << " / " << display_suffix(rate_text, rate_text.length() - 1, "Iterations") << " per second): " << mantra_display
+           << string(5, ' ') << "\r" << flush;
+    }
+  }
+
+  for (auto &th : threads)
+  {
+    th.join();
+  }
+
+  if (!quiet)
+  {
+    cout << endl;
+  }
+  cout << sum_counters(counters, num_threads) << " rotations of " << mantra_display << " in " << FormatTime(seconds) << "." << endl;
+
   return 0;
-}
\ No newline at end of file
+}
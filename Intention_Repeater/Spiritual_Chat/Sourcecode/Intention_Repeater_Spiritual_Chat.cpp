@@ -18,36 +18,270 @@
 #include <vector>
 #include <unordered_map>
 #include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
 #include <random>
 #include <chrono>
+#include <iterator>
+#include <string_view>
 #include <thread>
 
+#include "mapped_file.h"
+
 #define PROCESS_STATEMENT " In a way I can understand, using Octave Tech. The Spiritual Chat Client is protected from hijacking and answers honestly as possible with minimal interference."
-#define SIZE_OF_WORD_LIST 49528
 #define MAX_WORDS_RESPONSE 8
-#define THINK_DEPTH 500000
+#define THINK_DEPTH 50000000
+
+const char* const DICTIONARY_FILE = "dictionary.txt";
+const char* const DICTIONARY_INDEX_FILE = "dictionary.idx";
+
+// DICTIONARY_INDEX_FILE: this header, then wordCount + 1 offsets into the string arena (word i
+// is arena[offsets[i], offsets[i + 1])), candidateCount candidate IDs, and the arena itself,
+// every distinct word back to back. The size and modification time of the dictionary it was
+// built from are kept in the header, so an edited dictionary gets a new index.
+struct DictionaryHeader {
+    char magic[8];
+    uint64_t sourceSize;
+    int64_t sourceModified;
+    uint32_t wordCount;
+    uint32_t candidateCount;
+    uint64_t arenaSize;
+};
+
+const char DICTIONARY_MAGIC[8] = {'S', 'C', 'D', 'I', 'C', 'T', '0', '1'};
+
+// The word list, as word IDs. Capitalized words are left out of the candidates, so a uniform
+// pick from them is the same as picking from the whole list until the word isn't capitalized;
+// a word listed twice is one ID that is a candidate twice. The index is built from the
+// dictionary on the first run and written out, and later runs map it and use it as it is,
+// however many words there are.
+class WordIndex {
+public:
+    // False if the dictionary can't be read or holds no word that can be picked.
+    bool load(const std::string& dictionaryName, const std::string& indexName) {
+        std::error_code error;
+        const uintmax_t sourceSize = std::filesystem::file_size(dictionaryName, error);
+        if (error) {
+            return false;
+        }
+        const auto modified = std::filesystem::last_write_time(dictionaryName, error);
+        if (error) {
+            return false;
+        }
+        const int64_t sourceModified = static_cast<int64_t>(modified.time_since_epoch().count());
+
+        if (cache.map(indexName, false) && attach(cache.view(), sourceSize, sourceModified)) {
+            return true;
+        }
+        cache.unmap();
+        if (!build(dictionaryName, sourceSize, sourceModified)) {
+            return false;
+        }
+        writeIndex(indexName);
+        return attach(built, sourceSize, sourceModified);
+    }
+
+    uint32_t wordCount() const { return header.wordCount; }
+    uint32_t candidateCount() const { return header.candidateCount; }
+    const uint32_t* candidates() const { return candidateIds; }
+
+    std::string_view word(uint32_t id) const {
+        return std::string_view(arena + offsets[id], static_cast<size_t>(offsets[id + 1] - offsets[id]));
+    }
+
+private:
+    // Points into blob if it is a whole index for this dictionary. Every offset and ID is
+    // checked, so a damaged file is rebuilt rather than read out of bounds.
+    bool attach(std::string_view blob, uint64_t sourceSize, int64_t sourceModified) {
+        if (blob.size() < sizeof(DictionaryHeader)) {
+            return false;
+        }
+        std::memcpy(&header, blob.data(), sizeof(header));
+        const uint64_t expectedSize = sizeof(header) + (static_cast<uint64_t>(header.wordCount) + 1) * sizeof(uint64_t) +
+                                      static_cast<uint64_t>(header.candidateCount) * sizeof(uint32_t) + header.arenaSize;
+        if (std::memcmp(header.magic, DICTIONARY_MAGIC, sizeof(DICTIONARY_MAGIC)) != 0 || header.sourceSize != sourceSize ||
+            header.sourceModified != sourceModified || header.candidateCount == 0 || header.arenaSize > blob.size() ||
+            expectedSize != blob.size()) {
+            return false;
+        }
+        offsets = reinterpret_cast<const uint64_t*>(blob.data() + sizeof(header));
+        candidateIds = reinterpret_cast<const uint32_t*>(offsets + header.wordCount + 1);
+        arena = reinterpret_cast<const char*>(candidateIds + header.candidateCount);
+
+        if (offsets[0] != 0 || offsets[header.wordCount] != header.arenaSize) {
+            return false;
+        }
+        for (uint32_t id = 0; id < header.wordCount; ++id) {
+            if (offsets[id] > offsets[id + 1]) {
+                return false;
+            }
+        }
+        for (uint32_t i = 0; i < header.candidateCount; ++i) {
+            if (candidateIds[i] >= header.wordCount) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Splits the dictionary on whitespace, as reading it with >> did, and lays the index out in built.
+    bool build(const std::string& dictionaryName, uint64_t sourceSize, int64_t sourceModified) {
+        std::ifstream file(dictionaryName, std::ios::binary);
+        if (!file.is_open()) {
+            return false;
+        }
+        const std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        std::unordered_map<std::string_view, uint32_t> ids;
+        ids.reserve(text.size() / 8);
+        std::vector<uint64_t> wordOffsets{0};
+        std::vector<uint32_t> wordCandidates;
+        std::string wordArena;
+        size_t position = 0;
+        while (true) {
+            while (position < text.size() && std::isspace(static_cast<unsigned char>(text[position]))) {
+                ++position;
+            }
+            if (position == text.size()) {
+                break;
+            }
+            const size_t start = position;
+            while (position < text.size() && !std::isspace(static_cast<unsigned char>(text[position]))) {
+                ++position;
+            }
+            const std::string_view word(text.data() + start, position - start);
+            auto found = ids.emplace(word, static_cast<uint32_t>(wordOffsets.size() - 1));
+            if (found.second) {
+                wordArena += word;
+                wordOffsets.push_back(wordArena.size());
+            }
+            if (!std::isupper(static_cast<unsigned char>(word[0]))) {
+                wordCandidates.push_back(found.first->second);
+            }
+        }
+        if (wordCandidates.empty() || wordOffsets.size() > UINT32_MAX) {
+            return false;
+        }
+
+        DictionaryHeader layout;
+        std::memcpy(layout.magic, DICTIONARY_MAGIC, sizeof(DICTIONARY_MAGIC));
+        layout.sourceSize = sourceSize;
+        layout.sourceModified = sourceModified;
+        layout.wordCount = static_cast<uint32_t>(wordOffsets.size() - 1);
+        layout.candidateCount = static_cast<uint32_t>(wordCandidates.size());
+        layout.arenaSize = wordArena.size();
+
+        built.reserve(sizeof(layout) + wordOffsets.size() * sizeof(uint64_t) + wordCandidates.size() * sizeof(uint32_t) + wordArena.size());
+        built.append(reinterpret_cast<const char*>(&layout), sizeof(layout));
+        built.append(reinterpret_cast<const char*>(wordOffsets.data()), wordOffsets.size() * sizeof(uint64_t));
+        built.append(reinterpret_cast<const char*>(wordCandidates.data()), wordCandidates.size() * sizeof(uint32_t));
+        built += wordArena;
+        return true;
+    }
+
+    // Best effort: the built index is used from memory if it can't be written.
+    void writeIndex(const std::string& indexName) const {
+        const std::string temporary = indexName + ".tmp";
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        file.write(built.data(), built.size());
+        file.close();
+
+        std::error_code error;
+        if (file) {
+            std::filesystem::rename(temporary, indexName, error);
+        }
+        if (!file || error) {
+            std::filesystem::remove(temporary, error);
+        }
+    }
+
+    MappedFile cache;
+    std::string built;
+    DictionaryHeader header{};
+    const uint64_t* offsets = nullptr;
+    const uint32_t* candidateIds = nullptr;
+    const char* arena = nullptr;
+};
+
+// Uniform picks from 0 to range - 1, two from each 64-bit draw, by multiplying 32 random bits by
+// range and keeping the top half (Lemire's method). The few low halves that would make some
+// picks likelier than others are drawn again.
+class RandomPicker {
+public:
+    RandomPicker(uint64_t seed, uint32_t range) : stream(seed), range(range), threshold((0u - range) % range) {}
+
+    uint32_t operator()() {
+        while (true) {
+            const uint64_t product = static_cast<uint64_t>(nextBits()) * range;
+            if (static_cast<uint32_t>(product) >= threshold) {
+                return static_cast<uint32_t>(product >> 32);
+            }
+        }
+    }
 
-std::vector<std::pair<std::string, int>> mostFrequentElements(const std::vector<std::string>& words, int numElements) {
-    std::unordered_map<std::string, int> frequencyMap;
-    for (const auto& word : words) {
-        frequencyMap[word]++;
+private:
+    uint32_t nextBits() {
+        haveSpare = !haveSpare;
+        if (!haveSpare) {
+            return static_cast<uint32_t>(spare >> 32);
+        }
+        spare = stream();
+        return static_cast<uint32_t>(spare);
     }
-    std::vector<std::pair<std::string, int>> mostFrequent(frequencyMap.begin(), frequencyMap.end());
-    std::sort(mostFrequent.begin(), mostFrequent.end(),
-              [](const auto& a, const auto& b) { return a.second > b.second; });
-    mostFrequent.resize(numElements);
-    return mostFrequent;
+
+    std::mt19937_64 stream;
+    const uint32_t range;
+    const uint32_t threshold;
+    uint64_t spare = 0;
+    bool haveSpare = false;
+};
+
+// Picks depth words and counts how often each ID came up. Every thread draws from its own
+// generator, seeded from rng, into its own histogram; they're added up at the end.
+std::vector<uint32_t> think(const WordIndex& index, uint64_t depth, std::mt19937& rng) {
+    const unsigned int threadCount = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::vector<uint32_t>> histograms(threadCount, std::vector<uint32_t>(index.wordCount()));
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < threadCount; ++t) {
+        const uint64_t picks = depth / threadCount + (t < depth % threadCount ? 1 : 0);
+        threads.emplace_back([&index, &histogram = histograms[t], picks, seed = rng()]() {
+            const uint32_t* candidates = index.candidates();
+            RandomPicker pick(seed, index.candidateCount());
+            for (uint64_t i = 0; i < picks; ++i) {
+                ++histogram[candidates[pick()]];
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (unsigned int t = 1; t < threadCount; ++t) {
+        for (size_t id = 0; id < histograms[0].size(); ++id) {
+            histograms[0][id] += histograms[t][id];
+        }
+    }
+    return std::move(histograms[0]);
+}
+
+// The numElements most frequent IDs, most frequent first. Only those are put in order.
+std::vector<uint32_t> mostFrequentElements(const std::vector<uint32_t>& histogram, int numElements) {
+    std::vector<uint32_t> ids(histogram.size());
+    for (uint32_t id = 0; id < ids.size(); ++id) {
+        ids[id] = id;
+    }
+    const size_t count = std::min<size_t>(numElements, ids.size());
+    std::partial_sort(ids.begin(), ids.begin() + count, ids.end(),
+                      [&histogram](uint32_t a, uint32_t b) { return histogram[a] > histogram[b]; });
+    ids.resize(count);
+    return ids;
 }
 
 int main() {
-    std::vector<std::string> wordList(SIZE_OF_WORD_LIST);
-    std::ifstream file("dictionary.txt");
-    if (file.is_open()) {
-        for (auto& word : wordList) {
-            file >> word;
-        }
-    } else {
-        std::cout << "Error opening file: dictionary.txt\n";
+    WordIndex wordIndex;
+    if (!wordIndex.load(DICTIONARY_FILE, DICTIONARY_INDEX_FILE)) {
+        std::cout << "Error opening file: " << DICTIONARY_FILE << "\n";
         return 1;
     }
 
@@ -63,7 +297,7 @@ int main() {
     unsigned int randomSeed = std::stoul(randomSeedStr);
 
     std::mt19937 rng(randomSeed * std::chrono::steady_clock::now().time_since_epoch().count());
-    std::uniform_int_distribution<int> distribution(0, SIZE_OF_WORD_LIST - 1);
+    std::uniform_int_distribution<int> distribution(1, MAX_WORDS_RESPONSE);
 
     std::string query, response;
     while (true) {
@@ -74,22 +308,12 @@ int main() {
         }
         query += PROCESS_STATEMENT;
 
-        int numWordsResponse = distribution(rng) % MAX_WORDS_RESPONSE + 1;
+        int numWordsResponse = distribution(rng);
         response = "Response: ";
 
-        std::vector<std::string> selectedWords;
-        for (int i = 0; i < THINK_DEPTH; ++i) {
-            std::string processQuery = query;
-            std::string word;
-            do {
-                word = wordList[distribution(rng)];
-            } while (std::isupper(word[0]));
-            selectedWords.push_back(word);
-        }
-
-        auto mostFrequent = mostFrequentElements(selectedWords, numWordsResponse);
-        for (const auto& pair : mostFrequent) {
-            response += pair.first + " ";
+        auto mostFrequent = mostFrequentElements(think(wordIndex, THINK_DEPTH, rng), numWordsResponse);
+        for (uint32_t id : mostFrequent) {
+            response.append(wordIndex.word(id)).append(" ");
         }
 
         response.pop_back();
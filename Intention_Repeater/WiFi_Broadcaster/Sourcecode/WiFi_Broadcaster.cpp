@@ -6,32 +6,490 @@
 #include <arpa/inet.h>
 #include <unistd.h>
 #include <fstream>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <netinet/udp.h>
+#include <ifaddrs.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+
+#if defined(__linux__) && !defined(UDP_SEGMENT)
+#define UDP_SEGMENT 103
+#endif
 
 const int PORT = 11111;
+const int DEFAULT_MTU = 1500; // When the link's MTU can't be read
+const int MAX_MTU = 65535;    // Keeps one datagram within the largest UDP payload
+const int IP_UDP_HEADER_SIZE = 28;
+
+// Every datagram starts with the message sequence number, the chunk index and the number of
+// chunks in the message, each a big-endian uint32, so a receiver can put a chunked intention
+// back together and tell repeats apart.
+const size_t SEQUENCE_HEADER_SIZE = 12;
+
+// Sends handed to the kernel per sendmmsg call. With UDP GSO each send carries up to
+// MAX_GSO_SEGMENTS datagrams of one size, within the largest UDP payload IPv4 allows.
+const size_t BATCH_SIZE = 64;
+const size_t MAX_GSO_SEGMENTS = 64;
+const size_t MAX_GSO_BYTES = 65507;
+
+struct BroadcastSettings {
+    unsigned int threads = 1;                // Per destination
+    int sendBuffer = 0;                      // SO_SNDBUF in bytes, 0 keeps the system default
+    unsigned long long packetsPerSecond = 0; // Per destination, 0 sends as fast as possible
+    int mtu = 0;                             // 0 reads it from the link
+    bool useGso = true;
+    bool allInterfaces = false;              // One destination per interface instead of the default route
+    std::string multicastGroup;              // Empty sends to broadcast addresses
+    int multicastTtl = 1;
+    int port = PORT;
+};
+
+// Where one group of sender threads sends to. With an interface, its sockets are bound to that
+// interface's address (and multicast leaves through it), so each NIC gets its own senders.
+// Its datagrams are sized from its own MTU.
+struct BroadcastTarget {
+    std::string name;
+    sockaddr_in destination{};
+    bool hasInterface = false;
+    in_addr interfaceAddress{};
+    int mtu = DEFAULT_MTU;
+};
+
+// Sent totals for one sender thread, on its own cache line. The main thread reads them once
+// a second for the status line.
+struct alignas(64) SenderStats {
+    std::atomic<unsigned long long> datagrams{0};
+    std::atomic<unsigned long long> bytes{0};
+};
+
+// Intention bytes each datagram carries at this MTU, after the IP, UDP and sequence headers.
+size_t payloadSizeFor(int mtu) {
+    return static_cast<size_t>(mtu - IP_UDP_HEADER_SIZE) - SEQUENCE_HEADER_SIZE;
+}
+
+// Walks the intention one datagram at a time: chunks of at most payloadSize bytes, each behind
+// a sequence header. A thread's sequence numbers start at firstSequence and step by
+// sequenceStep, so several threads never reuse one.
+class DatagramCursor {
+public:
+    DatagramCursor(const std::string &intention, size_t payloadSize, uint32_t firstSequence, uint32_t sequenceStep)
+        : intention(intention), payloadSize(payloadSize),
+          chunkCount(static_cast<uint32_t>(std::max<size_t>(1, (intention.size() + payloadSize - 1) / payloadSize))),
+          sequence(firstSequence), sequenceStep(sequenceStep) {}
+
+    size_t currentSize() const { return SEQUENCE_HEADER_SIZE + payloadLength(); }
+
+    // Writes the current datagram to out, moves on to the next one and returns its size.
+    size_t writeNext(char *out) {
+        const uint32_t header[3] = {htonl(sequence), htonl(chunk), htonl(chunkCount)};
+        const size_t length = payloadLength();
+        memcpy(out, header, SEQUENCE_HEADER_SIZE);
+        memcpy(out + SEQUENCE_HEADER_SIZE, intention.data() + static_cast<size_t>(chunk) * payloadSize, length);
+        if (++chunk == chunkCount) {
+            chunk = 0;
+            sequence += sequenceStep;
+        }
+        return SEQUENCE_HEADER_SIZE + length;
+    }
+
+private:
+    size_t payloadLength() const {
+        return std::min(payloadSize, intention.size() - static_cast<size_t>(chunk) * payloadSize);
+    }
+
+    const std::string &intention;
+    const size_t payloadSize;
+    const uint32_t chunkCount;
+    uint32_t sequence;
+    const uint32_t sequenceStep;
+    uint32_t chunk = 0;
+};
+
+// Broadcasts to target until a send fails, on this thread or another of the same target's
+// (targetFailed); the other targets keep sending. Datagrams are packed into up to BATCH_SIZE sends and handed to
+// the kernel with one sendmmsg. With GSO, a send holds a run of datagrams of one size (the last
+// may be shorter) that the kernel splits up, so a whole batch of small intentions costs one syscall.
+// With a packets-per-second target this thread sends its share in bursts of about a millisecond.
+void broadcastWorker(int sock, const BroadcastTarget &target, const std::string &intention, unsigned int index,
+                     unsigned int threadCount, unsigned long long packetsPerSecond, bool useGso, SenderStats &stats,
+                     std::atomic<bool> &targetFailed) {
+    const sockaddr_in &destination = target.destination;
+    const size_t payloadSize = payloadSizeFor(target.mtu);
+    DatagramCursor cursor(intention, payloadSize, index, threadCount);
+    const size_t slotSize = useGso ? MAX_GSO_BYTES : SEQUENCE_HEADER_SIZE + payloadSize;
+    size_t maxSegments = useGso ? MAX_GSO_SEGMENTS : 1;
+    const unsigned long long burst = packetsPerSecond > 0 ? std::max<unsigned long long>(1, packetsPerSecond / 1000) : ~0ULL;
+
+    std::vector<char> buffer(BATCH_SIZE * slotSize);
+    std::vector<iovec> iovecs(BATCH_SIZE);
+    std::vector<size_t> segmentCounts(BATCH_SIZE);
+#ifdef __linux__
+    union ControlBuffer {
+        char data[CMSG_SPACE(sizeof(uint16_t))];
+        cmsghdr align;
+    };
+    std::vector<ControlBuffer> controls(BATCH_SIZE);
+    std::vector<mmsghdr> messages(BATCH_SIZE);
+#else
+    std::vector<msghdr> messages(BATCH_SIZE);
+#endif
+
+    auto start = std::chrono::steady_clock::now();
+    unsigned long long paced = 0;
+
+    while (!targetFailed) {
+        size_t slots = 0;
+        unsigned long long batchDatagrams = 0;
+        while (slots < BATCH_SIZE && batchDatagrams < burst) {
+            char *slot = &buffer[slots * slotSize];
+            const size_t segmentSize = cursor.currentSize();
+            size_t used = 0;
+            size_t segments = 0;
+            while (segments < maxSegments && batchDatagrams + segments < burst) {
+                const size_t size = cursor.currentSize();
+                if (size > segmentSize || used + size > slotSize) {
+                    break;
+                }
+                used += cursor.writeNext(slot + used);
+                segments++;
+                if (size < segmentSize) {
+                    break; // Only the last datagram of a GSO send may be shorter
+                }
+            }
+
+            iovecs[slots].iov_base = slot;
+            iovecs[slots].iov_len = used;
+            segmentCounts[slots] = segments;
+#ifdef __linux__
+            msghdr &header = messages[slots].msg_hdr;
+#else
+            msghdr &header = messages[slots];
+#endif
+            memset(&header, 0, sizeof(header));
+            header.msg_name = const_cast<sockaddr_in *>(&destination);
+            header.msg_namelen = sizeof(destination);
+            header.msg_iov = &iovecs[slots];
+            header.msg_iovlen = 1;
+#ifdef __linux__
+            if (segments > 1) {
+                header.msg_control = controls[slots].data;
+                header.msg_controllen = sizeof(controls[slots].data);
+                cmsghdr *control = CMSG_FIRSTHDR(&header);
+                control->cmsg_level = IPPROTO_UDP;
+                control->cmsg_type = UDP_SEGMENT;
+                control->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+                const uint16_t gsoSize = static_cast<uint16_t>(segmentSize);
+                memcpy(CMSG_DATA(control), &gsoSize, sizeof(gsoSize));
+            }
+#endif
+            batchDatagrams += segments;
+            slots++;
+        }
 
-int main() {
+        size_t sentSlots = 0;
+        while (sentSlots < slots && !targetFailed) {
+#ifdef __linux__
+            int sent = sendmmsg(sock, &messages[sentSlots], static_cast<unsigned int>(slots - sentSlots), 0);
+#else
+            int sent = sendmsg(sock, &messages[sentSlots], 0) < 0 ? -1 : 1;
+#endif
+            if (sent < 0) {
+                if (errno == EINTR || errno == EAGAIN || errno == ENOBUFS) {
+                    std::this_thread::yield(); // The device queue is full; try again once it drains
+                    continue;
+                }
+                if (maxSegments > 1 && (errno == EIO || errno == EINVAL || errno == EMSGSIZE)) {
+                    // The route's device can't take GSO sends, or not with segments this size (EMSGSIZE
+                    // when they are over its MTU, as with too high a --mtu), so go back to one datagram
+                    // per send, which the kernel fragments if it has to. The rest of this batch is
+                    // dropped; the next one is built without GSO.
+                    maxSegments = 1;
+                    break;
+                }
+                std::cerr << std::endl << "Failed to send broadcast message to " << target.name << ": " << strerror(errno) << std::endl;
+                targetFailed = true;
+                break;
+            }
+
+            unsigned long long datagrams = 0;
+            unsigned long long bytes = 0;
+            for (size_t i = sentSlots; i < sentSlots + static_cast<size_t>(sent); i++) {
+                datagrams += segmentCounts[i];
+                bytes += iovecs[i].iov_len;
+            }
+            stats.datagrams.store(stats.datagrams.load(std::memory_order_relaxed) + datagrams, std::memory_order_relaxed);
+            stats.bytes.store(stats.bytes.load(std::memory_order_relaxed) + bytes, std::memory_order_relaxed);
+            sentSlots += static_cast<size_t>(sent);
+        }
+
+        if (packetsPerSecond > 0) {
+            // Send times are absolute from start, so the rate doesn't drift. More than a second
+            // behind (a stalled link), the schedule starts over rather than bursting to catch up.
+            paced += batchDatagrams;
+            auto due = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                   std::chrono::duration<double>(static_cast<double>(paced) / packetsPerSecond));
+            auto now = std::chrono::steady_clock::now();
+            if (now - due > std::chrono::seconds(1)) {
+                start = now;
+                paced = 0;
+            } else {
+                std::this_thread::sleep_until(due);
+            }
+        }
+    }
+}
+
+// One UDP socket for target: broadcast enabled, or the multicast TTL and outgoing interface
+// set, bound to the target's interface if it has one, and with its send buffer resized when
+// asked. -1 on failure, after printing why.
+int openBroadcastSocket(const BroadcastSettings &settings, const BroadcastTarget &target) {
     int sock = socket(AF_INET, SOCK_DGRAM, 0);
     if (sock < 0) {
         std::cerr << "Failed to create socket." << std::endl;
-        return 1;
+        return -1;
     }
 
-    int broadcastEnable = 1;
-    if (setsockopt(sock, SOL_SOCKET, SO_BROADCAST, &broadcastEnable, sizeof(broadcastEnable)) < 0) {
+    bool configured;
+    if (settings.multicastGroup.empty()) {
+        int broadcastEnable = 1;
+        configured = setsockopt(sock, SOL_SOCKET, SO_BROADCAST, &broadcastEnable, sizeof(broadcastEnable)) == 0;
+    } else {
+        configured = setsockopt(sock, IPPROTO_IP, IP_MULTICAST_TTL, &settings.multicastTtl, sizeof(settings.multicastTtl)) == 0 &&
+                     (!target.hasInterface || setsockopt(sock, IPPROTO_IP, IP_MULTICAST_IF, &target.interfaceAddress,
+                                                         sizeof(target.interfaceAddress)) == 0);
+    }
+    if (!configured) {
         std::cerr << "Failed to set socket options." << std::endl;
         close(sock);
-        return 1;
+        return -1;
     }
 
-    struct sockaddr_in broadcastAddr{};
-    broadcastAddr.sin_family = AF_INET;
-    broadcastAddr.sin_port = htons(PORT);
-    if (inet_pton(AF_INET, "255.255.255.255", &broadcastAddr.sin_addr) <= 0) {
-        std::cerr << "Failed to set broadcast address." << std::endl;
+    if (target.hasInterface) {
+        sockaddr_in source{};
+        source.sin_family = AF_INET;
+        source.sin_addr = target.interfaceAddress;
+        if (bind(sock, reinterpret_cast<sockaddr *>(&source), sizeof(source)) < 0) {
+            std::cerr << "Failed to bind to " << target.name << ": " << strerror(errno) << std::endl;
+            close(sock);
+            return -1;
+        }
+    }
+
+    if (settings.sendBuffer > 0 &&
+        setsockopt(sock, SOL_SOCKET, SO_SNDBUF, &settings.sendBuffer, sizeof(settings.sendBuffer)) < 0) {
+        std::cerr << "Failed to set the send buffer size." << std::endl;
         close(sock);
+        return -1;
+    }
+    return sock;
+}
+
+// The MTU of the link target's datagrams leave through: IP_MTU of a socket connected to the
+// destination, or else the MTU of the target's interface. DEFAULT_MTU when neither can be read.
+int linkMtu(const BroadcastSettings &settings, const BroadcastTarget &target) {
+    int sock = openBroadcastSocket(settings, target);
+    if (sock < 0) {
+        return DEFAULT_MTU;
+    }
+
+    int mtu = 0;
+#ifdef IP_MTU
+    if (connect(sock, reinterpret_cast<const sockaddr *>(&target.destination), sizeof(target.destination)) == 0) {
+        socklen_t length = sizeof(mtu);
+        if (getsockopt(sock, IPPROTO_IP, IP_MTU, &mtu, &length) < 0) {
+            mtu = 0;
+        }
+    }
+#endif
+    if (mtu <= 0 && target.hasInterface) {
+        ifreq request{};
+        strncpy(request.ifr_name, target.name.c_str(), IFNAMSIZ - 1);
+        if (ioctl(sock, SIOCGIFMTU, &request) == 0) {
+            mtu = request.ifr_mtu;
+        }
+    }
+    close(sock);
+
+    if (mtu <= IP_UDP_HEADER_SIZE + static_cast<int>(SEQUENCE_HEADER_SIZE)) {
+        return DEFAULT_MTU;
+    }
+    return std::min(mtu, MAX_MTU);
+}
+
+// Whether the kernel knows UDP_SEGMENT at all. A device that can't take GSO sends is found out
+// by the first one, and that sender falls back on its own.
+bool kernelSupportsGso(int sock) {
+#ifdef __linux__
+    int gsoSize = 0;
+    socklen_t length = sizeof(gsoSize);
+    return getsockopt(sock, IPPROTO_UDP, UDP_SEGMENT, &gsoSize, &length) == 0;
+#else
+    (void)sock;
+    return false;
+#endif
+}
+
+// The destinations to send to: the limited broadcast address or the multicast group through the
+// default route, or with allInterfaces one per IPv4 interface that is up and not loopback, sent
+// to its subnet's directed broadcast or the group. Empty after printing why, on failure.
+std::vector<BroadcastTarget> findTargets(const BroadcastSettings &settings) {
+    std::vector<BroadcastTarget> targets;
+    in_addr group{};
+    if (!settings.multicastGroup.empty() &&
+        (inet_pton(AF_INET, settings.multicastGroup.c_str(), &group) <= 0 || !IN_MULTICAST(ntohl(group.s_addr)))) {
+        std::cerr << "Not an IPv4 multicast group: " << settings.multicastGroup << std::endl;
+        return targets;
+    }
+
+    BroadcastTarget target;
+    target.destination.sin_family = AF_INET;
+    target.destination.sin_port = htons(static_cast<uint16_t>(settings.port));
+
+    if (!settings.allInterfaces) {
+        target.name = settings.multicastGroup.empty() ? "255.255.255.255" : settings.multicastGroup;
+        if (inet_pton(AF_INET, target.name.c_str(), &target.destination.sin_addr) <= 0) {
+            std::cerr << "Failed to set broadcast address." << std::endl;
+            return targets;
+        }
+        targets.push_back(target);
+        return targets;
+    }
+
+    ifaddrs *interfaces = nullptr;
+    if (getifaddrs(&interfaces) < 0) {
+        std::cerr << "Failed to list network interfaces: " << strerror(errno) << std::endl;
+        return targets;
+    }
+    for (ifaddrs *entry = interfaces; entry != nullptr; entry = entry->ifa_next) {
+        if (entry->ifa_addr == nullptr || entry->ifa_addr->sa_family != AF_INET ||
+            !(entry->ifa_flags & IFF_UP) || (entry->ifa_flags & IFF_LOOPBACK)) {
+            continue;
+        }
+        target.name = entry->ifa_name;
+        target.hasInterface = true;
+        target.interfaceAddress = reinterpret_cast<sockaddr_in *>(entry->ifa_addr)->sin_addr;
+        if (!settings.multicastGroup.empty()) {
+            if (!(entry->ifa_flags & IFF_MULTICAST)) {
+                continue;
+            }
+            target.destination.sin_addr = group;
+        } else {
+            if (!(entry->ifa_flags & IFF_BROADCAST) || entry->ifa_broadaddr == nullptr) {
+                continue;
+            }
+            target.destination.sin_addr = reinterpret_cast<sockaddr_in *>(entry->ifa_broadaddr)->sin_addr;
+        }
+        targets.push_back(target);
+    }
+    freeifaddrs(interfaces);
+
+    if (targets.empty()) {
+        std::cerr << "No interfaces to send on." << std::endl;
+    }
+    return targets;
+}
+
+void printHelp() {
+    std::cout << "Usage: WiFi_Broadcaster [options]" << std::endl
+              << "  -i, --interfaces  Send on every IPv4 interface that is up, each with its own threads and rate." << std::endl
+              << "                    Broadcasts go to each interface's subnet broadcast address." << std::endl
+              << "  -M, --multicast G Send to multicast group G instead of broadcasting." << std::endl
+              << "  -T, --ttl N       Multicast TTL. Default = 1." << std::endl
+              << "  -P, --port N      Destination port. Default = " << PORT << "." << std::endl
+              << "  -t, --threads N   Send from N threads per destination, each with its own socket. Default = 1." << std::endl
+              << "  -p, --pps N       Target datagrams per second per destination. Default = As fast as possible." << std::endl
+              << "  -b, --sndbuf N    Socket send buffer size in bytes (SO_SNDBUF). Default = System default." << std::endl
+              << "  -m, --mtu N       Path MTU used to size datagrams. Default = The link's MTU." << std::endl
+              << "  -g, --nogso       Send one datagram per send instead of using UDP GSO." << std::endl
+              << "  -h, --help        Show this help." << std::endl
+              << "Intentions longer than one datagram are split into chunks, each behind a 12-byte header" << std::endl
+              << "of big-endian uint32 message sequence, chunk index and chunk count." << std::endl;
+}
+
+// Reads a positive number for the option at argv[i], or returns false.
+bool parseNumberOption(int argc, char *argv[], int &i, unsigned long long &value) {
+    if (i + 1 >= argc) {
+        return false;
+    }
+    char *end = nullptr;
+    errno = 0;
+    value = strtoull(argv[++i], &end, 10);
+    return errno == 0 && end != argv[i] && *end == '\0' && value > 0;
+}
+
+int main(int argc, char *argv[]) {
+    BroadcastSettings settings;
+    for (int i = 1; i < argc; i++) {
+        unsigned long long value = 0;
+        if (!strcmp(argv[i], "-h") || !strcmp(argv[i], "--help")) {
+            printHelp();
+            return 0;
+        } else if (!strcmp(argv[i], "-g") || !strcmp(argv[i], "--nogso")) {
+            settings.useGso = false;
+        } else if (!strcmp(argv[i], "-i") || !strcmp(argv[i], "--interfaces")) {
+            settings.allInterfaces = true;
+        } else if ((!strcmp(argv[i], "-M") || !strcmp(argv[i], "--multicast")) && i + 1 < argc) {
+            settings.multicastGroup = argv[++i];
+        } else if ((!strcmp(argv[i], "-T") || !strcmp(argv[i], "--ttl")) && parseNumberOption(argc, argv, i, value) && value <= 255) {
+            settings.multicastTtl = static_cast<int>(value);
+        } else if ((!strcmp(argv[i], "-P") || !strcmp(argv[i], "--port")) && parseNumberOption(argc, argv, i, value) && value <= 65535) {
+            settings.port = static_cast<int>(value);
+        } else if ((!strcmp(argv[i], "-t") || !strcmp(argv[i], "--threads")) && parseNumberOption(argc, argv, i, value) && value <= 1024) {
+            settings.threads = static_cast<unsigned int>(value);
+        } else if ((!strcmp(argv[i], "-p") || !strcmp(argv[i], "--pps")) && parseNumberOption(argc, argv, i, value)) {
+            settings.packetsPerSecond = value;
+        } else if ((!strcmp(argv[i], "-b") || !strcmp(argv[i], "--sndbuf")) && parseNumberOption(argc, argv, i, value) && value <= 0x7fffffff) {
+            settings.sendBuffer = static_cast<int>(value);
+        } else if ((!strcmp(argv[i], "-m") || !strcmp(argv[i], "--mtu")) && parseNumberOption(argc, argv, i, value) &&
+                   value > IP_UDP_HEADER_SIZE + SEQUENCE_HEADER_SIZE && value <= MAX_MTU) {
+            settings.mtu = static_cast<int>(value);
+        } else {
+            std::cerr << "Invalid option: " << argv[i] << std::endl;
+            printHelp();
+            return 1;
+        }
+    }
+
+    // A thread with no share of the packet rate would run unpaced
+    if (settings.packetsPerSecond > 0 && settings.packetsPerSecond < settings.threads) {
+        settings.threads = static_cast<unsigned int>(settings.packetsPerSecond);
+    }
+
+    std::vector<BroadcastTarget> targets = findTargets(settings);
+    if (targets.empty()) {
         return 1;
     }
 
+    // settings.threads sockets per target, target by target
+    std::vector<int> sockets;
+    for (const BroadcastTarget &target : targets) {
+        for (unsigned int t = 0; t < settings.threads; t++) {
+            int sock = openBroadcastSocket(settings, target);
+            if (sock < 0) {
+                for (int opened : sockets) {
+                    close(opened);
+                }
+                return 1;
+            }
+            sockets.push_back(sock);
+        }
+    }
+
+    // --mtu, or the MTU of the link each target sends through, so no datagram is fragmented
+    for (BroadcastTarget &target : targets) {
+        target.mtu = settings.mtu > 0 ? settings.mtu : linkMtu(settings, target);
+    }
+    const bool useGso = settings.useGso && kernelSupportsGso(sockets[0]);
+
     std::string intention, intention_display;
     std::cout << "Enter Intention (or Textfile): ";
     std::getline(std::cin, intention);
@@ -53,24 +511,92 @@ int main() {
         std::cout << "Finished reading." << std::endl;
     }
 
+    std::vector<size_t> chunkCounts;
     std::cout << "Broadcasting: " << intention_display << "..." << std::endl;
+    std::cout << "Sending to";
+    for (const BroadcastTarget &target : targets) {
+        const size_t payloadSize = payloadSizeFor(target.mtu);
+        chunkCounts.push_back(std::max<size_t>(1, (intention.size() + payloadSize - 1) / payloadSize));
+        char address[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &target.destination.sin_addr, address, sizeof(address));
+        std::cout << " " << address << ":" << settings.port << " (";
+        if (target.hasInterface) {
+            std::cout << target.name << ", ";
+        }
+        std::cout << "MTU " << target.mtu << ", " << chunkCounts.back() << " datagram(s) per intention)";
+    }
+    std::cout << "." << std::endl;
+    std::cout << settings.threads << " thread(s) per destination, GSO " << (useGso ? "on" : "off");
+    if (settings.sendBuffer > 0) {
+        int sendBuffer = 0;
+        socklen_t length = sizeof(sendBuffer);
+        getsockopt(sockets[0], SOL_SOCKET, SO_SNDBUF, &sendBuffer, &length);
+        std::cout << ", send buffer " << sendBuffer << " bytes";
+    }
+    std::cout << "." << std::endl;
 
-    long i = 0;
-    while (true) {
-        if (i % 100000 == 0) {
-            std::cout << "Intention sent " << i << " times.\r" << std::flush;
+    // Every target has its own threads, and --pps is shared out between the threads of each target.
+    // A failed send stops that target's threads only.
+    std::vector<SenderStats> stats(sockets.size());
+    std::vector<std::atomic<bool>> targetFailed(targets.size());
+    std::vector<std::thread> senders;
+    for (size_t target = 0; target < targets.size(); target++) {
+        for (unsigned int t = 0; t < settings.threads; t++) {
+            const size_t sender = target * settings.threads + t;
+            unsigned long long threadRate = settings.packetsPerSecond / settings.threads +
+                                            (t < settings.packetsPerSecond % settings.threads ? 1 : 0);
+            senders.emplace_back(broadcastWorker, sockets[sender], std::cref(targets[target]), std::cref(intention), t,
+                                 settings.threads, threadRate, useGso, std::ref(stats[sender]), std::ref(targetFailed[target]));
         }
-        i++;
-        ssize_t bytesSent = sendto(sock, intention.c_str(), intention.length(), 0,
-                                   reinterpret_cast<struct sockaddr*>(&broadcastAddr),
-                                   sizeof(broadcastAddr));
-        if (bytesSent < 0) {
-            std::cerr << "Failed to send broadcast message." << std::endl;
-            break;
+    }
+
+    // Status once a second, until every target has failed: intentions sent so far, then the last
+    // second's datagram and bit rate, in total and, with more than one destination, for each of them
+    auto anyTargetSending = [&]() {
+        return std::any_of(targetFailed.begin(), targetFailed.end(), [](const std::atomic<bool> &failed) { return !failed; });
+    };
+    std::vector<unsigned long long> lastDatagrams(targets.size()), lastBytes(targets.size());
+    auto lastReport = std::chrono::steady_clock::now();
+    auto nextReport = lastReport;
+    while (anyTargetSending()) {
+        nextReport += std::chrono::seconds(1);
+        std::this_thread::sleep_until(nextReport);
+
+        auto now = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(now - lastReport).count();
+        unsigned long long intentionsSent = 0, secondDatagrams = 0, secondBytes = 0;
+        std::ostringstream perTarget;
+        perTarget << std::fixed;
+        for (size_t target = 0; target < targets.size(); target++) {
+            unsigned long long datagrams = 0, bytes = 0;
+            for (unsigned int t = 0; t < settings.threads; t++) {
+                datagrams += stats[target * settings.threads + t].datagrams.load(std::memory_order_relaxed);
+                bytes += stats[target * settings.threads + t].bytes.load(std::memory_order_relaxed);
+            }
+            perTarget << " [" << targets[target].name << ": ";
+            if (targetFailed[target]) {
+                perTarget << "failed]";
+            } else {
+                perTarget << std::setprecision(0) << (datagrams - lastDatagrams[target]) / seconds << " pps, "
+                          << std::setprecision(2) << (bytes - lastBytes[target]) * 8 / seconds / 1e6 << " Mbit/s]";
+            }
+            intentionsSent += datagrams / chunkCounts[target];
+            secondDatagrams += datagrams - lastDatagrams[target];
+            secondBytes += bytes - lastBytes[target];
+            lastDatagrams[target] = datagrams;
+            lastBytes[target] = bytes;
         }
-        //sleep(1);  // Delay for 1 second between each broadcast
+        std::cout << "Intention sent " << intentionsSent << " times. " << std::fixed << std::setprecision(0)
+                  << secondDatagrams / seconds << " pps, " << std::setprecision(2) << secondBytes * 8 / seconds / 1e6
+                  << " Mbit/s." << (targets.size() > 1 ? perTarget.str() : "") << "     \r" << std::flush;
+        lastReport = now;
     }
 
-    close(sock);
+    for (auto &sender : senders) {
+        sender.join();
+    }
+    for (int sock : sockets) {
+        close(sock);
+    }
     return 0;
-}
\ No newline at end of file
+}